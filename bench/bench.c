@@ -0,0 +1,942 @@
+#define _POSIX_C_SOURCE 200809L
+
+/*
+ * Micro- and end-to-end benchmarks for the analyzer.
+ *
+ * Each case generates a synthetic, time-ordered log in memory with a
+ * given number of distinct error messages and a target line length,
+ * then times the individual stages (readers, parser, aggregator, top-N
+ * selection) and a full run of the loganalyzer binary on it.
+ *
+ * Results are printed as a table and, with --csv FILE, written as CSV
+ * (one row per benchmark and case) so runs can be diffed.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/wait.h>
+
+#include "aggregator.h"
+#include "columnar.h"
+#include "parallel.h"
+#include "parser.h"
+#include "pipeline.h"
+#include "report.h"
+#include "scan.h"
+#include "utils.h"
+
+#define DEFAULT_LINES  500000
+#define DEFAULT_REPEAT 3
+#define TOP_N          10
+
+/* Emulated slow device: one 1 MiB read every SLOW_LATENCY_NS */
+#define SLOW_CHUNK      (1024 * 1024)
+#define SLOW_LATENCY_NS 1000000
+
+/* Linux pipe resizing; <fcntl.h> hides it without _GNU_SOURCE */
+#if defined(__linux__) && !defined(F_SETPIPE_SZ)
+#define F_SETPIPE_SZ 1031
+#endif
+
+/* Distinct error messages per case */
+static const size_t CARDINALITIES[] = { 16, 4096, 262144 };
+
+/* Target line lengths in bytes, newline included */
+static const size_t LINE_LENGTHS[] = { 64, 512 };
+
+#define COUNT_OF(a) (sizeof(a) / sizeof((a)[0]))
+
+typedef struct {
+    size_t lines;
+    size_t repeat;
+    const char *csv_path;
+    const char *analyzer;
+} BenchOptions;
+
+/* One generated workload */
+typedef struct {
+    char name[64];
+    size_t cardinality;
+    size_t line_length;
+
+    char *data;
+    size_t len;
+    size_t lines;
+    size_t *line_starts;  // lines + 1 entries
+    char path[64];        // the same data on disk
+} Workload;
+
+typedef struct {
+    FILE *csv;
+    size_t repeat;
+} Reporter;
+
+/* ---------- Helpers ---------- */
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+/* xorshift64*: fast and reproducible across platforms */
+static unsigned long long next_random(unsigned long long *state) {
+    unsigned long long x = *state;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    *state = x;
+    return x * 2685821657736338717ULL;
+}
+
+/*
+ * Prints one result row and appends it to the CSV file.
+ * `bytes` may be 0 for stages that do not consume input text.
+ */
+static void report(
+    Reporter *r,
+    const char *benchmark,
+    const Workload *w,
+    size_t lines,
+    size_t bytes,
+    double seconds
+) {
+    if (seconds <= 0) seconds = 1e-9;
+
+    double lines_per_sec = (double)lines / seconds;
+    double mb_per_sec = (double)bytes / seconds / (1024.0 * 1024.0);
+    double ns_per_line = lines ? seconds * 1e9 / (double)lines : 0;
+
+    printf("%-18s %-16s %12.0f %10.1f %10.1f\n",
+           benchmark, w->name, lines_per_sec, mb_per_sec, ns_per_line);
+    fflush(stdout);
+
+    if (r->csv) {
+        fprintf(r->csv, "%s,%s,%zu,%zu,%zu,%zu,%.6f,%.0f,%.2f,%.2f\n",
+                benchmark, w->name, w->cardinality, w->line_length,
+                lines, bytes, seconds,
+                lines_per_sec, mb_per_sec, ns_per_line);
+    }
+}
+
+/*
+ * Writes a time-ordered log with `cardinality` distinct error messages,
+ * each line padded to about `line_length` bytes.
+ * Returns 0 on success, non-zero on allocation failure.
+ */
+static int generate(Workload *w, size_t lines) {
+    static const char *const info_messages[] = {
+        "Processing request", "Cache hit", "User logged in",
+        "Health check passed", "Request completed"
+    };
+    static const char *const warn_messages[] = {
+        "Slow query detected", "Retrying connection", "High memory usage"
+    };
+
+    size_t capacity = lines * (w->line_length + 64) + 1;
+    w->data = malloc(capacity);
+    w->line_starts = malloc((lines + 1) * sizeof(size_t));
+    if (!w->data || !w->line_starts) return -1;
+
+    unsigned long long rng = 0x9E3779B97F4A7C15ULL ^ w->cardinality;
+    struct tm tm;
+    memset(&tm, 0, sizeof(tm));
+    tm.tm_year = 2025 - 1900;
+    tm.tm_mon = 8;
+    tm.tm_mday = 10;
+    tm.tm_isdst = -1;
+    time_t t = mktime(&tm);
+
+    size_t len = 0;
+    for (size_t i = 0; i < lines; i++) {
+        if (i % 4 == 0) t++;
+
+        struct tm local;
+        localtime_r(&t, &local);
+
+        char *line = w->data + len;
+        size_t n = strftime(line, 32, "%Y-%m-%d %H:%M:%S ", &local);
+
+        unsigned long long r = next_random(&rng);
+        unsigned roll = (unsigned)(r % 100);
+
+        if (roll < 70) {
+            n += (size_t)sprintf(line + n, "INFO %s",
+                                 info_messages[(r >> 8) % 5]);
+        } else if (roll < 85) {
+            n += (size_t)sprintf(line + n, "WARN %s",
+                                 warn_messages[(r >> 8) % 3]);
+        } else {
+            n += (size_t)sprintf(line + n, "ERROR Operation failed code=%llu",
+                                 (r >> 8) % w->cardinality);
+        }
+
+        /* Pad to the target length with deterministic filler */
+        if (n + 1 < w->line_length) {
+            line[n++] = ' ';
+            for (; n + 1 < w->line_length; n++) line[n] = (char)('a' + n % 26);
+        }
+        line[n++] = '\n';
+
+        w->line_starts[i] = len;
+        len += n;
+    }
+
+    w->line_starts[lines] = len;
+    w->len = len;
+    w->lines = lines;
+    return 0;
+}
+
+/*
+ * Writes the workload to a temporary file for the reader benchmarks.
+ * Returns 0 on success, non-zero on failure.
+ */
+static int write_file(Workload *w) {
+    const char *dir = getenv("TMPDIR");
+    snprintf(w->path, sizeof(w->path), "%s/labench-XXXXXX",
+             dir && strlen(dir) < 40 ? dir : "/tmp");
+
+    int fd = mkstemp(w->path);
+    if (fd < 0) return -1;
+
+    size_t written = 0;
+    while (written < w->len) {
+        ssize_t n = write(fd, w->data + written, w->len - written);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) {
+            close(fd);
+            return -1;
+        }
+        written += (size_t)n;
+    }
+
+    return close(fd);
+}
+
+static void free_workload(Workload *w) {
+    if (w->path[0]) unlink(w->path);
+    free(w->data);
+    free(w->line_starts);
+}
+
+/* ---------- Benchmarks ---------- */
+
+static void bench_parse(
+    Reporter *r,
+    const Workload *w,
+    const char *name,
+    const LineFilter *filter
+) {
+    double best = 0;
+
+    for (size_t rep = 0; rep < r->repeat; rep++) {
+        LogParser parser;
+        LogEntry entry;
+        size_t parsed = 0;
+
+        log_parser_init(&parser, filter);
+
+        double start = now_seconds();
+        for (size_t i = 0; i < w->lines; i++) {
+            size_t offset = w->line_starts[i];
+            size_t len = w->line_starts[i + 1] - offset - 1;
+            parsed += parse_log_line(&parser, w->data + offset,
+                                     len, &entry) == 0;
+        }
+        double elapsed = now_seconds() - start;
+
+        if (!filter && parsed != w->lines) {
+            fprintf(stderr, "Error: %zu of %zu lines failed to parse\n",
+                    w->lines - parsed, w->lines);
+        }
+        if (rep == 0 || elapsed < best) best = elapsed;
+    }
+
+    report(r, name, w, w->lines, w->len, best);
+}
+
+/*
+ * Parsing behind a --grep filter of 24 patterns, one of which matches
+ * the "Slow query" WARN lines (about 5%).
+ */
+static void bench_parse_grep(Reporter *r, const Workload *w) {
+    GrepSet grep;
+    LineFilter filter;
+    char pattern[32];
+    int ok = grep_set_init(&grep) == 0;
+
+    for (int i = 0; ok && i < 23; i++) {
+        snprintf(pattern, sizeof(pattern), "tenant-%02d", i);
+        ok = grep_set_add(&grep, pattern, strlen(pattern)) == 0;
+    }
+    ok = ok && grep_set_add(&grep, "Slow query", 10) == 0 &&
+         grep_set_compile(&grep) == 0;
+
+    if (ok) {
+        line_filter_init(&filter);
+        filter.grep = &grep;
+        bench_parse(r, w, "parse_grep", &filter);
+    } else {
+        fprintf(stderr, "Error: Memory allocation failed\n");
+    }
+
+    grep_set_free(&grep);
+}
+
+/*
+ * Times process_log_line over pre-parsed entries and leaves the last
+ * result in *out for the top-N benchmark.
+ */
+static void bench_process(
+    Reporter *r,
+    const Workload *w,
+    const char *name,
+    AnalysisConfig config,
+    AnalysisResult **out
+) {
+    LogEntry *entries = malloc(w->lines * sizeof(LogEntry));
+    if (!entries) {
+        fprintf(stderr, "Error: Memory allocation failed\n");
+        return;
+    }
+
+    LogParser parser;
+    log_parser_init(&parser, NULL);
+    for (size_t i = 0; i < w->lines; i++) {
+        size_t offset = w->line_starts[i];
+        parse_log_line(&parser, w->data + offset,
+                       w->line_starts[i + 1] - offset - 1, &entries[i]);
+    }
+
+    double best = 0;
+
+    for (size_t rep = 0; rep < r->repeat; rep++) {
+        AnalysisResult *result = init_analyzer(&config);
+        if (!result) break;
+
+        double start = now_seconds();
+        for (size_t i = 0; i < w->lines; i++) {
+            process_log_line(result, &entries[i]);
+        }
+        finalize_analysis(result);
+        double elapsed = now_seconds() - start;
+
+        if (rep == 0 || elapsed < best) best = elapsed;
+
+        cleanup_analyzer(*out);
+        *out = result;
+    }
+
+    free(entries);
+    report(r, name, w, w->lines, 0, best);
+}
+
+static void bench_top_errors(
+    Reporter *r,
+    const Workload *w,
+    const AnalysisResult *result
+) {
+    const ErrorEntry *top[TOP_N];
+    size_t calls = 0;
+    size_t found = 0;
+
+    /* Repeat until the measurement is long enough to be stable */
+    double start = now_seconds();
+    double elapsed;
+    do {
+        found += get_top_errors(result, TOP_N, top);
+        calls++;
+        elapsed = now_seconds() - start;
+    } while (elapsed < 0.2);
+
+    if (found == 0) fprintf(stderr, "Error: no errors selected\n");
+
+    /* "Lines" here are error entries scanned per call */
+    report(r, "get_top_errors", w,
+           calls * result->error_unique, 0, elapsed);
+}
+
+/*
+ * Renders a by-minute result as text, JSON and CSV into /dev/null.
+ * "Lines" here are time buckets written per report.
+ */
+static void bench_report(
+    Reporter *r,
+    const Workload *w,
+    const AnalysisResult *result
+) {
+    static const char *names[] = { "report_text", "report_json",
+                                   "report_csv" };
+    TopErrors top;
+    TopFields fields;
+
+    if (top_errors_select(&top, result, TOP_N) != 0) return;
+    if (top_fields_select(&fields, result, TOP_N) != 0) {
+        top_errors_free(&top);
+        return;
+    }
+
+    for (int format = 0; format < 3; format++) {
+        double best = 0;
+
+        for (size_t rep = 0; rep < r->repeat; rep++) {
+            ReportSink out;
+            if (sink_open(&out, "/dev/null") != 0) break;
+
+            double start = now_seconds();
+            if (format == 0) {
+                print_summary(&out, result, false);
+                print_top_errors(&out, result, &top);
+                print_field_text(&out, result, &fields);
+                print_time_buckets_text(&out, result);
+            } else if (format == 1) {
+                print_report_json(&out, result, false, &top, &fields,
+                                  NULL, 0);
+            } else {
+                print_report_csv(&out, result, false, &top, &fields,
+                                 NULL, 0);
+            }
+            sink_close(&out);
+            double elapsed = now_seconds() - start;
+
+            if (rep == 0 || elapsed < best) best = elapsed;
+        }
+
+        report(r, names[format], w, result->time_bucket_count, 0, best);
+    }
+
+    top_fields_free(&fields);
+    top_errors_free(&top);
+}
+
+/*
+ * Converts the workload with a ColumnWriter (rate is lines converted),
+ * then times analyze_columnar() on the saved file with --group-by minute
+ * (rate is rows, bytes are the columnar file).
+ */
+static void bench_columnar(Reporter *r, const Workload *w) {
+    char path[80];
+    snprintf(path, sizeof(path), "%s.cols", w->path);
+
+    double best = 0;
+    int ok = 1;
+
+    for (size_t rep = 0; ok && rep < r->repeat; rep++) {
+        ColumnWriter writer;
+        LogParser parser;
+        LogEntry entry;
+
+        if (column_writer_init(&writer) != 0) {
+            ok = 0;
+            break;
+        }
+        log_parser_init(&parser, NULL);
+
+        double start = now_seconds();
+        for (size_t i = 0; ok && i < w->lines; i++) {
+            size_t offset = w->line_starts[i];
+            size_t len = w->line_starts[i + 1] - offset - 1;
+            if (parse_log_line(&parser, w->data + offset, len, &entry) == 0) {
+                ok = column_writer_add(&writer, &entry) == 0;
+            }
+        }
+        double elapsed = now_seconds() - start;
+
+        if (ok && rep == 0) ok = column_writer_save(&writer, path) == 0;
+        column_writer_free(&writer);
+        if (rep == 0 || elapsed < best) best = elapsed;
+    }
+
+    if (!ok) {
+        fprintf(stderr, "Error: Could not convert %s\n", w->name);
+        unlink(path);
+        return;
+    }
+    report(r, "columnar_convert", w, w->lines, w->len, best);
+
+    FileReader *reader = file_reader_open(path);
+    if (!reader) {
+        unlink(path);
+        return;
+    }
+
+    AnalysisConfig config = { GROUP_BY_MINUTE, false, 0, false, NULL };
+    size_t len = 0;
+    const char *data = file_reader_mapping(reader, &len);
+
+    for (size_t rep = 0; data && rep < r->repeat; rep++) {
+        AnalysisResult *result = init_analyzer(&config);
+        size_t rows = 0;
+        if (!result) break;
+
+        double start = now_seconds();
+        int status = analyze_columnar(result, data, len, NULL, &rows, NULL);
+        double elapsed = now_seconds() - start;
+
+        if (status != 0 || rows != w->lines) {
+            fprintf(stderr, "Error: columnar query read %zu of %zu rows\n",
+                    rows, w->lines);
+        }
+        cleanup_analyzer(result);
+        if (rep == 0 || elapsed < best) best = elapsed;
+    }
+    if (data) report(r, "columnar_query", w, w->lines, len, best);
+
+    file_reader_close(reader);
+    unlink(path);
+}
+
+static void bench_reader_mmap(Reporter *r, const Workload *w) {
+    double best = 0;
+
+    for (size_t rep = 0; rep < r->repeat; rep++) {
+        FileReader *reader = file_reader_open(w->path);
+        if (!reader) {
+            fprintf(stderr, "Error: Could not open file '%s'\n", w->path);
+            return;
+        }
+
+        const char *line;
+        size_t len;
+        size_t lines = 0;
+
+        double start = now_seconds();
+        while ((line = file_reader_read_line(reader, &len)) != NULL) {
+            lines++;
+        }
+        double elapsed = now_seconds() - start;
+
+        file_reader_close(reader);
+        if (lines != w->lines) {
+            fprintf(stderr, "Error: read %zu of %zu lines\n", lines, w->lines);
+        }
+        if (rep == 0 || elapsed < best) best = elapsed;
+    }
+
+    report(r, "reader_mmap", w, w->lines, w->len, best);
+}
+
+/*
+ * Splits the in-memory workload with each newline kernel the CPU
+ * supports, checking that every kernel finds the same line ends.
+ */
+static void bench_scan(Reporter *r, const Workload *w) {
+    ScanKernel detected = scan_kernel();
+
+    for (int k = 0; k < SCAN_KERNEL_COUNT; k++) {
+        if (scan_use_kernel((ScanKernel)k) != 0) continue;
+
+        size_t ends[SCAN_BATCH];
+        double best = 0;
+
+        for (size_t rep = 0; rep < r->repeat; rep++) {
+            size_t lines = 0;
+            size_t pos = 0;
+            int mismatch = 0;
+
+            double start = now_seconds();
+            while (pos < w->len) {
+                size_t count =
+                    scan_newlines(w->data, w->len, pos, ends, SCAN_BATCH);
+                if (count == 0) break;
+
+                for (size_t i = 0; i < count; i++) {
+                    mismatch |= ends[i] + 1 != w->line_starts[lines + i + 1];
+                }
+                lines += count;
+                pos = ends[count - 1] + 1;
+            }
+            double elapsed = now_seconds() - start;
+
+            if (lines != w->lines || mismatch) {
+                fprintf(stderr, "Error: %s kernel found %zu of %zu lines\n",
+                        scan_kernel_name((ScanKernel)k), lines, w->lines);
+            }
+            if (rep == 0 || elapsed < best) best = elapsed;
+        }
+
+        char name[32];
+        snprintf(name, sizeof(name), "scan_%s",
+                 scan_kernel_name((ScanKernel)k));
+        report(r, name, w, w->lines, w->len, best);
+    }
+
+    scan_use_kernel(detected);
+}
+
+/* Feeds a workload into a pipe from a helper thread */
+typedef struct {
+    int fd;
+    const Workload *w;
+} PipeFeed;
+
+static void *feed_pipe(void *arg) {
+    PipeFeed *feed = arg;
+    size_t written = 0;
+
+    while (written < feed->w->len) {
+        ssize_t n = write(feed->fd, feed->w->data + written,
+                          feed->w->len - written);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;
+        written += (size_t)n;
+    }
+
+    close(feed->fd);
+    return NULL;
+}
+
+/*
+ * Feeds a workload like a synchronous device: waits until the reader
+ * has drained the pipe (i.e. asks for more), spends SLOW_LATENCY_NS
+ * "reading", then delivers the next SLOW_CHUNK bytes.
+ */
+static void *feed_slow(void *arg) {
+    PipeFeed *feed = arg;
+    const struct timespec poll = { 0, 20000 };
+    const struct timespec latency = { 0, SLOW_LATENCY_NS };
+    size_t written = 0;
+
+    while (written < feed->w->len) {
+        int queued;
+        while (ioctl(feed->fd, FIONREAD, &queued) == 0 && queued > 0) {
+            nanosleep(&poll, NULL);
+        }
+        nanosleep(&latency, NULL);
+
+        size_t end = written + SLOW_CHUNK;
+        if (end > feed->w->len) end = feed->w->len;
+
+        while (written < end) {
+            ssize_t n = write(feed->fd, feed->w->data + written,
+                              end - written);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) {
+                close(feed->fd);
+                return NULL;
+            }
+            written += (size_t)n;
+        }
+    }
+
+    close(feed->fd);
+    return NULL;
+}
+
+/*
+ * Starts `fn` writing the workload into a new pipe of `pipe_size`
+ * bytes (0 = system default) and stores a path for its read end in
+ * `path`.
+ * Returns the read end, or -1 on failure.
+ */
+static int start_feed(
+    const Workload *w,
+    void *(*fn)(void *),
+    size_t pipe_size,
+    PipeFeed *feed,
+    pthread_t *writer,
+    char *path,
+    size_t path_size
+) {
+    int fds[2];
+    if (pipe(fds) != 0) return -1;
+
+    snprintf(path, path_size, "/dev/fd/%d", fds[0]);
+
+#ifdef F_SETPIPE_SZ
+    /* Best effort; a smaller pipe only adds context switches */
+    if (pipe_size > 0) fcntl(fds[1], F_SETPIPE_SZ, (int)pipe_size);
+#else
+    (void)pipe_size;
+#endif
+
+    feed->fd = fds[1];
+    feed->w = w;
+    if (pthread_create(writer, NULL, fn, feed) != 0) {
+        close(fds[0]);
+        close(fds[1]);
+        return -1;
+    }
+
+    return fds[0];
+}
+
+static void bench_reader_pipe(Reporter *r, const Workload *w) {
+    double best = 0;
+
+    for (size_t rep = 0; rep < r->repeat; rep++) {
+        PipeFeed feed;
+        pthread_t writer;
+        char path[32];
+        int fd = start_feed(w, feed_pipe, 0, &feed, &writer, path,
+                            sizeof(path));
+        if (fd < 0) return;
+
+        double start = now_seconds();
+        FileReader *reader = file_reader_open(path);
+        size_t len;
+        size_t lines = 0;
+        while (reader && file_reader_read_line(reader, &len) != NULL) {
+            lines++;
+        }
+        double elapsed = now_seconds() - start;
+
+        file_reader_close(reader);
+        if (lines != w->lines) {
+            fprintf(stderr, "Error: read %zu of %zu lines\n", lines, w->lines);
+        }
+        close(fd);
+        pthread_join(writer, NULL);
+
+        if (rep == 0 || elapsed < best) best = elapsed;
+    }
+
+    report(r, "reader_pipe", w, w->lines, w->len, best);
+}
+
+/*
+ * Analyzes the workload from an emulated slow device, either line by
+ * line on one thread (workers = 0, reading and parsing take turns) or
+ * through analyze_pipeline() with `workers` parse threads.
+ */
+static void bench_slow_read(Reporter *r, const Workload *w, size_t workers) {
+    double best = 0;
+
+    for (size_t rep = 0; rep < r->repeat; rep++) {
+        AnalysisConfig config = { GROUP_BY_MINUTE, false, 0, false, NULL };
+        AnalysisResult *result = init_analyzer(&config);
+        PipeFeed feed;
+        pthread_t writer;
+        char path[32];
+        int fd = start_feed(w, feed_slow, SLOW_CHUNK, &feed, &writer, path,
+                            sizeof(path));
+        if (fd < 0 || !result) {
+            if (fd >= 0) {
+                close(fd);
+                pthread_join(writer, NULL);
+            }
+            cleanup_analyzer(result);
+            return;
+        }
+
+        double start = now_seconds();
+        FileReader *reader = file_reader_open(path);
+        size_t processed = 0;
+
+        if (reader && workers > 0) {
+            analyze_pipeline(result, reader, NULL, 0, workers, NULL,
+                             &processed, NULL);
+        } else if (reader) {
+            LogParser parser;
+            LogEntry entry;
+            const char *line;
+            size_t len;
+
+            log_parser_init(&parser, NULL);
+            while ((line = file_reader_read_line(reader, &len)) != NULL) {
+                if (parse_log_line(&parser, line, len, &entry) == PARSE_OK) {
+                    process_log_line(result, &entry);
+                    processed++;
+                }
+            }
+        }
+        double elapsed = now_seconds() - start;
+
+        file_reader_close(reader);
+        cleanup_analyzer(result);
+        if (processed != w->lines) {
+            fprintf(stderr, "Error: analyzed %zu of %zu lines\n",
+                    processed, w->lines);
+        }
+        close(fd);
+        pthread_join(writer, NULL);
+
+        if (rep == 0 || elapsed < best) best = elapsed;
+    }
+
+    report(r, workers ? "slow_pipeline" : "slow_sequential",
+           w, w->lines, w->len, best);
+}
+
+/*
+ * Runs the analyzer binary on the workload file, discarding its output.
+ */
+static void bench_end_to_end(
+    Reporter *r,
+    const Workload *w,
+    const char *analyzer,
+    const char *threads
+) {
+    double best = 0;
+
+    for (size_t rep = 0; rep < r->repeat; rep++) {
+        double start = now_seconds();
+
+        pid_t pid = fork();
+        if (pid < 0) return;
+
+        if (pid == 0) {
+            int null_fd = open("/dev/null", O_WRONLY);
+            if (null_fd >= 0) {
+                dup2(null_fd, STDOUT_FILENO);
+                close(null_fd);
+            }
+            execl(analyzer, analyzer, w->path,
+                  "--group-by", "minute", "--output", "json",
+                  "--threads", threads, (char *)NULL);
+            _exit(127);
+        }
+
+        int wstatus;
+        waitpid(pid, &wstatus, 0);
+        double elapsed = now_seconds() - start;
+
+        if (!WIFEXITED(wstatus) || WEXITSTATUS(wstatus) != 0) {
+            fprintf(stderr, "Error: '%s' failed; run 'make' first\n",
+                    analyzer);
+            return;
+        }
+        if (rep == 0 || elapsed < best) best = elapsed;
+    }
+
+    char name[32];
+    snprintf(name, sizeof(name), "end_to_end_t%s", threads);
+    report(r, name, w, w->lines, w->len, best);
+}
+
+static void run_workload(Reporter *r, Workload *w, const BenchOptions *opt) {
+    AnalysisResult *result = NULL;
+    char threads[16];
+    snprintf(threads, sizeof(threads), "%zu", cpu_count());
+
+    bench_reader_mmap(r, w);
+    bench_scan(r, w);
+    bench_reader_pipe(r, w);
+    bench_slow_read(r, w, 0);
+    bench_slow_read(r, w, cpu_count());
+    bench_parse(r, w, "parse_log_line", NULL);
+    bench_parse_grep(r, w);
+    AnalysisConfig by_minute = { GROUP_BY_MINUTE, false, 0, false, NULL };
+    AnalysisConfig templates = { GROUP_BY_NONE, true, 0, false, NULL };
+    AnalysisConfig approx = { GROUP_BY_NONE, false, 1000, false, NULL };
+    AnalysisConfig distinct = { GROUP_BY_MINUTE, false, 0, true, NULL };
+    AnalysisConfig field = { GROUP_BY_MINUTE, false, 0, false, "code" };
+    AnalysisConfig plain = { GROUP_BY_NONE, false, 0, false, NULL };
+
+    bench_process(r, w, "process_by_min", by_minute, &result);
+    bench_process(r, w, "process_templates", templates, &result);
+    bench_process(r, w, "process_approx", approx, &result);
+    bench_process(r, w, "process_distinct", distinct, &result);
+    bench_process(r, w, "process_field", field, &result);
+    if (result) bench_report(r, w, result);
+    bench_process(r, w, "process_log_line", plain, &result);
+    if (result) bench_top_errors(r, w, result);
+    bench_columnar(r, w);
+    bench_end_to_end(r, w, opt->analyzer, "1");
+    if (strcmp(threads, "1") != 0) {
+        bench_end_to_end(r, w, opt->analyzer, threads);
+    }
+
+    cleanup_analyzer(result);
+}
+
+static void print_usage(const char *program_name) {
+    printf("Usage: %s [options]\n", program_name);
+    printf("\nOptions:\n");
+    printf("  --lines N        Lines per workload (default: %d)\n",
+           DEFAULT_LINES);
+    printf("  --repeat N       Runs per benchmark, best is kept (default: %d)\n",
+           DEFAULT_REPEAT);
+    printf("  --csv FILE       Also write results as CSV\n");
+    printf("  --analyzer PATH  Binary for end-to-end runs (default: ./loganalyzer)\n");
+}
+
+static int parse_options(int argc, char **argv, BenchOptions *opt) {
+    opt->lines = DEFAULT_LINES;
+    opt->repeat = DEFAULT_REPEAT;
+    opt->csv_path = NULL;
+    opt->analyzer = "./loganalyzer";
+
+    for (int i = 1; i < argc; i++) {
+        const char *value = i + 1 < argc ? argv[i + 1] : NULL;
+
+        if (strcmp(argv[i], "--lines") == 0 && value) {
+            opt->lines = strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--repeat") == 0 && value) {
+            opt->repeat = strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--csv") == 0 && value) {
+            opt->csv_path = argv[++i];
+        } else if (strcmp(argv[i], "--analyzer") == 0 && value) {
+            opt->analyzer = argv[++i];
+        } else {
+            print_usage(argv[0]);
+            return -1;
+        }
+    }
+
+    if (opt->lines == 0 || opt->repeat == 0) {
+        fprintf(stderr, "Error: --lines and --repeat must be positive\n");
+        return -1;
+    }
+
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    BenchOptions opt;
+    if (parse_options(argc, argv, &opt) != 0) return 1;
+
+    /* A failed reader must not kill us through the pipe writer */
+    signal(SIGPIPE, SIG_IGN);
+
+    Reporter reporter = { NULL, opt.repeat };
+
+    if (opt.csv_path) {
+        reporter.csv = fopen(opt.csv_path, "w");
+        if (!reporter.csv) {
+            fprintf(stderr, "Error: Could not open '%s'\n", opt.csv_path);
+            return 1;
+        }
+        fprintf(reporter.csv, "benchmark,workload,cardinality,line_length,"
+                              "lines,bytes,seconds,lines_per_sec,"
+                              "mb_per_sec,ns_per_line\n");
+    }
+
+    printf("%-18s %-16s %12s %10s %10s\n",
+           "benchmark", "workload", "lines/s", "MB/s", "ns/line");
+
+    int status = 0;
+
+    for (size_t c = 0; c < COUNT_OF(CARDINALITIES) && status == 0; c++) {
+        for (size_t l = 0; l < COUNT_OF(LINE_LENGTHS) && status == 0; l++) {
+            Workload w;
+            memset(&w, 0, sizeof(w));
+            w.cardinality = CARDINALITIES[c];
+            w.line_length = LINE_LENGTHS[l];
+            snprintf(w.name, sizeof(w.name), "c%zu_l%zu",
+                     w.cardinality, w.line_length);
+
+            if (generate(&w, opt.lines) != 0 || write_file(&w) != 0) {
+                fprintf(stderr, "Error: Could not prepare workload %s\n",
+                        w.name);
+                status = 1;
+            } else {
+                run_workload(&reporter, &w, &opt);
+            }
+
+            free_workload(&w);
+        }
+    }
+
+    if (reporter.csv) fclose(reporter.csv);
+    return status;
+}
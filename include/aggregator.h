@@ -1,23 +1,56 @@
 #ifndef AGGREGATOR_H
 #define AGGREGATOR_H
 
+#include <stdbool.h>
 #include <stddef.h>
 #include "parser.h"
 #include "options.h"
+#include "hashtable.h"
+#include "heavy.h"
+#include "hll.h"
+#include "histogram.h"
+#include "arena.h"
+
+/* HyperLogLog precision for --distinct: whole run and per bucket */
+#define DISTINCT_PRECISION        14  // 16 KB per level
+#define DISTINCT_BUCKET_PRECISION 10  // 1 KB per level
 
 typedef struct TimeBucket {
     long long start_unix;
-    int total;
-    int info;
-    int warn;
-    int error;
+    size_t total;
+    size_t info;
+    size_t warn;
+    size_t error;
+    HyperLogLog distinct[LOG_LEVEL_COUNT];  // --distinct, by LogLevel
+    Histogram field;                        // --field values
 } TimeBucket;
 
 typedef struct {
-    char message[MAX_MESSAGE_LEN];
+    size_t message_offset;  // into AnalysisResult.error_messages
+    size_t message_len;
+    size_t example_offset;  // first message seen; the message itself
+    size_t example_len;     // unless errors are grouped by template
     size_t count;
 } ErrorEntry;
 
+typedef struct {
+    size_t template_offset;  // into AnalysisResult.error_messages
+    size_t template_len;
+    Histogram values;
+} FieldEntry;
+
+/*
+ * What a result aggregates. Fixed by init_analyzer(); only results
+ * with equal configurations can be merged.
+ */
+typedef struct {
+    GroupBy group_by;
+    bool templates;     // group errors by message template (see template.h)
+    size_t approx_top;  // Space-Saving counters for errors; 0 = exact
+    bool distinct;      // estimate distinct messages (see hll.h)
+    const char *field;  // numeric field to extract (see field.h), or NULL
+} AnalysisConfig;
+
 typedef struct {
     size_t total_lines;
 
@@ -25,22 +58,58 @@ typedef struct {
     size_t warn_count;
     size_t error_total;
 
+    /* Distinct messages (templates) per LogLevel, with --distinct */
+    HyperLogLog distinct[LOG_LEVEL_COUNT];
+
     ErrorEntry *error_entries;
     size_t error_unique;
     size_t error_capacity;
+    HashIndex error_index;       // message hash -> error_entries index
+    StringArena error_messages;  // interned message and template text
 
-    GroupBy group_by;
+    /* config.field values: all of them, and by message template */
+    Histogram field_values;
+    FieldEntry *field_entries;
+    size_t field_unique;
+    size_t field_capacity;
+    HashIndex field_index;  // template hash -> field_entries index
+    size_t field_len;       // strlen(config.field)
+
+    /* Replaces the error table when config.approx_top is set */
+    HeavyHitters heavy;
+
+    /* Scratch buffer for message templates */
+    char *template_buf;
+    size_t template_capacity;
+
+    AnalysisConfig config;
 
     TimeBucket *time_buckets;
     size_t time_bucket_count;
     size_t time_bucket_capacity;
+    int time_buckets_sorted;
+
+    /*
+     * Bucket lookup: a dense array indexed by
+     * (start_unix - bucket_base) / width holding time_buckets index + 1,
+     * with a hash fallback for buckets before the base or past a gap.
+     */
+    long long bucket_base;
+    size_t *bucket_slots;
+    size_t bucket_slot_count;
+    HashIndex bucket_index;
+
+    /* Work counters for --stats; merge_analysis() sums them */
+    size_t rejected[PARSE_STATUS_COUNT];  // lines by ParseStatus
+    size_t bucket_inserts;       // time buckets created
+    size_t bucket_hash_inserts;  // ... of which outside the dense array
 } AnalysisResult;
 
 /*
  * Allocates and initializes an AnalysisResult.
  * Caller owns the returned pointer and must call cleanup_analyzer().
  */
-AnalysisResult *init_analyzer(GroupBy group_by);
+AnalysisResult *init_analyzer(const AnalysisConfig *config);
 
 /*
  * Processes a single parsed log entry and updates aggregates.
@@ -48,13 +117,99 @@ AnalysisResult *init_analyzer(GroupBy group_by);
 void process_log_line(AnalysisResult *result, const LogEntry *entry);
 
 /*
- * Writes up to top_n most frequent errors into out.
+ * Counts a line that parse_log_line() rejected with `status`.
+ */
+void record_rejected_line(AnalysisResult *result, ParseStatus status);
+
+/*
+ * Prepares a result for reporting: sorts time buckets chronologically.
+ * Must be called after the last process_log_line()/merge_analysis()
+ * and before printing; further updates are allowed afterwards.
+ * Returns 0 on success, non-zero on OOM, in which case the buckets are
+ * left unsorted but the result stays usable.
+ */
+int finalize_analysis(AnalysisResult *result);
+
+/*
+ * Adds all counters, error messages and time buckets from src into dst.
+ * Both results must use the same configuration.
+ * Returns 0 on success, non-zero on failure.
+ */
+int merge_analysis(AnalysisResult *dst, const AnalysisResult *src);
+
+/*
+ * Adds `count` occurrences of an error message (a template if the
+ * result groups by template), e.g. when restoring saved results.
+ * New messages are appended after existing ones, with `example`
+ * (may be NULL for the message itself) as their example.
+ * Returns 0 on success, non-zero on failure.
+ */
+int add_error_count(
+    AnalysisResult *result,
+    const char *message,
+    size_t len,
+    const char *example,
+    size_t example_len,
+    size_t count
+);
+
+/*
+ * Adds the counters (and distinct estimators and field values, if set)
+ * of `bucket` to the bucket with the same start time.
+ * Returns 0 on success, non-zero on failure.
+ */
+int add_time_bucket_counts(AnalysisResult *result, const TimeBucket *bucket);
+
+/*
+ * Writes pointers to up to top_n most frequent errors into out, most
+ * frequent first; equal counts keep first-occurrence order. `out` must
+ * have room for top_n pointers, which stay valid until the result is
+ * next modified.
  * Returns the number of entries written.
  */
 size_t get_top_errors(
     const AnalysisResult *result,
     size_t top_n,
-    ErrorEntry *out
+    const ErrorEntry **out
+);
+
+/*
+ * Writes pointers to up to top_n field entries with the most values
+ * into out, like get_top_errors().
+ * Returns the number of entries written.
+ */
+size_t get_top_fields(
+    const AnalysisResult *result,
+    size_t top_n,
+    const FieldEntry **out
+);
+
+/*
+ * Returns the null-terminated template text of a field entry.
+ * The pointer is valid until the result is next modified.
+ */
+const char *field_entry_template(
+    const AnalysisResult *result,
+    const FieldEntry *entry
+);
+
+/*
+ * Returns the null-terminated message text of an entry.
+ * The pointer is valid until the result is next modified.
+ */
+const char *error_entry_message(
+    const AnalysisResult *result,
+    const ErrorEntry *entry
+);
+
+/*
+ * Returns the null-terminated example message of an entry: the first
+ * message that produced its template, or the message itself.
+ * The pointer is valid until the result is next modified.
+ */
+const char *error_entry_example(
+    const AnalysisResult *result,
+    const ErrorEntry *entry
 );
 
 /*
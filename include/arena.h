@@ -0,0 +1,50 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+
+#define ARENA_NPOS ((size_t)-1)
+
+/*
+ * Bump-allocated string storage.
+ * Strings are appended back to back (each followed by a NUL) into one
+ * growable buffer and referenced by offset, so references stay valid
+ * when the buffer is reallocated. Memory use is proportional to the
+ * stored text.
+ */
+typedef struct {
+    char *data;
+    size_t size;
+    size_t capacity;
+} StringArena;
+
+/*
+ * Initializes an empty arena with the given initial capacity.
+ * Returns 0 on success, non-zero on failure.
+ */
+int arena_init(StringArena *arena, size_t capacity);
+
+/*
+ * Copies len bytes of s into the arena and null-terminates them.
+ * Returns the offset of the copy, or ARENA_NPOS on OOM.
+ */
+size_t arena_append(StringArena *arena, const char *s, size_t len);
+
+/*
+ * Returns a pointer to the string stored at offset.
+ * The pointer is invalidated by the next arena_append().
+ */
+const char *arena_get(const StringArena *arena, size_t offset);
+
+/*
+ * Discards every string appended at or after offset `mark` (a previous
+ * arena->size), undoing appends whose owner failed to record them.
+ */
+void arena_truncate(StringArena *arena, size_t mark);
+
+/*
+ * Frees the arena buffer.
+ */
+void arena_free(StringArena *arena);
+
+#endif
@@ -4,13 +4,31 @@
 #include <stddef.h>
 #include <stdbool.h>
 #include "options.h"
+#include "parser.h"
 
 typedef struct {
-    const char *filename;
+    const char **inputs;  // files, directories or glob patterns
+    size_t input_count;
     bool errors_only;
     size_t top_n;
     OutputFormat output_format;
+    const char *output_path;  // --output-file, or NULL for stdout
     GroupBy group_by;
+    bool templates;     // group errors by message template
+    size_t approx_top;  // Space-Saving counters; 0 = exact error counts
+    bool distinct;      // estimate distinct messages per level/bucket
+    const char *field;  // --field NAME: numeric field for percentiles
+    size_t threads;  // 0 = automatic
+    bool pipeline;   // read on a dedicated I/O thread
+    bool per_file;
+    bool follow;
+    unsigned interval;  // seconds between --follow reports
+    const char *state_path;  // --state snapshot file, or NULL
+    const char *convert_path;  // --convert: columnar file to write
+    const char *serve_path;    // --serve: Unix socket to answer queries on
+    LineFilter filter;       // --since/--until, --grep
+    GrepSet grep;            // --grep/--grep-file patterns (owned)
+    bool stats;              // --stats: time stages, count work
 } CliOptions;
 
 typedef enum {
@@ -26,4 +44,9 @@ typedef enum {
  */
 CliResult parse_cli(int argc, char **argv, CliOptions *out);
 
+/*
+ * Frees memory allocated by parse_cli().
+ */
+void cli_free(CliOptions *options);
+
 #endif
@@ -0,0 +1,116 @@
+#ifndef COLUMNAR_H
+#define COLUMNAR_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "aggregator.h"
+#include "arena.h"
+#include "hashtable.h"
+#include "parser.h"
+#include "stats.h"
+
+/*
+ * Columnar log files for --convert: parse once, query many times.
+ *
+ * Every accepted line becomes a row stored as separate columns:
+ *
+ *   timestamps  zigzag varint deltas of the Unix time
+ *   offsets     (row, UTC offset) pairs where the local offset changes
+ *   levels      2 bits per row, four rows per byte
+ *   ids         index of the row's message in the string table,
+ *               1, 2 or 4 bytes wide depending on the table size
+ *   strings     each distinct message once, in first-occurrence order
+ *
+ * A query maps the file and decodes only the columns it needs: plain
+ * counts read just the levels, --group-by and --since/--until add the
+ * timestamps, and error ranking reads ids of error rows only. The
+ * minimum and maximum time of every block of rows are kept as well, so
+ * --since/--until skip blocks outside the range unread. Work that
+ * depends on message text (templates, --grep) is done once per
+ * distinct message instead of once per line.
+ */
+typedef struct {
+    /* Columns built so far */
+    unsigned char *timestamps;
+    size_t timestamps_len;
+    size_t timestamps_capacity;
+    long long last_unix;
+
+    uint64_t *offset_runs;  // row, offset, row, offset, ...
+    size_t offset_run_count;
+    size_t offset_run_capacity;
+
+    uint64_t *blocks;  // per block: timestamps offset, time before, min, max
+    size_t block_count;
+    size_t block_capacity;
+
+    unsigned char *levels;
+    uint32_t *ids;
+    size_t rows;
+    size_t row_capacity;
+
+    /* String table: message -> id */
+    HashIndex index;
+    StringArena text;
+    size_t *string_offsets;  // into `text`, by id
+    size_t *string_lengths;
+    size_t string_count;
+    size_t string_capacity;
+
+    size_t rejected[PARSE_STATUS_COUNT];  // lines by ParseStatus
+} ColumnWriter;
+
+/*
+ * Initializes an empty writer.
+ * Returns 0 on success, non-zero on OOM.
+ */
+int column_writer_init(ColumnWriter *writer);
+
+/*
+ * Appends one parsed line as a row.
+ * Returns 0 on success, non-zero on OOM.
+ */
+int column_writer_add(ColumnWriter *writer, const LogEntry *entry);
+
+/*
+ * Counts a line that parse_log_line() rejected with `status`; the
+ * counts are stored with the file and reported by --stats on queries.
+ */
+void column_writer_reject(ColumnWriter *writer, ParseStatus status);
+
+/*
+ * Atomically replaces `path` with the columns collected so far.
+ * Returns 0 on success, non-zero on failure (an error has been printed).
+ */
+int column_writer_save(const ColumnWriter *writer, const char *path);
+
+/*
+ * Frees everything owned by the writer.
+ */
+void column_writer_free(ColumnWriter *writer);
+
+/*
+ * Returns non-zero if data[0, len) starts like a columnar file.
+ */
+int columnar_detect(const char *data, size_t len);
+
+/*
+ * Aggregates the rows of a mapped columnar file into result, as if its
+ * original lines had been analyzed with `filter` (may be NULL). Lines
+ * that were rejected during conversion are counted as they were then.
+ * Stage times go to `times` if non-NULL.
+ *
+ * Stores the number of accepted rows in *processed.
+ * Returns 0 on success, 1 if the file is corrupt or from another
+ * version, -1 on OOM.
+ */
+int analyze_columnar(
+    AnalysisResult *result,
+    const char *data,
+    size_t len,
+    const LineFilter *filter,
+    size_t *processed,
+    StageTimes *times
+);
+
+#endif
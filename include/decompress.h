@@ -0,0 +1,68 @@
+#ifndef DECOMPRESS_H
+#define DECOMPRESS_H
+
+#include <stddef.h>
+
+typedef enum {
+    COMPRESSION_NONE = 0,
+    COMPRESSION_GZIP = 1,
+    COMPRESSION_ZSTD = 2
+} Compression;
+
+/*
+ * Streaming decompressor running on its own thread.
+ * Decompressed data is handed over through a ring of large buffers,
+ * so decompression overlaps with parsing and aggregation.
+ */
+typedef struct Decompressor Decompressor;
+
+/*
+ * Identifies gzip/zlib or zstd input from its first bytes.
+ */
+Compression detect_compression(const char *data, size_t len);
+
+/*
+ * Returns a printable name for a compression type.
+ */
+const char *compression_name(Compression type);
+
+/*
+ * Returns non-zero if support for `type` was compiled in.
+ */
+int compression_supported(Compression type);
+
+/*
+ * Starts decompressing. The compressed stream is `prefix` (prefix_len
+ * bytes, e.g. a whole memory-mapped file) followed by everything read
+ * from `fd` until EOF (pass fd = -1 for none). `name` identifies the
+ * input in warnings. Both must stay valid until decompressor_stop().
+ * Trailing padding or garbage after the last gzip member is ignored
+ * with a warning on stderr.
+ * Returns NULL on failure.
+ */
+Decompressor *decompressor_start(
+    Compression type,
+    const char *name,
+    const char *prefix,
+    size_t prefix_len,
+    int fd
+);
+
+/*
+ * Returns the next block of decompressed data and stores its length in
+ * *len, or NULL at end of stream. The block stays valid until the next
+ * call. After NULL, decompressor_failed() tells EOF from error.
+ */
+const char *decompressor_next(Decompressor *d, size_t *len);
+
+/*
+ * Returns non-zero if the stream was corrupt or unreadable.
+ */
+int decompressor_failed(const Decompressor *d);
+
+/*
+ * Stops the decompression thread and frees all resources.
+ */
+void decompressor_stop(Decompressor *d);
+
+#endif
@@ -0,0 +1,28 @@
+#ifndef FIELD_H
+#define FIELD_H
+
+#include <stddef.h>
+
+/*
+ * Finds the numeric field `name` in a message and stores its value.
+ * The name must start at a word boundary and be followed by '=', ':'
+ * or a space (then optional spaces) and a non-negative number:
+ *
+ *   "latency=45.2"  "took 123ms"  "duration: 1.5s"
+ *
+ * A time unit directly after the number converts the value to
+ * milliseconds (ns, us, ms, s); after a space separator the unit may
+ * also be the next word ("took 5 ms"). A number followed by any other
+ * word ("5sec", "took 5 seconds") does not parse. The first occurrence
+ * that parses is used.
+ * Returns 0 if the field was found, non-zero otherwise.
+ */
+int extract_field(
+    const char *message,
+    size_t len,
+    const char *name,
+    size_t name_len,
+    double *value
+);
+
+#endif
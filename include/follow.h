@@ -0,0 +1,81 @@
+#ifndef FOLLOW_H
+#define FOLLOW_H
+
+#include <stddef.h>
+#include "aggregator.h"
+
+/*
+ * Called whenever a refreshed report is due.
+ * Returns 0 on success; non-zero stops following.
+ */
+typedef int (*FollowReportFn)(AnalysisResult *result, void *ctx);
+
+/*
+ * Tails `filename` like `tail -F`: processes the existing contents,
+ * then feeds appended lines into `result` as they arrive (woken by
+ * inotify on Linux, by polling elsewhere).
+ *
+ * Rotation is handled without losing or double-counting lines:
+ *  - truncation (copytruncate) restarts reading at offset 0, including
+ *    when the file has regrown past our offset by the time we look
+ *    (noticed by its first bytes changing);
+ *  - rename + create drains the old file before switching to the new one.
+ * Only newline-terminated lines are processed while following; a
+ * partial last line waits for its newline (or for rotation/exit).
+ *
+ * Lines are selected by `filter` (may be NULL).
+ *
+ * `report` is invoked every `interval_sec` seconds if new lines were
+ * processed, and once more on exit. Runs until SIGINT/SIGTERM, or
+ * until `report` fails.
+ *
+ * Stores the number of successfully parsed lines in *processed.
+ * Returns 0 on clean shutdown, -1 on a read error, or the non-zero
+ * value returned by a failing `report`.
+ */
+int follow_file(
+    const char *filename,
+    const LineFilter *filter,
+    AnalysisResult *result,
+    unsigned interval_sec,
+    FollowReportFn report,
+    void *ctx,
+    size_t *processed
+);
+
+/*
+ * A followed file, for callers that run their own event loop.
+ */
+typedef struct Follower Follower;
+
+/*
+ * Opens `filename` for following from its first byte, feeding lines
+ * selected by `filter` (may be NULL) into `result`.
+ * Returns NULL if the file cannot be opened or memory runs out.
+ */
+Follower *follower_open(
+    const char *filename,
+    const LineFilter *filter,
+    AnalysisResult *result
+);
+
+/*
+ * Returns a descriptor that becomes readable when the file may have
+ * changed (inotify on Linux), or -1 if changes must be polled for.
+ */
+int follower_notify_fd(const Follower *f);
+
+/*
+ * Processes up to about `budget` bytes of new input; once caught up,
+ * also handles truncation and rotation like follow_file().
+ * Returns 1 if more input is ready, 0 if caught up, -1 on read error.
+ */
+int follower_step(Follower *f, size_t budget);
+
+/*
+ * Processes a trailing partial line and frees the follower.
+ * Returns the number of successfully parsed lines.
+ */
+size_t follower_close(Follower *f);
+
+#endif
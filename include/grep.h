@@ -0,0 +1,86 @@
+#ifndef GREP_H
+#define GREP_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "arena.h"
+#include "scan.h"
+
+/*
+ * Fixed-string multi-pattern matcher for --grep (case-sensitive).
+ *
+ * Patterns are compiled into an Aho-Corasick automaton stored as a
+ * full DFA over byte classes: bytes that occur in no pattern share
+ * class 0, so the table has (pattern bytes + 1) rows of a few dozen
+ * columns and each text byte costs one lookup. If that table would
+ * exceed 32 MB (many long patterns over many distinct bytes), the
+ * automaton stays a trie with failure links instead: states with
+ * several children (the root and the first levels) get a child row
+ * per class, within the same budget, and the others short child lists.
+ * That is about 21 bytes per state and a few more steps per text byte.
+ * While the automaton is at its root, the scan skips straight to the
+ * next byte that can start a pattern with scan_find_any() (vector
+ * compares for up to SCAN_SET_MAX start bytes). Read-only after
+ * grep_set_compile(), so one set can be shared by every thread.
+ */
+typedef struct {
+    /* Patterns collected by grep_set_add() */
+    StringArena text;
+    size_t *offsets;
+    size_t *lengths;
+    size_t count;
+    size_t capacity;
+
+    /* Compiled automaton */
+    uint32_t *next;            // DFA: next[state * class_count + class]
+    uint32_t *child;           // trie: first child of a state, 0 if none
+    uint32_t *sibling;         // trie: next child of the same parent
+    uint16_t *label;           // trie: class of the edge into a state
+    uint32_t *fail;            // trie: failure link
+    uint32_t *row_of;          // trie: 1 + child row of a state, or 0
+    uint32_t *rows;            // trie: child per class, bushy states only
+    size_t row_count;
+    size_t row_capacity;
+    uint8_t *accept;           // per state: some pattern ends here
+    size_t class_count;
+    uint16_t byte_class[256];  // 0 for bytes in no pattern
+    ScanByteSet starts;        // bytes that can start a pattern
+} GrepSet;
+
+/*
+ * Initializes an empty set.
+ * Returns 0 on success, non-zero on OOM.
+ */
+int grep_set_init(GrepSet *set);
+
+/*
+ * Adds a non-empty pattern of `len` bytes (copied).
+ * Returns 0 on success, non-zero on OOM or an empty pattern.
+ */
+int grep_set_add(GrepSet *set, const char *pattern, size_t len);
+
+/*
+ * Adds every non-empty line of a file as a pattern (a trailing "\r" is
+ * dropped).
+ * Returns 0 on success, non-zero if the file cannot be read.
+ */
+int grep_set_add_file(GrepSet *set, const char *path);
+
+/*
+ * Builds the automaton. Must be called after the last grep_set_add()
+ * and before grep_set_match().
+ * Returns 0 on success, non-zero on OOM or if the set is empty.
+ */
+int grep_set_compile(GrepSet *set);
+
+/*
+ * Returns non-zero if any pattern occurs in text[0, len).
+ */
+int grep_set_match(const GrepSet *set, const char *text, size_t len);
+
+/*
+ * Frees all memory owned by the set.
+ */
+void grep_set_free(GrepSet *set);
+
+#endif
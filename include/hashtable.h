@@ -0,0 +1,85 @@
+#ifndef HASHTABLE_H
+#define HASHTABLE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Open-addressing (linear probing) index from a 64-bit hash to an
+ * entry index in a caller-owned array. The table stores only the hash
+ * and the index, so growing it never touches or rehashes the payloads.
+ */
+typedef struct {
+    uint64_t hash;
+    size_t index;  // entry index + 1; 0 marks an empty slot
+} HashSlot;
+
+typedef struct {
+    HashSlot *slots;
+    size_t capacity;  // always a power of two
+    size_t count;
+
+    /* Work counters for --stats */
+    size_t lookups;
+    size_t probes;  // slots examined by all lookups
+} HashIndex;
+
+/*
+ * Returns non-zero if the entry at `index` matches the probed key.
+ */
+typedef int (*HashMatchFn)(const void *ctx, size_t index);
+
+/*
+ * Fast 64-bit hash of an arbitrary byte string.
+ */
+uint64_t hash_bytes(const void *data, size_t len);
+
+/*
+ * Initializes an empty index with zeroed counters.
+ * capacity is rounded up to a power of two.
+ * Returns 0 on success, non-zero on failure.
+ */
+int hash_index_init(HashIndex *index, size_t capacity);
+
+/*
+ * Probes for `hash`. Returns the slot holding a matching entry, or the
+ * empty slot where it should be inserted (slot->index == 0).
+ * `match` is only called for slots whose stored hash equals `hash`.
+ */
+HashSlot *hash_index_lookup(
+    HashIndex *index,
+    uint64_t hash,
+    HashMatchFn match,
+    const void *ctx
+);
+
+/*
+ * Fills an empty slot returned by hash_index_lookup() and grows the
+ * table when it becomes too full. Any previously returned slot pointer
+ * is invalidated. Returns 0 on success, or non-zero if the table is
+ * full and could not grow (the entry is not recorded).
+ */
+int hash_index_insert(
+    HashIndex *index,
+    HashSlot *slot,
+    uint64_t hash,
+    size_t entry_index
+);
+
+/*
+ * Removes the entry in an occupied slot returned by hash_index_lookup().
+ * Any previously returned slot pointer is invalidated.
+ */
+void hash_index_remove(HashIndex *index, HashSlot *slot);
+
+/*
+ * Removes every entry, keeping the capacity.
+ */
+void hash_index_clear(HashIndex *index);
+
+/*
+ * Frees the slot array.
+ */
+void hash_index_free(HashIndex *index);
+
+#endif
@@ -0,0 +1,84 @@
+#ifndef HEAVY_H
+#define HEAVY_H
+
+#include <stddef.h>
+#include "hashtable.h"
+
+/*
+ * One monitored message. Its true count lies in [count - error, count].
+ */
+typedef struct {
+    char *message;  // owned, null-terminated; reused on eviction
+    size_t message_len;
+    size_t message_capacity;
+    char *example;  // first message that produced it, or NULL
+    size_t example_len;
+    size_t example_capacity;
+    size_t count;
+    size_t error;
+    size_t seq;       // order of entry, for deterministic ties
+    size_t heap_pos;  // position in HeavyHitters.heap
+} HeavyItem;
+
+/*
+ * Space-Saving summary: approximate counts of the most frequent
+ * messages with a fixed number of counters. Any message occurring more
+ * than total / capacity times is guaranteed to be monitored, and each
+ * count overestimates by at most total / capacity.
+ *
+ * Items live in a fixed array, found by message hash through a
+ * HashIndex and ordered by a min-heap on count so the least frequent
+ * one can be evicted in O(log capacity).
+ */
+typedef struct {
+    HeavyItem *items;
+    size_t size;
+    size_t capacity;
+    size_t *heap;   // item indexes, smallest count first
+    HashIndex index;
+    size_t total;   // occurrences added
+    size_t next_seq;
+} HeavyHitters;
+
+/*
+ * Initializes an empty summary with `capacity` counters.
+ * Returns 0 on success, non-zero on OOM.
+ */
+int heavy_init(HeavyHitters *hh, size_t capacity);
+
+/*
+ * Adds `count` occurrences of a message whose counts may already be
+ * overestimated by `error` (0 for a fresh observation). `example` may
+ * be NULL.
+ * Returns 0 on success, non-zero on OOM.
+ */
+int heavy_add(
+    HeavyHitters *hh,
+    const char *message,
+    size_t len,
+    const char *example,
+    size_t example_len,
+    size_t count,
+    size_t error
+);
+
+/*
+ * Merges src into dst so that dst summarizes both streams with dst's
+ * capacity and the same error guarantee.
+ * Returns 0 on success, non-zero on OOM.
+ */
+int heavy_merge(HeavyHitters *dst, const HeavyHitters *src);
+
+/*
+ * Writes pointers to up to `n` items into out, highest count first;
+ * equal counts rank the smaller error, then the earlier entry first.
+ * Returns the number of items written.
+ */
+size_t heavy_top(const HeavyHitters *hh, size_t n, const HeavyItem **out);
+
+/*
+ * Frees all memory owned by the summary.
+ */
+void heavy_free(HeavyHitters *hh);
+
+#endif
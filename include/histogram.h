@@ -0,0 +1,70 @@
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Mergeable log-linear (HDR-style) histogram of non-negative values.
+ * Values are recorded in thousandths; each power of two is split into
+ * 2^HISTOGRAM_SUB_BITS equal sub-buckets, so a quantile is within
+ * 1 / 2^(HISTOGRAM_SUB_BITS + 1) (0.8%) of a recorded value, and values
+ * below 0.128 are exact. Counters are allocated only for the powers of
+ * two between the smallest and largest value seen: 64 of them (512
+ * bytes) per power of two, so at most about 1200 (10 KB) for values up
+ * to 10^4 and far fewer when they stay within one order of magnitude.
+ * Count, sum, min and max are exact.
+ */
+#define HISTOGRAM_SUB_BITS 6
+
+typedef struct {
+    size_t *counts;  // NULL until the first value
+    size_t base;     // counter index of counts[0]
+    size_t length;   // counters allocated
+    size_t total;    // values recorded
+    double sum;
+    double min;
+    double max;
+} Histogram;
+
+/*
+ * Initializes an empty histogram.
+ */
+void histogram_init(Histogram *hist);
+
+/*
+ * Records one value (negative values count as 0, values above about
+ * 4.6e15 as that).
+ * Returns 0 on success, non-zero on OOM.
+ */
+int histogram_add(Histogram *hist, double value);
+
+/*
+ * Adds every value recorded in src to dst.
+ * Returns 0 on success, non-zero on OOM.
+ */
+int histogram_merge(Histogram *dst, const Histogram *src);
+
+/*
+ * Returns the value at quantile q (0..1) by nearest rank, clamped to
+ * [min, max]; 0 if the histogram is empty.
+ */
+double histogram_quantile(const Histogram *hist, double q);
+
+/*
+ * Stores histogram_quantile(hist, qs[i]) in out[i] for `count`
+ * quantiles given in increasing order, in one pass over the counters.
+ */
+void histogram_quantiles(
+    const Histogram *hist,
+    const double *qs,
+    size_t count,
+    double *out
+);
+
+/*
+ * Frees the counters; the histogram is empty afterwards.
+ */
+void histogram_free(Histogram *hist);
+
+#endif
@@ -0,0 +1,46 @@
+#ifndef HLL_H
+#define HLL_H
+
+#include <stdint.h>
+
+/*
+ * HyperLogLog distinct-count estimator over 64-bit hashes.
+ * 2^precision one-byte registers give a standard error of about
+ * 1.04 / sqrt(2^precision): 3.3% at precision 10 (1 KB), 0.8% at 14
+ * (16 KB). Registers are allocated on the first hll_add() or
+ * hll_merge(), so unused estimators cost no memory.
+ */
+typedef struct {
+    uint8_t *registers;  // NULL until first use
+    unsigned precision;
+} HyperLogLog;
+
+/*
+ * Initializes an empty estimator with 2^precision registers (4..18).
+ */
+void hll_init(HyperLogLog *hll, unsigned precision);
+
+/*
+ * Records one (well-mixed) hash.
+ * Returns 0 on success, non-zero on OOM.
+ */
+int hll_add(HyperLogLog *hll, uint64_t hash);
+
+/*
+ * Merges src into dst, as if dst had seen every hash src has.
+ * Both must have the same precision.
+ * Returns 0 on success, non-zero on mismatch or OOM.
+ */
+int hll_merge(HyperLogLog *dst, const HyperLogLog *src);
+
+/*
+ * Returns the estimated number of distinct hashes added (0 if none).
+ */
+uint64_t hll_estimate(const HyperLogLog *hll);
+
+/*
+ * Frees the registers; the estimator is empty afterwards.
+ */
+void hll_free(HyperLogLog *hll);
+
+#endif
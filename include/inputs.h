@@ -0,0 +1,32 @@
+#ifndef INPUTS_H
+#define INPUTS_H
+
+#include <stddef.h>
+
+/*
+ * Resolved list of log files to analyze.
+ */
+typedef struct {
+    char **paths;
+    size_t count;
+    size_t capacity;
+} InputList;
+
+/*
+ * Expands command-line inputs into individual file paths:
+ *  - a directory contributes its regular files (non-recursive,
+ *    hidden files skipped, sorted by name);
+ *  - an argument that does not exist but contains glob characters
+ *    is expanded with glob(3);
+ *  - anything else is taken as a file path.
+ * Order follows the arguments. Errors are reported on stderr.
+ * Returns 0 on success, non-zero on failure.
+ */
+int expand_inputs(const char *const *args, size_t count, InputList *out);
+
+/*
+ * Frees all paths held by the list.
+ */
+void input_list_free(InputList *list);
+
+#endif
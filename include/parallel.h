@@ -0,0 +1,106 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <stddef.h>
+#include "parser.h"
+#include "aggregator.h"
+#include "options.h"
+#include "stats.h"
+#include "utils.h"
+
+/*
+ * Parses and aggregates every line in [data, data + len) using
+ * `parser`, whose timestamp cache carries over between calls.
+ * A final line without a trailing newline is processed too.
+ * Returns the number of lines that parsed successfully.
+ */
+size_t analyze_buffer(
+    AnalysisResult *result,
+    LogParser *parser,
+    const char *data,
+    size_t len
+);
+
+/*
+ * Like analyze_buffer(), but when `times` is non-NULL, splits lines,
+ * parses and aggregates in batches and adds the time spent in each
+ * stage (and the bytes read) to *times.
+ */
+size_t analyze_buffer_timed(
+    AnalysisResult *result,
+    LogParser *parser,
+    const char *data,
+    size_t len,
+    StageTimes *times
+);
+
+/*
+ * Reads every remaining line of `reader` into result like
+ * analyze_buffer_timed(), copying each batch of lines out of the
+ * reader's buffer. Stores the number of lines that parsed successfully
+ * in *processed. Decompression errors are left for file_reader_failed().
+ * Returns 0 on success, non-zero on OOM.
+ */
+int analyze_reader_timed(
+    AnalysisResult *result,
+    LogParser *parser,
+    FileReader *reader,
+    StageTimes *times,
+    size_t *processed
+);
+
+/*
+ * Splits [data, data + len) at newline boundaries into `threads`
+ * chunks, analyzes each chunk into its own AnalysisResult on a
+ * separate thread, then merges the results into `result` in input
+ * order. The merged result is identical to a sequential pass.
+ * Each chunk's parser uses `filter` (may be NULL). Stage times are
+ * summed over threads into `times` if non-NULL.
+ *
+ * Stores the number of successfully parsed lines in *processed.
+ * Returns 0 on success, non-zero on failure.
+ */
+int analyze_parallel(
+    AnalysisResult *result,
+    const char *data,
+    size_t len,
+    size_t threads,
+    const LineFilter *filter,
+    size_t *processed,
+    StageTimes *times
+);
+
+/*
+ * Returns the number of online CPU cores (at least 1).
+ */
+size_t cpu_count(void);
+
+/*
+ * Analyzes each of `count` files into its own AnalysisResult on a pool
+ * of `workers` threads. results[i] receives the result for paths[i]
+ * (caller frees each with cleanup_analyzer()); processed[i] receives
+ * its number of successfully parsed lines. Lines are selected by
+ * `filter` (may be NULL); mapped files with a time range are narrowed
+ * to it by binary search first. Stage times are summed over files into
+ * `times` if non-NULL.
+ *
+ * A file that cannot be opened, decoded or decompressed is reported on
+ * stderr and skipped: results[i] is NULL and processed[i] 0. The number
+ * of skipped files is stored in *skipped (may be NULL).
+ *
+ * Returns 0 on success (including skipped files), non-zero if memory
+ * ran out.
+ */
+int analyze_files(
+    char *const *paths,
+    size_t count,
+    size_t workers,
+    const AnalysisConfig *config,
+    const LineFilter *filter,
+    AnalysisResult **results,
+    size_t *processed,
+    size_t *skipped,
+    StageTimes *times
+);
+
+#endif
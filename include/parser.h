@@ -1,30 +1,122 @@
 #ifndef PARSER_H
 #define PARSER_H
 
-#define MAX_MESSAGE_LEN 1024
+#include <stddef.h>
+#include "grep.h"
+
 #define TIMESTAMP_LEN   19  // "YYYY-MM-DD HH:MM:SS"
+#define TIMESTAMP_HOUR_LEN 13  // "YYYY-MM-DD HH"
 
 typedef enum {
     LOG_LEVEL_UNKNOWN = -1,
     LOG_LEVEL_INFO    = 0,
     LOG_LEVEL_WARN    = 1,
-    LOG_LEVEL_ERROR   = 2
+    LOG_LEVEL_ERROR   = 2,
+    LOG_LEVEL_COUNT   = 3   // number of known levels
 } LogLevel;
 
 typedef struct {
     char timestamp[TIMESTAMP_LEN + 1];  // null-terminated
     LogLevel level;
-    char message[MAX_MESSAGE_LEN];
+    const char *message;  // view into the parsed line, NOT null-terminated
+    size_t message_len;
     long long timestamp_unix;
+    long long utc_offset;  // local time minus UTC at timestamp_unix
 } LogEntry;
 
 /*
- * Parses a single log line into LogEntry.
+ * Outcome of parse_log_line(): PARSE_OK, or why the line was rejected.
+ */
+typedef enum {
+    PARSE_OK = 0,
+    PARSE_TOO_SHORT,      // shorter than a timestamp and a space
+    PARSE_BAD_TIMESTAMP,  // malformed or impossible timestamp
+    PARSE_UNKNOWN_LEVEL,  // level is not INFO, WARN or ERROR
+    PARSE_OUT_OF_RANGE,   // outside the filter's time range
+    PARSE_NO_MATCH,       // contains none of the filter's patterns
+    PARSE_STATUS_COUNT
+} ParseStatus;
+
+/*
+ * Line selection applied while parsing. Read-only once set up, so one
+ * filter can be shared by the parsers of all threads.
+ */
+typedef struct {
+    long long since;  // first Unix time accepted (inclusive)
+    long long until;  // first Unix time rejected (exclusive)
+    const GrepSet *grep;  // compiled --grep patterns, or NULL
+} LineFilter;
+
+/*
+ * Per-stream parser state. Caches the local-time conversion so that
+ * consecutive lines do not pay for mktime():
+ *  - the Unix time of the current "YYYY-MM-DD HH" prefix, and
+ *  - the local UTC offset together with the span of Unix time over
+ *    which it is known to be constant (one DST segment).
+ * Not thread-safe; use one LogParser per thread.
+ */
+typedef struct {
+    char hour_prefix[TIMESTAMP_HOUR_LEN];
+    long long hour_base;  // Unix time of HH:00:00
+    int hour_valid;
+
+    long long utc_offset;  // local time minus UTC, in seconds
+    long long segment_start;
+    long long segment_end;
+    int segment_valid;
+
+    const LineFilter *filter;  // NULL accepts every line
+} LogParser;
+
+/*
+ * Initializes a filter that accepts every line (no range, no patterns).
+ */
+void line_filter_init(LineFilter *filter);
+
+/*
+ * Returns non-zero if the filter restricts the time range.
+ */
+int line_filter_has_range(const LineFilter *filter);
+
+/*
+ * Resets parser state and attaches `filter` (may be NULL), which must
+ * outlive the parser. Must be called before first use.
+ */
+void log_parser_init(LogParser *parser, const LineFilter *filter);
+
+/*
+ * Converts a "YYYY-MM-DD HH:MM:SS" local-time timestamp (TIMESTAMP_LEN
+ * bytes, not necessarily null-terminated) to Unix time.
+ * Returns 0 on success, non-zero if it is malformed.
+ */
+int parse_timestamp(
+    LogParser *parser,
+    const char *timestamp,
+    long long *out_unix
+);
+
+/*
+ * Parses a single log line of `len` bytes into LogEntry.
+ * The line need not be null-terminated and must not include
+ * the trailing newline.
  * Expected format:
  * YYYY-MM-DD HH:MM:SS LEVEL message
  *
- * Returns 0 on success, non-zero on failure.
+ * entry->message points into `line`, so the entry is only valid
+ * while the line buffer is.
+ *
+ * Returns PARSE_OK (0) on success, or the reason the line was rejected.
+ */
+ParseStatus parse_log_line(
+    LogParser *parser,
+    const char *line,
+    size_t len,
+    LogEntry *entry
+);
+
+/*
+ * Returns a short name for a ParseStatus, e.g. "bad_timestamp".
  */
-int parse_log_line(const char *line, LogEntry *entry);
+const char *parse_status_name(ParseStatus status);
 
 #endif
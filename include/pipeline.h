@@ -0,0 +1,48 @@
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include <stddef.h>
+#include "aggregator.h"
+#include "parser.h"
+#include "stats.h"
+#include "utils.h"
+
+/* Initial size of a pipeline block; blocks grow to fit longer lines */
+#define PIPELINE_BLOCK_SIZE (4 * 1024 * 1024)
+
+/*
+ * Analyzes one input as a three-stage pipeline, so that waiting for
+ * slow storage (NFS, pipes, decompression) overlaps with parsing:
+ *
+ *   I/O thread --filled--> `workers` parse threads --parsed--> caller
+ *        ^                                                      |
+ *        +---------------------- free blocks -------------------+
+ *
+ * The I/O thread fills PIPELINE_BLOCK_SIZE blocks cut at line ends.
+ * Each parse thread analyzes a block into its own AnalysisResult and
+ * the calling thread merges those in block order, so the result is
+ * identical to a sequential pass. The stages are connected by bounded
+ * Rings, and a fixed set of blocks circulates between them: a stalled
+ * stage stops the ones feeding it instead of buffering without limit.
+ *
+ * Input is data[0, len) when `data` is non-NULL (e.g. a narrowed
+ * mapping, whose page faults then happen on the I/O thread), otherwise
+ * everything left in `reader`. Lines are selected by `filter` (may be
+ * NULL). Stage times are summed over threads into `times` if non-NULL.
+ *
+ * Stores the number of successfully parsed lines in *processed.
+ * Returns 0 on success, non-zero on OOM or if no thread could be
+ * started. Decompression errors are left for file_reader_failed().
+ */
+int analyze_pipeline(
+    AnalysisResult *result,
+    FileReader *reader,
+    const char *data,
+    size_t len,
+    size_t workers,
+    const LineFilter *filter,
+    size_t *processed,
+    StageTimes *times
+);
+
+#endif
@@ -4,38 +4,176 @@
 #include <stddef.h>
 #include <stdbool.h>
 #include "aggregator.h"
+#include "sink.h"
+
+/*
+ * One reported error, from the exact table or the approximate summary.
+ * The true count lies in [count - error, count]; error is 0 when exact.
+ */
+typedef struct {
+    const char *message;  // or template
+    const char *example;  // first matching message (templates only)
+    size_t message_len;   // messages may contain NUL bytes
+    size_t example_len;
+    size_t count;
+    size_t error;
+} TopError;
+
+/*
+ * Top errors selected once per report and shared by every writer.
+ */
+typedef struct {
+    TopError *entries;  // most frequent first
+    size_t count;
+    bool approximate;   // counts come from --approx-top
+} TopErrors;
+
+/*
+ * Message templates carrying the --field value, most values first.
+ */
+typedef struct {
+    const FieldEntry **entries;
+    size_t count;
+} TopFields;
+
+/*
+ * Per-file breakdown entry for --per-file reports.
+ */
+typedef struct {
+    const char *path;
+    const AnalysisResult *result;
+} FileReport;
+
+/*
+ * Selects up to top_n most frequent errors of result into top.
+ * The entries point into result and stay valid until it is modified.
+ * Returns 0 on success, non-zero on OOM.
+ * Release with top_errors_free().
+ */
+int top_errors_select(
+    TopErrors *top,
+    const AnalysisResult *result,
+    size_t top_n
+);
+
+/*
+ * Frees memory owned by a TopErrors selection.
+ */
+void top_errors_free(TopErrors *top);
+
+/*
+ * Selects up to top_n field templates of result into fields (none
+ * unless the result extracts a field).
+ * Returns 0 on success, non-zero on OOM.
+ * Release with top_fields_free().
+ */
+int top_fields_select(
+    TopFields *fields,
+    const AnalysisResult *result,
+    size_t top_n
+);
+
+/*
+ * Frees memory owned by a TopFields selection.
+ */
+void top_fields_free(TopFields *fields);
+
+/*
+ * Every writer below appends to `out`; the caller flushes it.
+ */
 
 /*
  * Prints a human-readable text summary.
  */
-void print_summary(const AnalysisResult *result, bool errors_only);
+void print_summary(
+    ReportSink *out,
+    const AnalysisResult *result,
+    bool errors_only
+);
 
 /*
  * Prints the top N most frequent error messages (text output).
  */
-void print_top_errors(const AnalysisResult *result, size_t top_n);
+void print_top_errors(
+    ReportSink *out,
+    const AnalysisResult *result,
+    const TopErrors *top
+);
+
+/*
+ * Prints --field percentiles, overall and by template (text output).
+ */
+void print_field_text(
+    ReportSink *out,
+    const AnalysisResult *result,
+    const TopFields *fields
+);
+
+/*
+ * Prints per-file counts in text format.
+ */
+void print_per_file_text(
+    ReportSink *out,
+    const FileReport *files,
+    size_t file_count,
+    bool errors_only
+);
+
+/*
+ * Sections of the JSON report, each appended as one "key":value object
+ * member without surrounding braces or commas:
+ *  - "summary":{...} (level counts, or only errors with errors_only);
+ *  - "top_errors":[...];
+ *  - "time_buckets":[...], from bucket index `first` on.
+ */
+void print_summary_json(
+    ReportSink *out,
+    const AnalysisResult *result,
+    bool errors_only
+);
+void print_top_errors_json(
+    ReportSink *out,
+    const AnalysisResult *result,
+    const TopErrors *top
+);
+void print_time_buckets_json(
+    ReportSink *out,
+    const AnalysisResult *result,
+    size_t first
+);
 
 /*
  * Prints the full report in JSON format.
+ * `files` (optional, may be NULL) adds a per-file breakdown.
  */
 void print_report_json(
+    ReportSink *out,
     const AnalysisResult *result,
     bool errors_only,
-    size_t top_n
+    const TopErrors *top,
+    const TopFields *fields,
+    const FileReport *files,
+    size_t file_count
 );
 
 /*
- * Prints the full report in CSV format.
+ * Prints the full report in CSV format. Text cells are quoted per
+ * RFC 4180.
+ * `files` (optional, may be NULL) adds a per-file breakdown.
  */
 void print_report_csv(
+    ReportSink *out,
     const AnalysisResult *result,
     bool errors_only,
-    size_t top_n
+    const TopErrors *top,
+    const TopFields *fields,
+    const FileReport *files,
+    size_t file_count
 );
 
 /*
  * Prints time-based aggregation buckets in text format.
  */
-void print_time_buckets_text(const AnalysisResult *result);
+void print_time_buckets_text(ReportSink *out, const AnalysisResult *result);
 
 #endif
@@ -0,0 +1,60 @@
+#ifndef RING_H
+#define RING_H
+
+#include <stddef.h>
+#include <semaphore.h>
+
+/*
+ * Bounded multi-producer/multi-consumer queue of pointers.
+ *
+ * Slots are claimed with atomic counters and handed over through a
+ * per-slot sequence number, so producers and consumers never take a
+ * lock. Two counting semaphores track free slots and queued items:
+ * ring_push() blocks while the ring is full (backpressure) and
+ * ring_pop() blocks while it is empty, without spinning. Both are
+ * futex-based, so uncontended calls stay in user space.
+ */
+typedef struct {
+    size_t sequence;
+    void *value;
+} RingSlot;
+
+typedef struct {
+    RingSlot *slots;
+    size_t mask;  // capacity - 1
+
+    /* Producer and consumer positions on separate cache lines */
+    char pad0[64];
+    size_t head;
+    char pad1[64];
+    size_t tail;
+    char pad2[64];
+
+    sem_t spaces;
+    sem_t items;
+} Ring;
+
+/*
+ * Initializes a ring holding at least `capacity` pointers (rounded up
+ * to a power of two).
+ * Returns 0 on success, non-zero on failure.
+ */
+int ring_init(Ring *ring, size_t capacity);
+
+/*
+ * Appends a pointer, waiting while the ring is full.
+ */
+void ring_push(Ring *ring, void *value);
+
+/*
+ * Removes and returns the oldest pointer, waiting while the ring is
+ * empty.
+ */
+void *ring_pop(Ring *ring);
+
+/*
+ * Frees the ring. No thread may be using it.
+ */
+void ring_free(Ring *ring);
+
+#endif
@@ -0,0 +1,93 @@
+#ifndef SCAN_H
+#define SCAN_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Newline offsets produced per scan_newlines() call by the analyzers */
+#define SCAN_BATCH 256
+
+/* Sets of up to this many bytes are searched with vector compares */
+#define SCAN_SET_MAX 8
+
+/*
+ * A set of bytes for scan_find_any(): listed for the vector kernels
+ * (if there are at most SCAN_SET_MAX) and as a lookup table.
+ */
+typedef struct {
+    unsigned char bytes[SCAN_SET_MAX];
+    size_t count;         // distinct bytes added
+    uint8_t member[256];  // non-zero for bytes in the set
+} ScanByteSet;
+
+/*
+ * Newline search kernels. All of them return identical results; the
+ * vector kernels compare 64 bytes per step and turn the matches into a
+ * bit mask, so a block of short lines costs a few instructions per line
+ * instead of one memchr() call each.
+ */
+typedef enum {
+    SCAN_SCALAR = 0,  // memchr() loop, any platform
+    SCAN_SSE2,        // x86 SSE2
+    SCAN_AVX2,        // x86 AVX2, chosen at runtime via CPUID
+    SCAN_KERNEL_COUNT
+} ScanKernel;
+
+/*
+ * Writes the offsets of up to `max` newlines in data[from, len) to
+ * `out`, in increasing order.
+ * Returns the number written; fewer than `max` means the rest of the
+ * buffer has no newline.
+ */
+size_t scan_newlines(
+    const char *data,
+    size_t len,
+    size_t from,
+    size_t *out,
+    size_t max
+);
+
+/*
+ * Empties a byte set.
+ */
+void scan_byte_set_init(ScanByteSet *set);
+
+/*
+ * Adds a byte to the set (adding it again has no effect).
+ */
+void scan_byte_set_add(ScanByteSet *set, unsigned char byte);
+
+/*
+ * Returns the offset of the first byte of data[from, len) that is in
+ * `set`, or len if there is none. Uses the same kernel as
+ * scan_newlines(): memchr() for a single byte, and on x86 vector
+ * compares against every byte of sets up to SCAN_SET_MAX; larger sets
+ * go through the lookup table.
+ */
+size_t scan_find_any(
+    const char *data,
+    size_t len,
+    size_t from,
+    const ScanByteSet *set
+);
+
+/*
+ * Returns the kernel scan_newlines() uses: the fastest one the CPU
+ * supports, unless overridden by scan_use_kernel().
+ */
+ScanKernel scan_kernel(void);
+
+/*
+ * Makes scan_newlines() and scan_find_any() use `kernel` (e.g. to
+ * benchmark or compare kernels). Not thread-safe; call before starting
+ * workers.
+ * Returns 0 on success, non-zero if the CPU does not support it.
+ */
+int scan_use_kernel(ScanKernel kernel);
+
+/*
+ * Returns a short name for a kernel, e.g. "avx2".
+ */
+const char *scan_kernel_name(ScanKernel kernel);
+
+#endif
@@ -0,0 +1,49 @@
+#ifndef SERVE_H
+#define SERVE_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include "aggregator.h"
+#include "parser.h"
+
+/*
+ * Keeps `result` resident and serves it on the Unix stream socket
+ * `socket_path` until SIGINT/SIGTERM.
+ *
+ * Lines come from two kinds of sources, all selected by `filter` (may
+ * be NULL):
+ *  - `files`, followed from their first byte like follow_file();
+ *  - clients, which may write log lines to the socket.
+ * A client line whose first word is a query is answered instead, with
+ * one line of JSON:
+ *  - `summary`     {"summary":{...}}, as in --output json;
+ *  - `top [N]`     {"top_errors":[...]}, N defaulting to top_n;
+ *  - `buckets [N]` {"time_buckets":[...]}, the last N (default: all);
+ *  - `report`      the full JSON report.
+ * Once a client has sent a valid query, a later short line of one word
+ * of letters (plus at most one argument) that is no query, e.g.
+ * "SUMMARY", gets {"error":"unknown query"}; before that such lines are
+ * log lines. A query with a bad argument gets an error object too. A query sees every
+ * line its client sent before it.
+ *
+ * Everything runs on one epoll loop. Input is taken a bounded amount
+ * per source and iteration, and responses are buffered per client, so
+ * a query waits for at most a few hundred KB of parsing and a slow
+ * client never stalls the others.
+ *
+ * Stores the number of successfully parsed lines in *processed.
+ * Returns 0 on clean shutdown, non-zero on error (an error has been
+ * printed).
+ */
+int serve_socket(
+    const char *socket_path,
+    char *const *files,
+    size_t file_count,
+    const LineFilter *filter,
+    AnalysisResult *result,
+    size_t top_n,
+    bool errors_only,
+    size_t *processed
+);
+
+#endif
@@ -0,0 +1,102 @@
+#ifndef SINK_H
+#define SINK_H
+
+#include <stddef.h>
+
+/* Bytes collected before a write() to the output */
+#define SINK_BUFFER_SIZE (256 * 1024)
+
+/*
+ * Buffered output for reports.
+ *
+ * Everything is appended to one large buffer that is handed to write()
+ * when full; a write larger than the free space goes out together with
+ * the buffer in a single writev(). Integers are formatted by hand and
+ * strings are escaped a run of plain bytes at a time, so a report with
+ * hundreds of thousands of rows costs a few dozen system calls and no
+ * per-character stdio calls.
+ *
+ * A write error is remembered and reported by sink_close(); later
+ * output is dropped.
+ *
+ * A memory sink (sink_open_memory()) never writes: its buffer grows to
+ * hold everything appended, and the owner takes buffer[0, used).
+ */
+typedef struct {
+    int fd;       // -1 for a memory sink
+    int owns_fd;  // opened by sink_open(), closed by sink_close()
+    int failed;
+    char *buffer;
+    size_t used;
+    size_t capacity;
+} ReportSink;
+
+/*
+ * Opens a sink writing to `path` (created or truncated), or to
+ * standard output when path is NULL.
+ * Returns 0 on success, non-zero if the file cannot be created or
+ * memory runs out.
+ */
+int sink_open(ReportSink *sink, const char *path);
+
+/*
+ * Opens a sink that keeps its output in memory.
+ * Returns 0 on success, non-zero on OOM.
+ */
+int sink_open_memory(ReportSink *sink);
+
+/*
+ * Appends `len` bytes.
+ */
+void sink_write(ReportSink *sink, const char *data, size_t len);
+
+/*
+ * Appends a NUL-terminated string.
+ */
+void sink_puts(ReportSink *sink, const char *s);
+
+/*
+ * Appends one byte.
+ */
+void sink_putc(ReportSink *sink, char c);
+
+/*
+ * Appends an unsigned or signed integer in decimal.
+ */
+void sink_uint(ReportSink *sink, unsigned long long value);
+void sink_int(ReportSink *sink, long long value);
+
+/*
+ * Appends `value` in decimal, zero-padded to at least `width` digits.
+ */
+void sink_uint_padded(ReportSink *sink, unsigned long long value,
+                      int width);
+
+/*
+ * Appends `len` bytes of s escaped for the inside of a JSON string
+ * literal (quotes, backslashes and control characters, NUL included).
+ */
+void sink_json_string(ReportSink *sink, const char *s, size_t len);
+
+/*
+ * Appends `len` bytes of s as one quoted CSV field (RFC 4180): wrapped
+ * in double quotes, with embedded quotes doubled. Newlines and commas
+ * are kept as they are inside the quotes.
+ */
+void sink_csv_field(ReportSink *sink, const char *s, size_t len);
+
+/*
+ * Writes out everything buffered so far (nothing for a memory sink).
+ * Returns 0 on success, non-zero if any write, or growing a memory
+ * sink, has failed.
+ */
+int sink_flush(ReportSink *sink);
+
+/*
+ * Flushes, closes the output file if sink_open() opened one and frees
+ * the buffer.
+ * Returns 0 on success, non-zero if any write or the close failed.
+ */
+int sink_close(ReportSink *sink);
+
+#endif
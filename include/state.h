@@ -0,0 +1,89 @@
+#ifndef STATE_H
+#define STATE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+#include "aggregator.h"
+
+/*
+ * Where a saved analysis stopped in its log file. The file identity
+ * (device + inode) and a hash of the last processed line detect a
+ * log that was replaced, truncated or rewritten since the snapshot.
+ */
+typedef struct {
+    uint64_t dev;
+    uint64_t ino;
+    uint64_t offset;          // bytes covered; always just after a newline
+    uint64_t last_line_len;   // including its newline
+    uint64_t last_line_hash;
+} StateCheckpoint;
+
+/*
+ * A verified snapshot file held in memory until restored.
+ */
+typedef struct {
+    StateCheckpoint checkpoint;
+    GroupBy group_by;
+
+    char *data;
+    size_t len;
+} StateSnapshot;
+
+/*
+ * Records that the first `offset` bytes of `data` (a file identified
+ * by dev/ino) have been analyzed. `offset` must be 0 or just after a
+ * newline.
+ */
+void state_checkpoint_init(
+    StateCheckpoint *checkpoint,
+    dev_t dev,
+    ino_t ino,
+    const char *data,
+    size_t offset
+);
+
+/*
+ * Returns non-zero if `data` (len bytes of the file dev/ino) still
+ * begins with the content the checkpoint was taken on.
+ */
+int state_checkpoint_matches(
+    const StateCheckpoint *checkpoint,
+    dev_t dev,
+    ino_t ino,
+    const char *data,
+    size_t len
+);
+
+/*
+ * Reads and verifies a snapshot file.
+ * Returns 0 on success, 1 if the file does not exist, 2 if it was
+ * written by an older version (which lacks some counters), -1 if it is
+ * unreadable, corrupt or from an incompatible version (an explanation
+ * has been printed).
+ */
+int state_read(const char *path, StateSnapshot *snapshot);
+
+/*
+ * Loads the snapshot's counters, errors and buckets into an empty
+ * result with the same group_by.
+ * Returns 0 on success, non-zero on failure.
+ */
+int state_restore(const StateSnapshot *snapshot, AnalysisResult *result);
+
+/*
+ * Frees the memory held by a snapshot.
+ */
+void state_snapshot_free(StateSnapshot *snapshot);
+
+/*
+ * Atomically replaces `path` with a snapshot of result + checkpoint.
+ * Returns 0 on success, non-zero on failure (an error has been printed).
+ */
+int state_write(
+    const char *path,
+    const AnalysisResult *result,
+    const StateCheckpoint *checkpoint
+);
+
+#endif
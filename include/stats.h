@@ -0,0 +1,58 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include <stddef.h>
+#include <stdio.h>
+#include "aggregator.h"
+
+/*
+ * Pipeline stages timed by --stats.
+ */
+typedef enum {
+    STAGE_READ,       // opening, mapping, reading and splitting into lines
+    STAGE_PARSE,      // parse_log_line(), or decoding columnar rows
+    STAGE_AGGREGATE,  // process_log_line()
+    STAGE_MERGE,      // merging per-thread and per-file results
+    STAGE_REPORT,     // selecting and printing the report
+    STAGE_COUNT
+} Stage;
+
+/*
+ * Time spent per stage, in seconds. Stages running on several threads
+ * are summed over threads, so they can add up to more than wall time.
+ */
+typedef struct {
+    double seconds[STAGE_COUNT];
+    size_t bytes;  // input bytes split into lines
+} StageTimes;
+
+/*
+ * Returns the current CLOCK_MONOTONIC time in seconds.
+ */
+double stats_clock(void);
+
+/*
+ * Zeroes all stage times.
+ */
+void stage_times_init(StageTimes *times);
+
+/*
+ * Adds the times of src to dst.
+ */
+void stage_times_add(StageTimes *dst, const StageTimes *src);
+
+/*
+ * Prints the --stats block: stage times, `wall` seconds overall, lines
+ * read, accepted (`processed`) and rejected by reason, hash index
+ * probes and time bucket inserts. As a single JSON object if `json`.
+ */
+void print_stats(
+    FILE *out,
+    const StageTimes *times,
+    double wall,
+    const AnalysisResult *result,
+    size_t processed,
+    int json
+);
+
+#endif
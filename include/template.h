@@ -0,0 +1,30 @@
+#ifndef TEMPLATE_H
+#define TEMPLATE_H
+
+#include <stddef.h>
+
+/*
+ * Upper bound on the length of mask_message() output for a message of
+ * `len` bytes: the shortest maskable token is one digit and its
+ * placeholder is five bytes.
+ */
+#define TEMPLATE_MAX_LEN(len) ((len) * 3 + 2)
+
+/*
+ * Writes the template of a message to `out`, which must have room for
+ * TEMPLATE_MAX_LEN(len) bytes, replacing variable tokens that start at
+ * a word boundary with placeholders:
+ *
+ *   <UUID>  8-4-4-4-12 hex UUIDs
+ *   <IP>    dotted IPv4 addresses, with an optional :port
+ *   <HEX>   0x-prefixed hex, or 4+ hex digits mixing letters and digits
+ *   <NUM>   integers and decimals; a unit suffix is kept ("<NUM>ms")
+ *   <STR>   single- or double-quoted strings
+ *
+ * One linear pass; look-ahead is bounded except for quoted strings.
+ * The output is not null-terminated.
+ * Returns the template length.
+ */
+size_t mask_message(const char *message, size_t len, char *out);
+
+#endif
@@ -0,0 +1,44 @@
+#ifndef TIMERANGE_H
+#define TIMERANGE_H
+
+#include <stddef.h>
+#include "parser.h"
+#include "utils.h"
+
+/*
+ * Narrows a timestamp-ordered buffer to the lines that can fall inside
+ * the filter's [since, until) range, by binary search over line starts.
+ * Only O(log len) lines are parsed, so a window query touches a few
+ * pages around each probe instead of the whole buffer.
+ *
+ * Lines may be out of order by up to a minute (timestamp jitter): the
+ * range is widened by that much, so it still holds every line inside
+ * [since, until).
+ *
+ * On success stores the byte range [*start, *end) (both at line starts)
+ * and returns 0. Returns non-zero if the probes show that the buffer is
+ * not sorted by time beyond that slack; the caller should then scan all
+ * of it and rely on the parser's filter alone.
+ */
+int find_time_window(
+    const char *data,
+    size_t len,
+    const LineFilter *filter,
+    size_t *start,
+    size_t *end
+);
+
+/*
+ * Narrows the mapping of `reader` (*data, *len) to the filter's window,
+ * with read-ahead hints for the search and for the window itself.
+ * Leaves them unchanged if the filter has no time range or the file is
+ * not sorted by time.
+ */
+void narrow_to_time_window(
+    const FileReader *reader,
+    const LineFilter *filter,
+    const char **data,
+    size_t *len
+);
+
+#endif
@@ -1,28 +1,99 @@
 #ifndef UTILS_H
 #define UTILS_H
 
-#include <stdio.h>
 #include <stddef.h>
+#include "decompress.h"
 
-#define BUFFER_SIZE 4096
+#define BUFFER_SIZE (64 * 1024)
 
+/*
+ * Line reader over a log file.
+ *
+ * Regular files are memory-mapped and lines are returned as views
+ * straight into the mapping. Pipes, character devices and other
+ * non-mappable inputs fall back to read() into a growable buffer.
+ * In both modes there is no limit on line length.
+ *
+ * gzip and zstd input is recognised by its magic bytes and decompressed
+ * on a helper thread; lines are then returned as views into the
+ * decompressed blocks, or into a carry buffer when a line spans two.
+ */
 typedef struct {
-    FILE *file;
-    char buffer[BUFFER_SIZE];
+    int fd;
+
+    /* mmap mode */
+    const char *map;
+    size_t map_size;
+    size_t pos;
+
+    /* read() fallback mode */
+    char *buffer;
+    size_t buffer_capacity;
+    size_t buffer_start;
+    size_t buffer_end;
+    int eof;
+
+    /* Set when a read error or OOM cut the input short */
+    int failed;
+
+    /* Compressed input */
+    Decompressor *decomp;
+    const char *block;
+    size_t block_len;
+    size_t block_pos;
+    char *carry;
+    size_t carry_capacity;
 } FileReader;
 
 /*
- * Opens a file for buffered reading.
+ * Opens a file for reading.
  * Returns NULL on failure.
  */
 FileReader *file_reader_open(const char *filename);
 
 /*
  * Reads the next line from the file.
- * Returns a pointer to an internal buffer, or NULL on EOF or error.
- * The returned pointer is invalidated by the next call.
+ * Returns a pointer to the first byte of the line and stores its
+ * length (excluding the trailing newline) in *len, or returns NULL
+ * on EOF or error. The line is NOT null-terminated.
+ * The returned view is invalidated by the next call.
+ */
+const char *file_reader_read_line(FileReader *reader, size_t *len);
+
+/*
+ * Copies up to `cap` bytes of the remaining input (decompressed if
+ * needed) into dst, with no regard for line boundaries. May return
+ * fewer bytes than are left; keep calling until it returns 0 at EOF.
+ * Do not mix with file_reader_read_line() on the same reader.
+ */
+size_t file_reader_read_block(FileReader *reader, char *dst, size_t cap);
+
+/*
+ * Returns the whole file contents when the file is memory-mapped and
+ * stores its size in *len, or returns NULL for read() fallback and
+ * compressed inputs.
+ * The view stays valid until file_reader_close().
+ */
+const char *file_reader_mapping(const FileReader *reader, size_t *len);
+
+/*
+ * Hints how a memory-mapped file will be read next: scattered probes
+ * (random != 0, e.g. a binary search) or one sequential pass over
+ * [offset, offset + len). No-op for inputs that are not mapped.
+ */
+void file_reader_advise(
+    const FileReader *reader,
+    size_t offset,
+    size_t len,
+    int random
+);
+
+/*
+ * Returns non-zero if reading stopped early: a read() error, a line too
+ * long to buffer in memory, or corrupt or truncated compressed input.
+ * Reads that stop this way look like EOF, so check after the last one.
  */
-char *file_reader_read_line(FileReader *reader);
+int file_reader_failed(const FileReader *reader);
 
 /*
  * Closes the file and frees associated resources.
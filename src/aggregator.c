@@ -1,36 +1,45 @@
 #include "aggregator.h"
 #include "parser.h"
+#include "template.h"
+#include "field.h"
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <time.h>
+
+/* Dense bucket slots grow to cover gaps up to this many empty slots */
+#define DENSE_MIN_SLOTS 1024
 
 /* ---------- Initialization ---------- */
 
-AnalysisResult *init_analyzer(GroupBy group_by) {
-    AnalysisResult *result = malloc(sizeof(*result));
-    if (!result) return NULL;
+AnalysisResult *init_analyzer(const AnalysisConfig *config) {
+    if (!config) return NULL;
 
-    result->total_lines = 0;
-    result->info_count  = 0;
-    result->warn_count  = 0;
-    result->error_total = 0;
+    AnalysisResult *result = calloc(1, sizeof(*result));
+    if (!result) return NULL;
 
-    result->error_unique   = 0;
     result->error_capacity = 100;
+    result->config = *config;
+    result->time_buckets_sorted = 1;
 
-    result->group_by = group_by;
-
-    result->time_buckets        = NULL;
-    result->time_bucket_count   = 0;
-    result->time_bucket_capacity = 0;
+    for (int level = 0; level < LOG_LEVEL_COUNT; level++) {
+        hll_init(&result->distinct[level], DISTINCT_PRECISION);
+    }
+    histogram_init(&result->field_values);
+    result->field_len = config->field ? strlen(config->field) : 0;
 
     result->error_entries =
         calloc(result->error_capacity, sizeof(ErrorEntry));
 
-    if (!result->error_entries) {
-        free(result);
+    if (!result->error_entries ||
+        hash_index_init(&result->error_index,
+                        result->error_capacity * 2) != 0 ||
+        arena_init(&result->error_messages, 0) != 0 ||
+        hash_index_init(&result->bucket_index, 0) != 0 ||
+        hash_index_init(&result->field_index, 0) != 0 ||
+        (config->approx_top &&
+         heavy_init(&result->heavy, config->approx_top) != 0)) {
+        cleanup_analyzer(result);
         return NULL;
     }
 
@@ -39,53 +48,119 @@ AnalysisResult *init_analyzer(GroupBy group_by) {
 
 /* ---------- Time Bucketing ---------- */
 
-static long long bucket_start_unix(long long ts_unix, GroupBy group_by) {
-    if (group_by == GROUP_BY_NONE) return ts_unix;
+static long long bucket_width(GroupBy group_by) {
+    return group_by == GROUP_BY_HOUR ? 3600 : 60;
+}
 
-    time_t t = (time_t)ts_unix;
-    struct tm tm_value;
+/*
+ * Start of the local minute/hour containing ts_unix, computed from the
+ * UTC offset the parser already resolved for this timestamp.
+ */
+static long long bucket_start_unix(
+    long long ts_unix,
+    long long utc_offset,
+    long long width
+) {
+    long long rem = (ts_unix + utc_offset) % width;
+    if (rem < 0) rem += width;
 
-#if defined(_POSIX_THREAD_SAFE_FUNCTIONS)
-    localtime_r(&t, &tm_value);
-#else
-    struct tm *tmp = localtime(&t);
-    if (!tmp) return ts_unix;
-    tm_value = *tmp;
-#endif
+    return ts_unix - rem;
+}
 
-    if (group_by == GROUP_BY_HOUR) {
-        tm_value.tm_min = 0;
-        tm_value.tm_sec = 0;
-    } else if (group_by == GROUP_BY_MINUTE) {
-        tm_value.tm_sec = 0;
-    }
+typedef struct {
+    const AnalysisResult *result;
+    long long start;
+} BucketKey;
 
-    time_t bucket = mktime(&tm_value);
-    if (bucket == (time_t)-1) return ts_unix;
+static int bucket_matches(const void *ctx, size_t index) {
+    const BucketKey *key = ctx;
 
-    return (long long)bucket;
+    return key->result->time_buckets[index].start_unix == key->start;
 }
 
 /*
- * Adds or updates a time bucket.
- * Linear scan is acceptable for coarse aggregation.
- * Can be optimized with a hashmap if needed.
+ * Returns the dense slot for bucket_start, or (size_t)-1 if the start
+ * is before the base or not aligned to it.
  */
-static void add_time_bucket(AnalysisResult *result, const LogEntry *entry) {
-    if (!result || !entry) return;
-    if (result->group_by == GROUP_BY_NONE) return;
+static size_t dense_slot(const AnalysisResult *result, long long bucket_start) {
+    long long width = bucket_width(result->config.group_by);
+    long long delta = bucket_start - result->bucket_base;
 
-    long long bucket_start =
-        bucket_start_unix(entry->timestamp_unix, result->group_by);
+    if (!result->bucket_slots || delta < 0 || delta % width != 0) {
+        return (size_t)-1;
+    }
+    return (size_t)(delta / width);
+}
 
-    for (size_t i = 0; i < result->time_bucket_count; i++) {
-        TimeBucket *b = &result->time_buckets[i];
-        if (b->start_unix == bucket_start) {
-            b->total++;
-            if (entry->level == LOG_LEVEL_INFO)  b->info++;
-            if (entry->level == LOG_LEVEL_WARN)  b->warn++;
-            if (entry->level == LOG_LEVEL_ERROR) b->error++;
-            return;
+/*
+ * Records bucket `index` in the dense array when its slot is within
+ * reach, otherwise in the hash fallback.
+ * Returns 0 on success, non-zero on OOM.
+ */
+static int index_time_bucket(AnalysisResult *result, size_t index) {
+    long long start = result->time_buckets[index].start_unix;
+
+    if (!result->bucket_slots) {
+        result->bucket_slots = calloc(DENSE_MIN_SLOTS, sizeof(size_t));
+        if (!result->bucket_slots) return -1;
+
+        result->bucket_base = start;
+        result->bucket_slot_count = DENSE_MIN_SLOTS;
+    }
+
+    size_t slot = dense_slot(result, start);
+    size_t reach = result->bucket_slot_count * 2 + DENSE_MIN_SLOTS;
+
+    if (slot != (size_t)-1 && slot < reach) {
+        if (slot >= result->bucket_slot_count) {
+            size_t new_count = result->bucket_slot_count * 2;
+            while (new_count <= slot) new_count *= 2;
+
+            size_t *new_slots =
+                realloc(result->bucket_slots, new_count * sizeof(size_t));
+            if (!new_slots) return -1;
+
+            memset(new_slots + result->bucket_slot_count, 0,
+                   (new_count - result->bucket_slot_count) * sizeof(size_t));
+
+            result->bucket_slots = new_slots;
+            result->bucket_slot_count = new_count;
+        }
+
+        result->bucket_slots[slot] = index + 1;
+        return 0;
+    }
+
+    BucketKey key = { result, start };
+    uint64_t hash = hash_bytes(&start, sizeof(start));
+    HashSlot *hslot =
+        hash_index_lookup(&result->bucket_index, hash, bucket_matches, &key);
+
+    return hash_index_insert(&result->bucket_index, hslot, hash, index);
+}
+
+/*
+ * Finds the bucket starting at bucket_start, creating it if needed.
+ * In-order and dense logs hit the dense array in O(1); buckets outside
+ * it are found through the hash fallback.
+ * Returns NULL on OOM.
+ */
+static TimeBucket *find_or_add_time_bucket(
+    AnalysisResult *result,
+    long long bucket_start
+) {
+    size_t slot = dense_slot(result, bucket_start);
+    if (slot < result->bucket_slot_count && result->bucket_slots[slot]) {
+        return &result->time_buckets[result->bucket_slots[slot] - 1];
+    }
+
+    if (result->bucket_index.count > 0) {
+        BucketKey key = { result, bucket_start };
+        uint64_t hash = hash_bytes(&bucket_start, sizeof(bucket_start));
+        HashSlot *hslot = hash_index_lookup(&result->bucket_index, hash,
+                                            bucket_matches, &key);
+        if (hslot->index != 0) {
+            return &result->time_buckets[hslot->index - 1];
         }
     }
 
@@ -97,58 +172,371 @@ static void add_time_bucket(AnalysisResult *result, const LogEntry *entry) {
         TimeBucket *new_buckets =
             realloc(result->time_buckets, new_capacity * sizeof(TimeBucket));
 
-        if (!new_buckets) return;  // drop bucket on OOM
+        if (!new_buckets) return NULL;  // drop bucket on OOM
 
         result->time_buckets = new_buckets;
         result->time_bucket_capacity = new_capacity;
     }
 
-    TimeBucket *bucket =
-        &result->time_buckets[result->time_bucket_count++];
+    size_t index = result->time_bucket_count;
+    TimeBucket *bucket = &result->time_buckets[index];
 
     bucket->start_unix = bucket_start;
-    bucket->total = 1;
-    bucket->info  = (entry->level == LOG_LEVEL_INFO);
-    bucket->warn  = (entry->level == LOG_LEVEL_WARN);
-    bucket->error = (entry->level == LOG_LEVEL_ERROR);
+    bucket->total = 0;
+    bucket->info  = 0;
+    bucket->warn  = 0;
+    bucket->error = 0;
+    for (int level = 0; level < LOG_LEVEL_COUNT; level++) {
+        hll_init(&bucket->distinct[level], DISTINCT_BUCKET_PRECISION);
+    }
+    histogram_init(&bucket->field);
+
+    size_t hashed = result->bucket_index.count;
+    if (index_time_bucket(result, index) != 0) return NULL;
+
+    result->bucket_inserts++;
+    if (result->bucket_index.count != hashed) result->bucket_hash_inserts++;
+
+    if (index > 0 && result->time_buckets[index - 1].start_unix > bucket_start) {
+        result->time_buckets_sorted = 0;
+    }
+    result->time_bucket_count++;
+
+    return bucket;
 }
 
-/* ---------- Error Aggregation ---------- */
+/*
+ * Adds a log entry to its time bucket.
+ * Returns the bucket, or NULL when not grouping (or on OOM).
+ */
+static TimeBucket *add_time_bucket(
+    AnalysisResult *result,
+    const LogEntry *entry
+) {
+    if (result->config.group_by == GROUP_BY_NONE) return NULL;
+
+    long long bucket_start =
+        bucket_start_unix(entry->timestamp_unix, entry->utc_offset,
+                          bucket_width(result->config.group_by));
+
+    TimeBucket *b = find_or_add_time_bucket(result, bucket_start);
+    if (!b) return NULL;
+
+    b->total++;
+    if (entry->level == LOG_LEVEL_INFO)  b->info++;
+    if (entry->level == LOG_LEVEL_WARN)  b->warn++;
+    if (entry->level == LOG_LEVEL_ERROR) b->error++;
+
+    return b;
+}
+
+static int compare_time_buckets(const void *a, const void *b) {
+    long long x = ((const TimeBucket *)a)->start_unix;
+    long long y = ((const TimeBucket *)b)->start_unix;
+
+    return (x > y) - (x < y);
+}
 
 /*
- * NOTE:
- * Linear scan over unique errors.
- * Acceptable for moderate error cardinality.
- * Can be replaced with a hash table if required.
+ * Sorts buckets chronologically and rebuilds the lookup structures
+ * around the earliest bucket. The sorted copy and its index are built
+ * aside and swapped in only once complete, so on OOM the result keeps
+ * its unsorted buckets and a valid index.
+ * Returns 0 on success, non-zero on OOM.
  */
-static void add_error_message(AnalysisResult *result, const char *message) {
-    for (size_t i = 0; i < result->error_unique; i++) {
-        if (strcmp(result->error_entries[i].message, message) == 0) {
-            result->error_entries[i].count++;
-            return;
+static int sort_time_buckets(AnalysisResult *result) {
+    TimeBucket *buckets = result->time_buckets;
+    size_t *slots = result->bucket_slots;
+    size_t slot_count = result->bucket_slot_count;
+    long long base = result->bucket_base;
+    HashIndex index = result->bucket_index;
+
+    TimeBucket *sorted = malloc(result->time_bucket_capacity *
+                                sizeof(TimeBucket));
+    if (!sorted) return -1;
+    if (hash_index_init(&result->bucket_index,
+                        result->time_bucket_count) != 0) {
+        result->bucket_index = index;
+        free(sorted);
+        return -1;
+    }
+
+    memcpy(sorted, buckets, result->time_bucket_count * sizeof(TimeBucket));
+    qsort(sorted, result->time_bucket_count, sizeof(TimeBucket),
+          compare_time_buckets);
+
+    result->time_buckets = sorted;
+    result->bucket_slots = NULL;
+    result->bucket_slot_count = 0;
+    result->bucket_index.lookups = index.lookups;
+    result->bucket_index.probes = index.probes;
+
+    for (size_t i = 0; i < result->time_bucket_count; i++) {
+        if (index_time_bucket(result, i) != 0) {
+            /* Put the unsorted buckets and their index back */
+            free(result->bucket_slots);
+            hash_index_free(&result->bucket_index);
+            free(sorted);
+
+            result->time_buckets = buckets;
+            result->bucket_slots = slots;
+            result->bucket_slot_count = slot_count;
+            result->bucket_base = base;
+            result->bucket_index = index;
+            return -1;
         }
     }
 
+    free(buckets);
+    free(slots);
+    hash_index_free(&index);
+
+    result->time_buckets_sorted = 1;
+    return 0;
+}
+
+/* ---------- Error Aggregation ---------- */
+
+typedef struct {
+    const AnalysisResult *result;
+    const char *message;
+    size_t len;
+} ErrorKey;
+
+static int error_matches(const void *ctx, size_t index) {
+    const ErrorKey *key = ctx;
+    const ErrorEntry *entry = &key->result->error_entries[index];
+
+    return entry->message_len == key->len &&
+           memcmp(error_entry_message(key->result, entry),
+                  key->message, key->len) == 0;
+}
+
+/*
+ * Finds the entry for message, creating it with a zero count if needed.
+ * Lookup goes through the open-addressing hash index, so it is
+ * amortized O(1) regardless of error cardinality. New messages are
+ * interned into the string arena, along with `example` if non-NULL.
+ * Returns NULL on OOM.
+ */
+static ErrorEntry *find_or_add_error(
+    AnalysisResult *result,
+    const char *message,
+    size_t len,
+    const char *example,
+    size_t example_len
+) {
+    uint64_t hash = hash_bytes(message, len);
+    ErrorKey key = { result, message, len };
+
+    HashSlot *slot =
+        hash_index_lookup(&result->error_index, hash, error_matches, &key);
+    if (slot->index != 0) {
+        return &result->error_entries[slot->index - 1];
+    }
+
     if (result->error_unique >= result->error_capacity) {
         size_t new_capacity = result->error_capacity * 2;
         ErrorEntry *new_entries =
             realloc(result->error_entries, new_capacity * sizeof(ErrorEntry));
 
-        if (!new_entries) return;
+        if (!new_entries) return NULL;
 
         result->error_entries = new_entries;
         result->error_capacity = new_capacity;
     }
 
-    snprintf(
-        result->error_entries[result->error_unique].message,
-        MAX_MESSAGE_LEN,
-        "%s",
-        message
-    );
+    /* Failures below must not leave unreferenced bytes in the arena. */
+    size_t mark = result->error_messages.size;
 
-    result->error_entries[result->error_unique].count = 1;
+    size_t offset = arena_append(&result->error_messages, message, len);
+    if (offset == ARENA_NPOS) return NULL;
+
+    size_t example_offset = offset;
+    if (example) {
+        example_offset =
+            arena_append(&result->error_messages, example, example_len);
+        if (example_offset == ARENA_NPOS) {
+            arena_truncate(&result->error_messages, mark);
+            return NULL;
+        }
+    } else {
+        example_len = len;
+    }
+
+    size_t index = result->error_unique;
+    if (hash_index_insert(&result->error_index, slot, hash, index) != 0) {
+        arena_truncate(&result->error_messages, mark);
+        return NULL;
+    }
+
+    ErrorEntry *entry = &result->error_entries[index];
+    entry->message_offset = offset;
+    entry->message_len = len;
+    entry->example_offset = example_offset;
+    entry->example_len = example_len;
+    entry->count = 0;
     result->error_unique++;
+
+    return entry;
+}
+
+/* ---------- Message Keys ---------- */
+
+/*
+ * Masks a message into result->template_buf and returns it.
+ * Returns NULL on OOM.
+ */
+static const char *message_template(
+    AnalysisResult *result,
+    const char *message,
+    size_t len,
+    size_t *template_len
+) {
+    size_t needed = TEMPLATE_MAX_LEN(len);
+    if (needed > result->template_capacity) {
+        char *buf = realloc(result->template_buf, needed);
+        if (!buf) return NULL;
+
+        result->template_buf = buf;
+        result->template_capacity = needed;
+    }
+
+    *template_len = mask_message(message, len, result->template_buf);
+    return result->template_buf;
+}
+
+/*
+ * Returns the aggregation key for a message: its masked template with
+ * --templates (in result->template_buf), otherwise the message itself.
+ * Returns NULL on OOM.
+ */
+static const char *message_key(
+    AnalysisResult *result,
+    const char *message,
+    size_t len,
+    size_t *key_len
+) {
+    if (result->config.templates) {
+        return message_template(result, message, len, key_len);
+    }
+
+    *key_len = len;
+    return message;
+}
+
+/*
+ * Counts one error, under its template if the result groups errors by
+ * template, and approximately if it has a Space-Saving summary.
+ */
+static void add_error_message(
+    AnalysisResult *result,
+    const char *key,
+    size_t key_len,
+    const LogEntry *entry
+) {
+    const char *example = NULL;
+    size_t example_len = 0;
+
+    if (result->config.templates) {
+        example = entry->message;
+        example_len = entry->message_len;
+    }
+
+    if (result->config.approx_top) {
+        heavy_add(&result->heavy, key, key_len, example, example_len, 1, 0);
+        return;
+    }
+
+    ErrorEntry *e =
+        find_or_add_error(result, key, key_len, example, example_len);
+    if (e) e->count++;
+}
+
+/* ---------- Field Values ---------- */
+
+static int field_matches(const void *ctx, size_t index) {
+    const ErrorKey *key = ctx;
+    const FieldEntry *entry = &key->result->field_entries[index];
+
+    return entry->template_len == key->len &&
+           memcmp(field_entry_template(key->result, entry),
+                  key->message, key->len) == 0;
+}
+
+/*
+ * Finds the field entry for a template, creating an empty one if
+ * needed. Templates are interned into the string arena.
+ * Returns NULL on OOM.
+ */
+static FieldEntry *find_or_add_field(
+    AnalysisResult *result,
+    const char *tmpl,
+    size_t len
+) {
+    uint64_t hash = hash_bytes(tmpl, len);
+    ErrorKey key = { result, tmpl, len };
+
+    HashSlot *slot =
+        hash_index_lookup(&result->field_index, hash, field_matches, &key);
+    if (slot->index != 0) {
+        return &result->field_entries[slot->index - 1];
+    }
+
+    if (result->field_unique >= result->field_capacity) {
+        size_t new_capacity =
+            result->field_capacity ? result->field_capacity * 2 : 16;
+        FieldEntry *new_entries =
+            realloc(result->field_entries, new_capacity * sizeof(FieldEntry));
+
+        if (!new_entries) return NULL;
+
+        result->field_entries = new_entries;
+        result->field_capacity = new_capacity;
+    }
+
+    size_t mark = result->error_messages.size;
+    size_t offset = arena_append(&result->error_messages, tmpl, len);
+    if (offset == ARENA_NPOS) return NULL;
+
+    size_t index = result->field_unique;
+    if (hash_index_insert(&result->field_index, slot, hash, index) != 0) {
+        arena_truncate(&result->error_messages, mark);
+        return NULL;
+    }
+
+    FieldEntry *entry = &result->field_entries[index];
+    entry->template_offset = offset;
+    entry->template_len = len;
+    histogram_init(&entry->values);
+    result->field_unique++;
+
+    return entry;
+}
+
+/*
+ * Records the value of config.field, overall, in its time bucket and
+ * under the template of its message (`tmpl` if already masked).
+ */
+static void add_field_value(
+    AnalysisResult *result,
+    const LogEntry *entry,
+    TimeBucket *bucket,
+    double value,
+    const char *tmpl,
+    size_t tmpl_len
+) {
+    histogram_add(&result->field_values, value);
+    if (bucket) histogram_add(&bucket->field, value);
+
+    if (!tmpl) {
+        tmpl = message_template(result, entry->message, entry->message_len,
+                                &tmpl_len);
+        if (!tmpl) return;
+    }
+
+    FieldEntry *f = find_or_add_field(result, tmpl, tmpl_len);
+    if (f) histogram_add(&f->values, value);
 }
 
 /* ---------- Public API ---------- */
@@ -169,63 +557,341 @@ void process_log_line(AnalysisResult *result, const LogEntry *entry) {
 
         case LOG_LEVEL_ERROR:
             result->error_total++;
-            add_error_message(result, entry->message);
             break;
 
         default:
             break;
     }
 
-    add_time_bucket(result, entry);
+    const char *key = NULL;
+    size_t key_len = 0;
+    if (entry->level == LOG_LEVEL_ERROR || result->config.distinct) {
+        key = message_key(result, entry->message, entry->message_len,
+                          &key_len);
+    }
+
+    /* Drop the message (not the line) if masking ran out of memory */
+    if (key && entry->level == LOG_LEVEL_ERROR) {
+        add_error_message(result, key, key_len, entry);
+    }
+
+    TimeBucket *bucket = add_time_bucket(result, entry);
+
+    if (key && result->config.distinct &&
+        entry->level >= 0 && entry->level < LOG_LEVEL_COUNT) {
+        uint64_t hash = hash_bytes(key, key_len);
+
+        hll_add(&result->distinct[entry->level], hash);
+        if (bucket) hll_add(&bucket->distinct[entry->level], hash);
+    }
+
+    double value;
+    if (result->config.field &&
+        extract_field(entry->message, entry->message_len, result->config.field,
+                      result->field_len, &value) == 0) {
+        /* With --templates, key already holds this message's template */
+        bool masked = key && result->config.templates;
+        add_field_value(result, entry, bucket, value,
+                        masked ? key : NULL, masked ? key_len : 0);
+    }
+}
+
+void record_rejected_line(AnalysisResult *result, ParseStatus status) {
+    if (!result || status <= PARSE_OK || status >= PARSE_STATUS_COUNT) return;
+
+    result->rejected[status]++;
+}
+
+int finalize_analysis(AnalysisResult *result) {
+    if (!result) return -1;
+
+    if (!result->time_buckets_sorted) return sort_time_buckets(result);
+    return 0;
+}
+
+int add_error_count(
+    AnalysisResult *result,
+    const char *message,
+    size_t len,
+    const char *example,
+    size_t example_len,
+    size_t count
+) {
+    if (!result || !message) return -1;
+
+    ErrorEntry *e = find_or_add_error(result, message, len,
+                                      example, example_len);
+    if (!e) return -1;
+
+    e->count += count;
+    return 0;
+}
+
+int add_time_bucket_counts(AnalysisResult *result, const TimeBucket *bucket) {
+    if (!result || !bucket) return -1;
+
+    TimeBucket *d = find_or_add_time_bucket(result, bucket->start_unix);
+    if (!d) return -1;
+
+    d->total += bucket->total;
+    d->info  += bucket->info;
+    d->warn  += bucket->warn;
+    d->error += bucket->error;
+
+    for (int level = 0; level < LOG_LEVEL_COUNT; level++) {
+        if (!bucket->distinct[level].registers) continue;
+        if (hll_merge(&d->distinct[level], &bucket->distinct[level]) != 0) {
+            return -1;
+        }
+    }
+
+    if (histogram_merge(&d->field, &bucket->field) != 0) return -1;
+    return 0;
+}
+
+/*
+ * Merges src into dst. New error messages are appended in src order,
+ * so merging per-chunk results in input order yields the same error
+ * table as a single sequential pass. Time buckets may end up out of
+ * order; finalize_analysis() sorts them.
+ */
+int merge_analysis(AnalysisResult *dst, const AnalysisResult *src) {
+    if (!dst || !src) return -1;
+    if (dst->config.group_by != src->config.group_by ||
+        dst->config.templates != src->config.templates ||
+        dst->config.approx_top != src->config.approx_top ||
+        dst->config.distinct != src->config.distinct ||
+        !dst->config.field != !src->config.field ||
+        (dst->config.field &&
+         strcmp(dst->config.field, src->config.field) != 0)) {
+        return -1;
+    }
+
+    dst->total_lines += src->total_lines;
+    dst->info_count  += src->info_count;
+    dst->warn_count  += src->warn_count;
+    dst->error_total += src->error_total;
+
+    for (size_t i = 0; i < PARSE_STATUS_COUNT; i++) {
+        dst->rejected[i] += src->rejected[i];
+    }
+    dst->bucket_inserts      += src->bucket_inserts;
+    dst->bucket_hash_inserts += src->bucket_hash_inserts;
+    dst->error_index.lookups  += src->error_index.lookups;
+    dst->error_index.probes   += src->error_index.probes;
+    dst->bucket_index.lookups += src->bucket_index.lookups;
+    dst->bucket_index.probes  += src->bucket_index.probes;
+    dst->field_index.lookups  += src->field_index.lookups;
+    dst->field_index.probes   += src->field_index.probes;
+    dst->heavy.index.lookups  += src->heavy.index.lookups;
+    dst->heavy.index.probes   += src->heavy.index.probes;
+
+    for (int level = 0; level < LOG_LEVEL_COUNT; level++) {
+        if (hll_merge(&dst->distinct[level], &src->distinct[level]) != 0) {
+            return -1;
+        }
+    }
+
+    if (src->config.approx_top &&
+        heavy_merge(&dst->heavy, &src->heavy) != 0) {
+        return -1;
+    }
+
+    for (size_t i = 0; i < src->error_unique; i++) {
+        const ErrorEntry *e = &src->error_entries[i];
+        const char *example = src->config.templates
+                                  ? error_entry_example(src, e)
+                                  : NULL;
+
+        if (add_error_count(dst, error_entry_message(src, e), e->message_len,
+                            example, e->example_len, e->count) != 0) {
+            return -1;
+        }
+    }
+
+    if (histogram_merge(&dst->field_values, &src->field_values) != 0) {
+        return -1;
+    }
+
+    for (size_t i = 0; i < src->field_unique; i++) {
+        const FieldEntry *f = &src->field_entries[i];
+        FieldEntry *d = find_or_add_field(dst, field_entry_template(src, f),
+                                          f->template_len);
+
+        if (!d || histogram_merge(&d->values, &f->values) != 0) return -1;
+    }
+
+    for (size_t i = 0; i < src->time_bucket_count; i++) {
+        if (add_time_bucket_counts(dst, &src->time_buckets[i]) != 0) {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+/* ---------- Top-K Selection ---------- */
+
+/*
+ * Field entries: more values first, ties in first-occurrence order.
+ * There are few templates with a numeric field, so out[] is kept
+ * sorted by insertion.
+ */
+size_t get_top_fields(
+    const AnalysisResult *result,
+    size_t top_n,
+    const FieldEntry **out
+) {
+    if (!result || !out || top_n == 0) return 0;
+
+    size_t size = 0;
+
+    for (size_t i = 0; i < result->field_unique; i++) {
+        const FieldEntry *entry = &result->field_entries[i];
+        size_t pos = size;
+
+        while (pos > 0 && out[pos - 1]->values.total < entry->values.total) {
+            pos--;
+        }
+        if (pos >= top_n) continue;
+
+        size_t end = size < top_n ? size : top_n - 1;
+        memmove(out + pos + 1, out + pos, (end - pos) * sizeof(*out));
+        out[pos] = entry;
+        if (size < top_n) size++;
+    }
+
+    return size;
+}
+
+/*
+ * Ranking used for top errors: higher count first, ties broken by
+ * first occurrence (entries are stored in first-seen order).
+ */
+static int ranks_before(const ErrorEntry *a, const ErrorEntry *b) {
+    return a->count > b->count || (a->count == b->count && a < b);
+}
+
+/*
+ * Restores the heap property below `i` in a heap whose root is the
+ * lowest-ranked entry.
+ */
+static void sift_down(const ErrorEntry **heap, size_t size, size_t i) {
+    for (;;) {
+        size_t lowest = i;
+        size_t left = 2 * i + 1;
+        size_t right = left + 1;
+
+        if (left < size && ranks_before(heap[lowest], heap[left])) {
+            lowest = left;
+        }
+        if (right < size && ranks_before(heap[lowest], heap[right])) {
+            lowest = right;
+        }
+        if (lowest == i) return;
+
+        const ErrorEntry *swap = heap[i];
+        heap[i] = heap[lowest];
+        heap[lowest] = swap;
+        i = lowest;
+    }
+}
+
+static void sift_up(const ErrorEntry **heap, size_t i) {
+    while (i > 0) {
+        size_t parent = (i - 1) / 2;
+        if (!ranks_before(heap[parent], heap[i])) return;
+
+        const ErrorEntry *swap = heap[i];
+        heap[i] = heap[parent];
+        heap[parent] = swap;
+        i = parent;
+    }
 }
 
 /*
  * Returns number of entries written to `out`.
- * Selection sort is used since top_n is small (default <= 10).
+ * A bounded min-heap of entry pointers keeps the best top_n seen so
+ * far, so selection is O(n log k) and never copies message payloads.
  */
 size_t get_top_errors(
     const AnalysisResult *result,
     size_t top_n,
-    ErrorEntry *out
+    const ErrorEntry **out
 ) {
-    if (!result || !out) return 0;
-
-    size_t n = (result->error_unique < top_n)
-                   ? result->error_unique
-                   : top_n;
-
-    ErrorEntry *temp =
-        malloc(result->error_unique * sizeof(ErrorEntry));
-    if (!temp) return 0;
-
-    memcpy(
-        temp,
-        result->error_entries,
-        result->error_unique * sizeof(ErrorEntry)
-    );
-
-    for (size_t i = 0; i < n; i++) {
-        size_t max_idx = i;
-        for (size_t j = i + 1; j < result->error_unique; j++) {
-            if (temp[j].count > temp[max_idx].count) {
-                max_idx = j;
-            }
+    if (!result || !out || top_n == 0) return 0;
+
+    size_t size = 0;
+
+    for (size_t i = 0; i < result->error_unique; i++) {
+        const ErrorEntry *entry = &result->error_entries[i];
+
+        if (size < top_n) {
+            out[size] = entry;
+            sift_up(out, size++);
+        } else if (ranks_before(entry, out[0])) {
+            out[0] = entry;
+            sift_down(out, size, 0);
         }
-        ErrorEntry swap = temp[i];
-        temp[i] = temp[max_idx];
-        temp[max_idx] = swap;
     }
 
-    memcpy(out, temp, n * sizeof(ErrorEntry));
-    free(temp);
+    /* Pop the lowest-ranked entry into the tail until sorted */
+    for (size_t n = size; n > 1; n--) {
+        const ErrorEntry *lowest = out[0];
+        out[0] = out[n - 1];
+        out[n - 1] = lowest;
+        sift_down(out, n - 1, 0);
+    }
+
+    return size;
+}
+
+const char *error_entry_message(
+    const AnalysisResult *result,
+    const ErrorEntry *entry
+) {
+    return arena_get(&result->error_messages, entry->message_offset);
+}
 
-    return n;
+const char *field_entry_template(
+    const AnalysisResult *result,
+    const FieldEntry *entry
+) {
+    return arena_get(&result->error_messages, entry->template_offset);
+}
+
+const char *error_entry_example(
+    const AnalysisResult *result,
+    const ErrorEntry *entry
+) {
+    return arena_get(&result->error_messages, entry->example_offset);
 }
 
 void cleanup_analyzer(AnalysisResult *result) {
     if (!result) return;
 
     free(result->error_entries);
+    hash_index_free(&result->error_index);
+    arena_free(&result->error_messages);
+    free(result->template_buf);
+    heavy_free(&result->heavy);
+    for (int level = 0; level < LOG_LEVEL_COUNT; level++) {
+        hll_free(&result->distinct[level]);
+    }
+    histogram_free(&result->field_values);
+    for (size_t i = 0; i < result->field_unique; i++) {
+        histogram_free(&result->field_entries[i].values);
+    }
+    free(result->field_entries);
+    hash_index_free(&result->field_index);
+    for (size_t i = 0; i < result->time_bucket_count; i++) {
+        for (int level = 0; level < LOG_LEVEL_COUNT; level++) {
+            hll_free(&result->time_buckets[i].distinct[level]);
+        }
+        histogram_free(&result->time_buckets[i].field);
+    }
     free(result->time_buckets);
+    free(result->bucket_slots);
+    hash_index_free(&result->bucket_index);
     free(result);
 }
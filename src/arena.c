@@ -0,0 +1,56 @@
+#include "arena.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+int arena_init(StringArena *arena, size_t capacity) {
+    if (!arena) return -1;
+
+    if (capacity == 0) capacity = 4096;
+
+    arena->data = malloc(capacity);
+    if (!arena->data) return -1;
+
+    arena->size = 0;
+    arena->capacity = capacity;
+    return 0;
+}
+
+size_t arena_append(StringArena *arena, const char *s, size_t len) {
+    size_t needed = arena->size + len + 1;
+
+    if (needed > arena->capacity) {
+        size_t new_capacity = arena->capacity * 2;
+        while (new_capacity < needed) new_capacity *= 2;
+
+        char *new_data = realloc(arena->data, new_capacity);
+        if (!new_data) return ARENA_NPOS;
+
+        arena->data = new_data;
+        arena->capacity = new_capacity;
+    }
+
+    size_t offset = arena->size;
+    memcpy(arena->data + offset, s, len);
+    arena->data[offset + len] = '\0';
+    arena->size = needed;
+
+    return offset;
+}
+
+const char *arena_get(const StringArena *arena, size_t offset) {
+    return arena->data + offset;
+}
+
+void arena_truncate(StringArena *arena, size_t mark) {
+    if (mark < arena->size) arena->size = mark;
+}
+
+void arena_free(StringArena *arena) {
+    if (!arena) return;
+
+    free(arena->data);
+    arena->data = NULL;
+    arena->size = 0;
+    arena->capacity = 0;
+}
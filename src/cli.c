@@ -7,24 +7,83 @@
 
 #define VERSION "1.0.0"
 #define DEFAULT_TOP_N 10
+#define DEFAULT_INTERVAL 5
 
 /* ---------- Helpers ---------- */
 
 static void print_usage(const char *program_name) {
-    printf("Usage: %s <log_file> [options]\n", program_name);
+    printf("Usage: %s <log_file|dir|glob>... [options]\n", program_name);
     printf("\nOptions:\n");
     printf("  --errors-only             Show only error-related statistics\n");
     printf("  --top-errors N            Show top N most frequent errors (default: %d)\n",
            DEFAULT_TOP_N);
     printf("  --output text|json|csv    Output format (default: text)\n");
+    printf("  --output-file FILE        Write the report to FILE instead of stdout\n");
     printf("  --group-by minute|hour    Aggregate counts by time bucket\n");
+    printf("  --templates               Group errors by message template, masking\n");
+    printf("                            numbers, hex, UUIDs, IPs and quoted strings\n");
+    printf("  --approx-top K            Count errors approximately in K counters\n");
+    printf("                            (fixed memory, reports error bounds)\n");
+    printf("  --distinct                Estimate distinct messages per level\n");
+    printf("                            (and per time bucket) with HyperLogLog\n");
+    printf("  --field NAME              Report p50/p90/p99/max of the number after\n");
+    printf("                            NAME (\"NAME=12\", \"NAME 3ms\") overall, per\n");
+    printf("                            time bucket and per message template\n");
+    printf("  --threads N               Worker threads (default: 1 for one file,\n");
+    printf("                            one per core for several files)\n");
+    printf("  --pipeline                Read a single file on its own I/O thread\n");
+    printf("                            while --threads workers parse (for slow\n");
+    printf("                            or network storage; default for pipes and\n");
+    printf("                            compressed input with --threads > 1)\n");
+    printf("  --per-file                Also report counts for each input file\n");
+    printf("  --follow                  Keep reading as the file grows (tail -F)\n");
+    printf("  --interval N              Seconds between --follow reports (default: %d)\n",
+           DEFAULT_INTERVAL);
+    printf("  --state FILE              Resume from / save a snapshot for an\n");
+    printf("                            append-only log file\n");
+    printf("  --convert FILE            Write the parsed lines to FILE in a\n");
+    printf("                            columnar format instead of reporting;\n");
+    printf("                            FILE can then be queried like a log\n");
+    printf("  --serve SOCKET            Keep results in memory, follow the files\n");
+    printf("                            and answer JSON queries (summary, top N,\n");
+    printf("                            buckets N, report) and take log lines\n");
+    printf("                            from clients on a Unix socket\n");
+    printf("  --since TIME              Only lines at or after TIME\n");
+    printf("  --until TIME              Only lines before TIME\n");
+    printf("                            (TIME: YYYY-MM-DD[ HH:MM[:SS]], local)\n");
+    printf("  --grep TEXT               Only lines containing TEXT (repeatable;\n");
+    printf("                            a line matching any pattern is kept)\n");
+    printf("  --grep-file FILE          Read --grep patterns from FILE, one per line\n");
+    printf("  --stats                   Print stage timings and work counters\n");
+    printf("                            to stderr\n");
     printf("  --help                    Show this help message\n");
     printf("  --version                 Show version information\n");
 
     printf("\nExamples:\n");
     printf("  %s server.log\n", program_name);
     printf("  %s server.log --errors-only --top-errors 5\n", program_name);
+    printf("  %s server.log --templates --top-errors 20\n", program_name);
+    printf("  %s huge.log --approx-top 1000 --top-errors 20\n", program_name);
+    printf("  %s server.log --distinct --templates --group-by hour\n",
+           program_name);
+    printf("  %s server.log --field took --group-by minute\n", program_name);
     printf("  %s server.log --group-by hour --output json\n", program_name);
+    printf("  %s server.log --group-by minute --output csv --output-file buckets.csv\n",
+           program_name);
+    printf("  %s server.log --threads 8\n", program_name);
+    printf("  %s /mnt/nfs/server.log --pipeline --threads 4\n", program_name);
+    printf("  %s /var/log/app/ 'archive/*.log' --per-file\n", program_name);
+    printf("  %s server.log --follow --interval 10\n", program_name);
+    printf("  %s server.log --state server.state\n", program_name);
+    printf("  %s 'archive/*.log.gz' --convert archive.cols\n", program_name);
+    printf("  %s archive.cols --group-by hour --errors-only\n", program_name);
+    printf("  %s /var/log/app.log --serve /run/loganalyzer.sock --group-by minute\n",
+           program_name);
+    printf("  %s server.log --since '2024-05-01 10:00' --until '2024-05-01 10:10'\n",
+           program_name);
+    printf("  %s server.log --stats --output json 2> stats.json\n", program_name);
+    printf("  %s server.log --grep tenant-a --grep tenant-b --errors-only\n",
+           program_name);
 }
 
 /*
@@ -45,23 +104,70 @@ static int parse_positive_size(const char *arg, size_t *out) {
     return 1;
 }
 
+/*
+ * Parses "YYYY-MM-DD", "YYYY-MM-DD HH:MM" or "YYYY-MM-DD HH:MM:SS"
+ * (a 'T' separator is accepted too) as local time.
+ * Returns 1 on success, 0 on failure.
+ */
+static int parse_time_arg(const char *arg, long long *out) {
+    char timestamp[TIMESTAMP_LEN + 1] = "0000-00-00 00:00:00";
+    size_t len = strlen(arg);
+
+    if (len != 10 && len != 16 && len != TIMESTAMP_LEN) return 0;
+
+    memcpy(timestamp, arg, len);
+    if (timestamp[10] == 'T') timestamp[10] = ' ';
+
+    LogParser parser;
+    log_parser_init(&parser, NULL);
+
+    return parse_timestamp(&parser, timestamp, out) == 0;
+}
+
 /* ---------- Public API ---------- */
 
 CliResult parse_cli(int argc, char **argv, CliOptions *out) {
     if (!out) return CLI_ERROR;
 
     /* Defaults */
-    out->filename      = NULL;
+    out->inputs        = NULL;
+    out->input_count   = 0;
     out->errors_only   = false;
     out->top_n         = DEFAULT_TOP_N;
     out->output_format = OUTPUT_TEXT;
+    out->output_path   = NULL;
     out->group_by      = GROUP_BY_NONE;
+    out->templates     = false;
+    out->approx_top    = 0;
+    out->distinct      = false;
+    out->field         = NULL;
+    out->threads       = 0;
+    out->pipeline      = false;
+    out->per_file      = false;
+    out->follow        = false;
+    out->interval      = DEFAULT_INTERVAL;
+    out->state_path    = NULL;
+    out->convert_path  = NULL;
+    out->serve_path    = NULL;
+    out->stats         = false;
+    line_filter_init(&out->filter);
+
+    if (grep_set_init(&out->grep) != 0) {
+        fprintf(stderr, "Error: Memory allocation failed\n");
+        return CLI_ERROR;
+    }
 
     if (argc < 2) {
         print_usage(argv[0]);
         return CLI_ERROR;
     }
 
+    out->inputs = malloc((size_t)argc * sizeof(*out->inputs));
+    if (!out->inputs) {
+        fprintf(stderr, "Error: Memory allocation failed\n");
+        return CLI_ERROR;
+    }
+
     for (int i = 1; i < argc; i++) {
 
         if (strcmp(argv[i], "--help") == 0) {
@@ -116,6 +222,20 @@ CliResult parse_cli(int argc, char **argv, CliOptions *out) {
             }
         }
 
+        else if (strcmp(argv[i], "--output-file") == 0) {
+            if (i + 1 >= argc) {
+                fprintf(stderr, "Error: Missing value for --output-file\n");
+                return CLI_ERROR;
+            }
+
+            out->output_path = argv[++i];
+            if (out->output_path[0] == '\0') {
+                fprintf(stderr,
+                        "Error: Invalid value for --output-file: ''\n");
+                return CLI_ERROR;
+            }
+        }
+
         else if (strcmp(argv[i], "--group-by") == 0) {
             if (i + 1 >= argc) {
                 fprintf(stderr, "Error: Missing value for --group-by\n");
@@ -135,28 +255,281 @@ CliResult parse_cli(int argc, char **argv, CliOptions *out) {
             }
         }
 
+        else if (strcmp(argv[i], "--threads") == 0) {
+            if (i + 1 >= argc) {
+                fprintf(stderr, "Error: Missing value for --threads\n");
+                return CLI_ERROR;
+            }
+
+            size_t value;
+            if (!parse_positive_size(argv[++i], &value)) {
+                fprintf(stderr,
+                        "Error: Invalid value for --threads: '%s'\n",
+                        argv[i]);
+                return CLI_ERROR;
+            }
+
+            out->threads = value;
+        }
+
+        else if (strcmp(argv[i], "--pipeline") == 0) {
+            out->pipeline = true;
+        }
+
+        else if (strcmp(argv[i], "--templates") == 0) {
+            out->templates = true;
+        }
+
+        else if (strcmp(argv[i], "--approx-top") == 0) {
+            if (i + 1 >= argc) {
+                fprintf(stderr, "Error: Missing value for --approx-top\n");
+                return CLI_ERROR;
+            }
+
+            size_t value;
+            if (!parse_positive_size(argv[++i], &value)) {
+                fprintf(stderr,
+                        "Error: Invalid value for --approx-top: '%s'\n",
+                        argv[i]);
+                return CLI_ERROR;
+            }
+
+            out->approx_top = value;
+        }
+
+        else if (strcmp(argv[i], "--distinct") == 0) {
+            out->distinct = true;
+        }
+
+        else if (strcmp(argv[i], "--field") == 0) {
+            if (i + 1 >= argc) {
+                fprintf(stderr, "Error: Missing value for --field\n");
+                return CLI_ERROR;
+            }
+
+            out->field = argv[++i];
+            if (out->field[0] == '\0') {
+                fprintf(stderr, "Error: Invalid value for --field: ''\n");
+                return CLI_ERROR;
+            }
+        }
+        else if (strcmp(argv[i], "--per-file") == 0) {
+            out->per_file = true;
+        }
+
+        else if (strcmp(argv[i], "--follow") == 0) {
+            out->follow = true;
+        }
+        else if (strcmp(argv[i], "--stats") == 0) {
+            out->stats = true;
+        }
+
+        else if (strcmp(argv[i], "--interval") == 0) {
+            if (i + 1 >= argc) {
+                fprintf(stderr, "Error: Missing value for --interval\n");
+                return CLI_ERROR;
+            }
+
+            size_t value;
+            if (!parse_positive_size(argv[++i], &value) || value > 86400) {
+                fprintf(stderr,
+                        "Error: Invalid value for --interval: '%s'\n",
+                        argv[i]);
+                return CLI_ERROR;
+            }
+
+            out->interval = (unsigned)value;
+        }
+
+        else if (strcmp(argv[i], "--state") == 0) {
+            if (i + 1 >= argc) {
+                fprintf(stderr, "Error: Missing value for --state\n");
+                return CLI_ERROR;
+            }
+
+            out->state_path = argv[++i];
+        }
+
+        else if (strcmp(argv[i], "--convert") == 0) {
+            if (i + 1 >= argc) {
+                fprintf(stderr, "Error: Missing value for --convert\n");
+                return CLI_ERROR;
+            }
+
+            out->convert_path = argv[++i];
+            if (out->convert_path[0] == '\0') {
+                fprintf(stderr, "Error: Invalid value for --convert: ''\n");
+                return CLI_ERROR;
+            }
+        }
+
+        else if (strcmp(argv[i], "--serve") == 0) {
+            if (i + 1 >= argc) {
+                fprintf(stderr, "Error: Missing value for --serve\n");
+                return CLI_ERROR;
+            }
+
+            out->serve_path = argv[++i];
+            if (out->serve_path[0] == '\0') {
+                fprintf(stderr, "Error: Invalid value for --serve: ''\n");
+                return CLI_ERROR;
+            }
+        }
+
+        else if (strcmp(argv[i], "--since") == 0 ||
+                 strcmp(argv[i], "--until") == 0) {
+            const char *name = argv[i];
+
+            if (i + 1 >= argc) {
+                fprintf(stderr, "Error: Missing value for %s\n", name);
+                return CLI_ERROR;
+            }
+
+            long long value;
+            if (!parse_time_arg(argv[++i], &value)) {
+                fprintf(stderr, "Error: Invalid value for %s: '%s'\n",
+                        name, argv[i]);
+                return CLI_ERROR;
+            }
+
+            if (name[2] == 's') {
+                out->filter.since = value;
+            } else {
+                out->filter.until = value;
+            }
+        }
+
+        else if (strcmp(argv[i], "--grep") == 0) {
+            if (i + 1 >= argc) {
+                fprintf(stderr, "Error: Missing value for --grep\n");
+                return CLI_ERROR;
+            }
+
+            const char *pattern = argv[++i];
+            if (pattern[0] == '\0') {
+                fprintf(stderr, "Error: Invalid value for --grep: ''\n");
+                return CLI_ERROR;
+            }
+
+            if (grep_set_add(&out->grep, pattern, strlen(pattern)) != 0) {
+                fprintf(stderr, "Error: Memory allocation failed\n");
+                return CLI_ERROR;
+            }
+        }
+
+        else if (strcmp(argv[i], "--grep-file") == 0) {
+            if (i + 1 >= argc) {
+                fprintf(stderr, "Error: Missing value for --grep-file\n");
+                return CLI_ERROR;
+            }
+
+            const char *path = argv[++i];
+            size_t before = out->grep.count;
+
+            if (grep_set_add_file(&out->grep, path) != 0) {
+                fprintf(stderr, "Error: Cannot read patterns from '%s'\n",
+                        path);
+                return CLI_ERROR;
+            }
+            if (out->grep.count == before) {
+                fprintf(stderr, "Error: No patterns in '%s'\n", path);
+                return CLI_ERROR;
+            }
+        }
+
         else if (argv[i][0] == '-') {
             fprintf(stderr, "Error: Unknown option '%s'\n", argv[i]);
             return CLI_ERROR;
         }
 
         else {
-            /* Positional argument: log file */
-            if (out->filename != NULL) {
-                fprintf(stderr,
-                        "Error: Multiple log files specified ('%s', '%s')\n",
-                        out->filename, argv[i]);
-                return CLI_ERROR;
-            }
-            out->filename = argv[i];
+            /* Positional argument: log file, directory or glob */
+            out->inputs[out->input_count++] = argv[i];
         }
     }
 
-    if (!out->filename) {
+    /* --serve can start empty and take every line from clients */
+    if (out->input_count == 0 && !out->serve_path) {
         fprintf(stderr, "Error: No log file specified\n");
         print_usage(argv[0]);
         return CLI_ERROR;
     }
 
+    if (out->follow && out->input_count > 1) {
+        fprintf(stderr, "Error: --follow accepts a single log file\n");
+        return CLI_ERROR;
+    }
+
+    if (out->state_path &&
+        (out->input_count > 1 || out->per_file || out->follow)) {
+        fprintf(stderr, "Error: --state accepts a single log file and "
+                        "cannot be combined with --per-file or --follow\n");
+        return CLI_ERROR;
+    }
+
+    if (out->state_path &&
+        (line_filter_has_range(&out->filter) || out->grep.count > 0)) {
+        fprintf(stderr, "Error: --state cannot be combined with "
+                        "--since, --until or --grep\n");
+        return CLI_ERROR;
+    }
+
+    if (out->state_path &&
+        (out->templates || out->approx_top || out->distinct || out->field)) {
+        fprintf(stderr, "Error: --state cannot be combined with --templates, "
+                        "--approx-top, --distinct or --field\n");
+        return CLI_ERROR;
+    }
+
+    if (out->pipeline && (out->follow || out->state_path)) {
+        fprintf(stderr, "Error: --pipeline cannot be combined with "
+                        "--follow or --state\n");
+        return CLI_ERROR;
+    }
+
+    if (out->convert_path &&
+        (out->follow || out->state_path || out->per_file || out->stats)) {
+        fprintf(stderr, "Error: --convert cannot be combined with "
+                        "--follow, --state, --per-file or --stats\n");
+        return CLI_ERROR;
+    }
+
+    if (out->serve_path &&
+        (out->follow || out->state_path || out->convert_path ||
+         out->per_file || out->pipeline || out->stats)) {
+        fprintf(stderr, "Error: --serve cannot be combined with --follow, "
+                        "--state, --convert, --per-file, --pipeline or "
+                        "--stats\n");
+        return CLI_ERROR;
+    }
+
+    if (out->stats && out->follow) {
+        fprintf(stderr, "Error: --stats cannot be combined with --follow\n");
+        return CLI_ERROR;
+    }
+
+    if (out->filter.since >= out->filter.until) {
+        fprintf(stderr, "Error: --since must be earlier than --until\n");
+        return CLI_ERROR;
+    }
+
+    if (out->grep.count > 0) {
+        if (grep_set_compile(&out->grep) != 0) {
+            fprintf(stderr, "Error: Memory allocation failed\n");
+            return CLI_ERROR;
+        }
+        out->filter.grep = &out->grep;
+    }
+
     return CLI_OK;
 }
+
+void cli_free(CliOptions *options) {
+    if (!options) return;
+
+    free(options->inputs);
+    options->inputs = NULL;
+    options->input_count = 0;
+    grep_set_free(&options->grep);
+    options->filter.grep = NULL;
+}
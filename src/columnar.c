@@ -0,0 +1,1009 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "columnar.h"
+#include "template.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * File layout (header integers little-endian 64-bit):
+ *
+ *   magic "LOGCOLMN", version, rows, string_count, id_width
+ *   rejected line counts for ParseStatus 1 .. PARSE_STATUS_COUNT - 1
+ *   per column (COLUMN_COUNT of them): offset, length
+ *   column data, each column starting at a multiple of 8
+ *
+ * Columns:
+ *   timestamps      one zigzag LEB128 varint per row: the Unix time
+ *                   minus the previous row's (the first minus 0)
+ *   offsets         (row, UTC offset) pairs of 64-bit integers, one
+ *                   for the first row and one wherever the offset changes
+ *   levels          LogLevel of row r in bits 2*(r%4) of byte r/4
+ *   ids             string table index per row, id_width bytes each
+ *   string offsets  string_count + 1 64-bit offsets into `strings`
+ *   strings         message bytes back to back, without separators
+ *   blocks          per BLOCK_ROWS rows, four 64-bit integers: offset
+ *                   of the block's first varint, the time of the row
+ *                   before it (0 for the first), and the minimum and
+ *                   maximum time in the block
+ *
+ * There is no checksum: a query reads only some columns, so instead
+ * every offset, length, varint and id is bounds-checked as it is used.
+ */
+#define COLUMNAR_MAGIC   "LOGCOLMN"
+#define COLUMNAR_VERSION 1
+
+enum {
+    COLUMN_TIMESTAMPS,
+    COLUMN_OFFSETS,
+    COLUMN_LEVELS,
+    COLUMN_IDS,
+    COLUMN_STRING_OFFSETS,
+    COLUMN_STRINGS,
+    COLUMN_BLOCKS,
+    COLUMN_COUNT
+};
+
+#define HEADER_WORDS (4 + (PARSE_STATUS_COUNT - 1) + 2 * COLUMN_COUNT)
+#define HEADER_SIZE  (8 + 8 * HEADER_WORDS)
+
+/* Rows per entry of the block index */
+#define BLOCK_ROWS 65536
+
+/* Values encoded per fwrite() of the integer columns */
+#define ID_CHUNK 4096
+
+/* A mapped columnar file, validated by open_columns() */
+typedef struct {
+    const unsigned char *timestamps;
+    size_t timestamps_len;
+    const unsigned char *offsets;
+    size_t offset_run_count;
+    const unsigned char *levels;
+    const unsigned char *ids;
+    unsigned id_width;
+    const unsigned char *string_offsets;
+    const char *strings;
+    size_t strings_len;
+    const unsigned char *blocks;
+    size_t block_count;
+    size_t rows;
+    size_t string_count;
+    size_t rejected[PARSE_STATUS_COUNT];
+} ColumnFile;
+
+/* ---------- Helpers ---------- */
+
+static uint64_t load_u64(const unsigned char *p) {
+    uint64_t v = 0;
+    for (int i = 0; i < 8; i++) v |= (uint64_t)p[i] << (8 * i);
+    return v;
+}
+
+static void store_u64(unsigned char *p, uint64_t v) {
+    for (int i = 0; i < 8; i++) p[i] = (unsigned char)(v >> (8 * i));
+}
+
+static unsigned id_width_for(size_t string_count) {
+    if (string_count <= 0x100) return 1;
+    if (string_count <= 0x10000) return 2;
+    return 4;
+}
+
+static uint32_t load_id(const ColumnFile *file, size_t row) {
+    const unsigned char *p = file->ids + row * file->id_width;
+
+    if (file->id_width == 1) return p[0];
+    if (file->id_width == 2) return (uint32_t)p[0] | (uint32_t)p[1] << 8;
+    return (uint32_t)p[0] | (uint32_t)p[1] << 8 |
+           (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+/*
+ * Returns string `id` (id < string_count) and stores its length in
+ * *len, or returns NULL if its offsets are out of bounds.
+ */
+static const char *string_at(const ColumnFile *file, uint32_t id,
+                             size_t *len) {
+    uint64_t start = load_u64(file->string_offsets + 8 * (size_t)id);
+    uint64_t end = load_u64(file->string_offsets + 8 * ((size_t)id + 1));
+
+    if (start > end || end > file->strings_len) return NULL;
+
+    *len = (size_t)(end - start);
+    return file->strings + start;
+}
+
+/* ---------- Writer ---------- */
+
+typedef struct {
+    const ColumnWriter *writer;
+    const char *message;
+    size_t len;
+} StringKey;
+
+static int string_matches(const void *ctx, size_t index) {
+    const StringKey *key = ctx;
+    const ColumnWriter *w = key->writer;
+
+    return w->string_lengths[index] == key->len &&
+           memcmp(arena_get(&w->text, w->string_offsets[index]),
+                  key->message, key->len) == 0;
+}
+
+/*
+ * Returns the id of `message`, adding it to the string table if new.
+ * Returns UINT32_MAX on OOM or if the table is full.
+ */
+static uint32_t intern_message(
+    ColumnWriter *w,
+    const char *message,
+    size_t len
+) {
+    uint64_t hash = hash_bytes(message, len);
+    StringKey key = { w, message, len };
+
+    HashSlot *slot = hash_index_lookup(&w->index, hash, string_matches, &key);
+    if (slot->index != 0) return (uint32_t)(slot->index - 1);
+
+    if (w->string_count >= UINT32_MAX) return UINT32_MAX;
+
+    if (w->string_count >= w->string_capacity) {
+        size_t new_capacity =
+            w->string_capacity ? w->string_capacity * 2 : 1024;
+
+        size_t *offsets =
+            realloc(w->string_offsets, new_capacity * sizeof(size_t));
+        if (!offsets) return UINT32_MAX;
+        w->string_offsets = offsets;
+
+        size_t *lengths =
+            realloc(w->string_lengths, new_capacity * sizeof(size_t));
+        if (!lengths) return UINT32_MAX;
+        w->string_lengths = lengths;
+
+        w->string_capacity = new_capacity;
+    }
+
+    size_t offset = arena_append(&w->text, message, len);
+    if (offset == ARENA_NPOS) return UINT32_MAX;
+
+    size_t id = w->string_count;
+    if (hash_index_insert(&w->index, slot, hash, id) != 0) {
+        return UINT32_MAX;
+    }
+
+    w->string_offsets[id] = offset;
+    w->string_lengths[id] = len;
+    w->string_count++;
+    return (uint32_t)id;
+}
+
+/*
+ * Appends the zigzag varint of `delta` to the timestamp column.
+ * Returns 0 on success, non-zero on OOM.
+ */
+static int put_delta(ColumnWriter *w, long long delta) {
+    if (w->timestamps_capacity - w->timestamps_len < 10) {
+        size_t new_capacity =
+            w->timestamps_capacity ? w->timestamps_capacity * 2 : 4096;
+        unsigned char *data = realloc(w->timestamps, new_capacity);
+        if (!data) return -1;
+
+        w->timestamps = data;
+        w->timestamps_capacity = new_capacity;
+    }
+
+    uint64_t v = ((uint64_t)delta << 1) ^ (uint64_t)(delta >> 63);
+    unsigned char *p = w->timestamps + w->timestamps_len;
+
+    while (v >= 0x80) {
+        *p++ = (unsigned char)(v | 0x80);
+        v >>= 7;
+    }
+    *p++ = (unsigned char)v;
+
+    w->timestamps_len = (size_t)(p - w->timestamps);
+    return 0;
+}
+
+/*
+ * Records the UTC offset of the next row if it differs from the last.
+ * Returns 0 on success, non-zero on OOM.
+ */
+static int put_offset(ColumnWriter *w, long long utc_offset) {
+    if (w->offset_run_count > 0 &&
+        (long long)w->offset_runs[2 * w->offset_run_count - 1] ==
+            utc_offset) {
+        return 0;
+    }
+
+    if (w->offset_run_count >= w->offset_run_capacity) {
+        size_t new_capacity =
+            w->offset_run_capacity ? w->offset_run_capacity * 2 : 16;
+        uint64_t *runs =
+            realloc(w->offset_runs, 2 * new_capacity * sizeof(uint64_t));
+        if (!runs) return -1;
+
+        w->offset_runs = runs;
+        w->offset_run_capacity = new_capacity;
+    }
+
+    w->offset_runs[2 * w->offset_run_count] = w->rows;
+    w->offset_runs[2 * w->offset_run_count + 1] = (uint64_t)utc_offset;
+    w->offset_run_count++;
+    return 0;
+}
+
+/*
+ * Starts a new block index entry at the next row, whose time is `ts`.
+ * Returns 0 on success, non-zero on OOM.
+ */
+static int start_block(ColumnWriter *w, long long ts) {
+    if (w->block_count >= w->block_capacity) {
+        size_t new_capacity = w->block_capacity ? w->block_capacity * 2 : 16;
+        uint64_t *blocks =
+            realloc(w->blocks, 4 * new_capacity * sizeof(uint64_t));
+        if (!blocks) return -1;
+
+        w->blocks = blocks;
+        w->block_capacity = new_capacity;
+    }
+
+    uint64_t *block = w->blocks + 4 * w->block_count++;
+    block[0] = w->timestamps_len;
+    block[1] = (uint64_t)w->last_unix;
+    block[2] = (uint64_t)ts;
+    block[3] = (uint64_t)ts;
+    return 0;
+}
+
+static int grow_rows(ColumnWriter *w) {
+    size_t new_capacity = w->row_capacity ? w->row_capacity * 2 : 4096;
+
+    uint32_t *ids = realloc(w->ids, new_capacity * sizeof(uint32_t));
+    if (!ids) return -1;
+    w->ids = ids;
+
+    unsigned char *levels = realloc(w->levels, new_capacity / 4);
+    if (!levels) return -1;
+    memset(levels + w->row_capacity / 4, 0,
+           (new_capacity - w->row_capacity) / 4);
+    w->levels = levels;
+
+    w->row_capacity = new_capacity;
+    return 0;
+}
+
+/*
+ * Writes the zeros that pad a column of `len` bytes to a multiple of 8.
+ * Returns 0 on success, non-zero on a write error.
+ */
+static int write_padding(FILE *file, size_t len) {
+    static const char zeros[8] = { 0 };
+    size_t n = (8 - len % 8) % 8;
+
+    return fwrite(zeros, 1, n, file) == n ? 0 : -1;
+}
+
+/*
+ * Writes a column of `len` bytes and its padding.
+ * Returns 0 on success, non-zero on a write error.
+ */
+static int write_column(FILE *file, const void *data, size_t len) {
+    if (len > 0 && fwrite(data, 1, len, file) != len) return -1;
+    return write_padding(file, len);
+}
+
+static size_t padded(size_t len) {
+    return (len + 7) / 8 * 8;
+}
+
+/*
+ * Writes `count` 64-bit integers (a multiple of 8 bytes, so unpadded).
+ * Returns 0 on success, non-zero on a write error.
+ */
+static int write_u64s(FILE *file, const uint64_t *values, size_t count) {
+    unsigned char buf[ID_CHUNK * 8];
+
+    for (size_t i = 0; i < count; i += ID_CHUNK) {
+        size_t n = count - i;
+        if (n > ID_CHUNK) n = ID_CHUNK;
+        for (size_t j = 0; j < n; j++) store_u64(buf + 8 * j, values[i + j]);
+        if (fwrite(buf, 8, n, file) != n) return -1;
+    }
+    return 0;
+}
+
+/*
+ * Writes the header and every column of `w` to `file`.
+ * Returns 0 on success, non-zero on a write error.
+ */
+static int write_columns(const ColumnWriter *w, FILE *file) {
+    unsigned width = id_width_for(w->string_count);
+    size_t text_len = 0;
+    for (size_t i = 0; i < w->string_count; i++) {
+        text_len += w->string_lengths[i];
+    }
+
+    size_t lengths[COLUMN_COUNT];
+    lengths[COLUMN_TIMESTAMPS] = w->timestamps_len;
+    lengths[COLUMN_OFFSETS] = w->offset_run_count * 16;
+    lengths[COLUMN_LEVELS] = (w->rows + 3) / 4;
+    lengths[COLUMN_IDS] = w->rows * width;
+    lengths[COLUMN_STRING_OFFSETS] = (w->string_count + 1) * 8;
+    lengths[COLUMN_STRINGS] = text_len;
+    lengths[COLUMN_BLOCKS] = w->block_count * 32;
+
+    unsigned char header[HEADER_SIZE];
+    unsigned char *p = header;
+
+    memcpy(p, COLUMNAR_MAGIC, 8);
+    p += 8;
+    store_u64(p, COLUMNAR_VERSION); p += 8;
+    store_u64(p, w->rows);          p += 8;
+    store_u64(p, w->string_count);  p += 8;
+    store_u64(p, width);            p += 8;
+    for (int s = 1; s < PARSE_STATUS_COUNT; s++) {
+        store_u64(p, w->rejected[s]);
+        p += 8;
+    }
+
+    size_t offset = HEADER_SIZE;
+    for (int c = 0; c < COLUMN_COUNT; c++) {
+        store_u64(p, offset);       p += 8;
+        store_u64(p, lengths[c]);   p += 8;
+        offset += padded(lengths[c]);
+    }
+
+    if (write_column(file, header, sizeof(header)) != 0 ||
+        write_column(file, w->timestamps, w->timestamps_len) != 0) {
+        return -1;
+    }
+
+    if (write_u64s(file, w->offset_runs, 2 * w->offset_run_count) != 0 ||
+        write_column(file, w->levels, lengths[COLUMN_LEVELS]) != 0) {
+        return -1;
+    }
+
+    unsigned char buf[ID_CHUNK * 8];
+
+    for (size_t i = 0; i < w->rows; i += ID_CHUNK) {
+        size_t n = w->rows - i;
+        if (n > ID_CHUNK) n = ID_CHUNK;
+        for (size_t j = 0; j < n; j++) {
+            for (unsigned b = 0; b < width; b++) {
+                buf[j * width + b] = (unsigned char)(w->ids[i + j] >> (8 * b));
+            }
+        }
+        if (fwrite(buf, width, n, file) != n) return -1;
+    }
+    if (write_padding(file, lengths[COLUMN_IDS]) != 0) return -1;
+
+    uint64_t string_offset = 0;
+    for (size_t i = 0; i <= w->string_count; i += ID_CHUNK) {
+        size_t n = w->string_count + 1 - i;
+        if (n > ID_CHUNK) n = ID_CHUNK;
+        for (size_t j = 0; j < n; j++) {
+            store_u64(buf + 8 * j, string_offset);
+            if (i + j < w->string_count) {
+                string_offset += w->string_lengths[i + j];
+            }
+        }
+        if (fwrite(buf, 8, n, file) != n) return -1;
+    }
+
+    for (size_t i = 0; i < w->string_count; i++) {
+        size_t len = w->string_lengths[i];
+        if (len > 0 &&
+            fwrite(arena_get(&w->text, w->string_offsets[i]), 1, len,
+                   file) != len) {
+            return -1;
+        }
+    }
+    if (write_padding(file, text_len) != 0) return -1;
+
+    return write_u64s(file, w->blocks, 4 * w->block_count);
+}
+
+/* ---------- Reader ---------- */
+
+/*
+ * Checks the header and column bounds of data[0, len) and fills *file.
+ * Column contents are checked as they are read.
+ * Returns 0 on success, non-zero if the file is not a valid columnar
+ * file of this version.
+ */
+static int open_columns(ColumnFile *file, const char *data, size_t len) {
+    const unsigned char *p = (const unsigned char *)data;
+
+    memset(file, 0, sizeof(*file));
+    if (!columnar_detect(data, len) || len < HEADER_SIZE) return -1;
+    if (load_u64(p + 8) != COLUMNAR_VERSION) return -1;
+
+    uint64_t rows = load_u64(p + 16);
+    uint64_t strings = load_u64(p + 24);
+    uint64_t width = load_u64(p + 32);
+    p += 40;
+
+    for (int s = 1; s < PARSE_STATUS_COUNT; s++) {
+        file->rejected[s] = (size_t)load_u64(p);
+        p += 8;
+    }
+
+    const unsigned char *column[COLUMN_COUNT];
+    uint64_t column_len[COLUMN_COUNT];
+    for (int c = 0; c < COLUMN_COUNT; c++) {
+        uint64_t offset = load_u64(p);
+        column_len[c] = load_u64(p + 8);
+        p += 16;
+
+        if (offset > len || column_len[c] > len - offset) return -1;
+        column[c] = (const unsigned char *)data + offset;
+    }
+
+    /* Sizes that follow from the row and string counts */
+    if (width != id_width_for((size_t)strings) ||
+        rows > len || strings > len || strings > UINT32_MAX ||
+        column_len[COLUMN_LEVELS] != (rows + 3) / 4 ||
+        column_len[COLUMN_IDS] != rows * width ||
+        column_len[COLUMN_OFFSETS] % 16 != 0 ||
+        (rows > 0 && column_len[COLUMN_OFFSETS] == 0) ||
+        column_len[COLUMN_STRING_OFFSETS] != (strings + 1) * 8 ||
+        column_len[COLUMN_BLOCKS] !=
+            (rows + BLOCK_ROWS - 1) / BLOCK_ROWS * 32) {
+        return -1;
+    }
+
+    file->timestamps = column[COLUMN_TIMESTAMPS];
+    file->timestamps_len = (size_t)column_len[COLUMN_TIMESTAMPS];
+    file->offsets = column[COLUMN_OFFSETS];
+    file->offset_run_count = (size_t)column_len[COLUMN_OFFSETS] / 16;
+    file->levels = column[COLUMN_LEVELS];
+    file->ids = column[COLUMN_IDS];
+    file->id_width = (unsigned)width;
+    file->string_offsets = column[COLUMN_STRING_OFFSETS];
+    file->strings = (const char *)column[COLUMN_STRINGS];
+    file->strings_len = (size_t)column_len[COLUMN_STRINGS];
+    file->blocks = column[COLUMN_BLOCKS];
+    file->block_count = (size_t)column_len[COLUMN_BLOCKS] / 32;
+    file->rows = (size_t)rows;
+    file->string_count = (size_t)strings;
+
+    /* The first offset run must cover the first row */
+    if (rows > 0 && load_u64(file->offsets) != 0) return -1;
+
+    return 0;
+}
+
+/*
+ * Writes local time `local` (seconds since the epoch, already shifted
+ * by the UTC offset) as "YYYY-MM-DD HH:MM:SS" (TIMESTAMP_LEN bytes).
+ */
+static void format_timestamp(long long local, char *out) {
+    long long days = local / 86400;
+    long long secs = local % 86400;
+    if (secs < 0) {
+        secs += 86400;
+        days--;
+    }
+
+    /* Civil date from a day number (proleptic Gregorian) */
+    long long z = days + 719468;
+    long long era = (z >= 0 ? z : z - 146096) / 146097;
+    long long doe = z - era * 146097;
+    long long yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    long long doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    long long mp = (5 * doy + 2) / 153;
+    long long day = doy - (153 * mp + 2) / 5 + 1;
+    long long month = mp < 10 ? mp + 3 : mp - 9;
+    long long year = yoe + era * 400 + (month <= 2);
+
+    long long fields[6] = {
+        year, month, day, secs / 3600, secs / 60 % 60, secs % 60
+    };
+    static const char separators[] = "-- ::";
+    char *p = out;
+
+    for (int f = 0; f < 6; f++) {
+        int digits = f == 0 ? 4 : 2;
+        long long v = fields[f];
+        for (int d = digits - 1; d >= 0; d--) {
+            p[d] = (char)('0' + v % 10);
+            v /= 10;
+        }
+        p += digits;
+        if (f < 5) *p++ = separators[f];
+    }
+}
+
+static long long bucket_start(long long ts, long long utc_offset,
+                              long long width) {
+    long long rem = (ts + utc_offset) % width;
+    if (rem < 0) rem += width;
+
+    return ts - rem;
+}
+
+/* Query state shared by the row loop and its helpers */
+typedef struct {
+    const ColumnFile *file;
+    const LineFilter *filter;
+    AnalysisResult *result;
+
+    /* --grep: per string 0 = unknown, 1 = matches, 2 = does not */
+    unsigned char *grep_state;
+    int prefix_can_match;  // a pattern may start in "TIMESTAMP LEVEL "
+    size_t pattern_max;
+
+    /* Error count per string, and strings in first-error order */
+    size_t *error_counts;
+    uint32_t *error_order;
+    size_t error_seen;
+
+    /* Counts of the bucket being filled, and the times it covers */
+    TimeBucket bucket;
+    int bucket_open;
+    long long bucket_end;
+    long long bucket_offset;
+
+    char *line;  // scratch for --grep and --templates
+    size_t line_capacity;
+} ColumnQuery;
+
+static int reserve_line(ColumnQuery *q, size_t len) {
+    if (len <= q->line_capacity) return 0;
+
+    char *line = realloc(q->line, len);
+    if (!line) return -1;
+
+    q->line = line;
+    q->line_capacity = len;
+    return 0;
+}
+
+/*
+ * Prepares --grep: patterns are matched once per distinct message, and
+ * the "TIMESTAMP LEVEL " prefix of a line only needs to be rebuilt and
+ * searched if some pattern can start with a byte found there.
+ * Returns 0 on success, non-zero on OOM.
+ */
+static int init_grep(ColumnQuery *q) {
+    static const char prefix_bytes[] = "0123456789-: INFOWARNERROR";
+    const GrepSet *grep = q->filter->grep;
+
+    q->grep_state = calloc(q->file->string_count + 1, 1);
+    if (!q->grep_state) return -1;
+
+    for (const char *b = prefix_bytes; *b; b++) {
+        if (grep->starts.member[(unsigned char)*b]) q->prefix_can_match = 1;
+    }
+    for (size_t i = 0; i < grep->count; i++) {
+        if (grep->lengths[i] > q->pattern_max) {
+            q->pattern_max = grep->lengths[i];
+        }
+    }
+
+    return reserve_line(q, TIMESTAMP_LEN + 8 + q->pattern_max);
+}
+
+/*
+ * Returns 1 if the original line of a row contains a --grep pattern:
+ * either its message does, or a match starts in the prefix and so ends
+ * within the first pattern_max - 1 bytes of the message. Returns 0 if
+ * not, -1 if the message is corrupt.
+ */
+static int row_matches(
+    ColumnQuery *q,
+    uint32_t id,
+    int level,
+    long long local_time
+) {
+    static const char *const level_names[LOG_LEVEL_COUNT] = {
+        "INFO ", "WARN ", "ERROR "
+    };
+    const GrepSet *grep = q->filter->grep;
+
+    if (q->grep_state[id] == 1) return 1;
+    if (q->grep_state[id] == 2 && !q->prefix_can_match) return 0;
+
+    size_t len;
+    const char *message = string_at(q->file, id, &len);
+    if (!message) return -1;
+
+    if (q->grep_state[id] == 0) {
+        q->grep_state[id] = grep_set_match(grep, message, len) ? 1 : 2;
+        if (q->grep_state[id] == 1) return 1;
+    }
+    if (!q->prefix_can_match) return 0;
+
+    char *p = q->line;
+    format_timestamp(local_time, p);
+    p += TIMESTAMP_LEN;
+    *p++ = ' ';
+
+    size_t name_len = strlen(level_names[level]);
+    memcpy(p, level_names[level], name_len);
+    p += name_len;
+
+    size_t head = len < q->pattern_max ? len : q->pattern_max - 1;
+    memcpy(p, message, head);
+    p += head;
+
+    return grep_set_match(grep, q->line, (size_t)(p - q->line));
+}
+
+/*
+ * Makes the bucket of time `ts` the open one, adding the previous
+ * bucket's counts to the result when it changes. Consecutive rows in
+ * the same bucket cost two compares instead of a division.
+ * Returns 0 on success, non-zero on OOM.
+ */
+static int enter_bucket(ColumnQuery *q, long long ts, long long utc_offset,
+                        long long width) {
+    if (q->bucket_open && utc_offset == q->bucket_offset &&
+        ts >= q->bucket.start_unix && ts < q->bucket_end) {
+        return 0;
+    }
+
+    long long start = bucket_start(ts, utc_offset, width);
+    q->bucket_end = start + width;
+    q->bucket_offset = utc_offset;
+    if (q->bucket_open && q->bucket.start_unix == start) return 0;
+
+    if (q->bucket_open &&
+        add_time_bucket_counts(q->result, &q->bucket) != 0) {
+        return -1;
+    }
+
+    memset(&q->bucket, 0, sizeof(q->bucket));
+    q->bucket.start_unix = start;
+    q->bucket_open = 1;
+    return 0;
+}
+
+/*
+ * Adds the per-string error counts to the result in the order the
+ * strings first occurred as errors, so ties rank as in a text run.
+ * Returns 0 on success, 1 if a string is corrupt, -1 on OOM.
+ */
+static int add_error_counts(ColumnQuery *q) {
+    for (size_t i = 0; i < q->error_seen; i++) {
+        uint32_t id = q->error_order[i];
+        size_t len;
+        const char *message = string_at(q->file, id, &len);
+        size_t count = q->error_counts[id];
+
+        if (!message) return 1;
+
+        if (!q->result->config.templates) {
+            if (add_error_count(q->result, message, len,
+                                NULL, 0, count) != 0) {
+                return -1;
+            }
+            continue;
+        }
+
+        if (reserve_line(q, TEMPLATE_MAX_LEN(len)) != 0) return -1;
+
+        size_t key_len = mask_message(message, len, q->line);
+        if (add_error_count(q->result, q->line, key_len,
+                            message, len, count) != 0) {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+/*
+ * Scans the rows block by block. Features that depend on more than
+ * counts (--approx-top, --distinct, --field) replay each row through
+ * process_log_line(); the rest only count, per bucket and per string,
+ * and touch the timestamp and id columns only when the query needs
+ * them. Blocks entirely outside --since/--until are skipped, like the
+ * lines a time-range search skips in a text log.
+ * Returns 0 on success, 1 if a column is corrupt, -1 on OOM.
+ */
+static int scan_rows(ColumnQuery *q, size_t *processed) {
+    const ColumnFile *file = q->file;
+    AnalysisResult *result = q->result;
+    const AnalysisConfig *config = &result->config;
+    const LineFilter *filter = q->filter;
+
+    int replay = config->approx_top || config->distinct || config->field;
+    int has_range = line_filter_has_range(filter);
+    int grep = filter && filter->grep;
+    long long width = config->group_by == GROUP_BY_HOUR ? 3600 : 60;
+
+    int need_time = config->group_by != GROUP_BY_NONE || has_range ||
+                    (grep && q->prefix_can_match);
+
+    const unsigned char *tend = file->timestamps + file->timestamps_len;
+    long long utc_offset = 0;
+    size_t run = 0;
+    size_t next_run_row = 0;  // row of offset run `run`
+
+    size_t counts[LOG_LEVEL_COUNT] = { 0 };
+    size_t accepted = 0;
+
+    for (size_t b = 0; b < file->block_count; b++) {
+        const unsigned char *block = file->blocks + 32 * b;
+        size_t first = b * BLOCK_ROWS;
+        size_t last = file->rows - first < BLOCK_ROWS ? file->rows
+                                                      : first + BLOCK_ROWS;
+
+        if (has_range && ((long long)load_u64(block + 24) < filter->since ||
+                          (long long)load_u64(block + 16) >= filter->until)) {
+            continue;
+        }
+
+        uint64_t tp_offset = load_u64(block);
+        if (tp_offset > file->timestamps_len) return 1;
+
+        const unsigned char *tp = file->timestamps + tp_offset;
+        long long ts = (long long)load_u64(block + 8);
+
+        for (size_t row = first; row < last; row++) {
+            if (need_time) {
+                uint64_t v = 0;
+                unsigned shift = 0;
+                for (;;) {
+                    if (tp == tend || shift > 63) return 1;
+                    unsigned char byte = *tp++;
+                    v |= (uint64_t)(byte & 0x7F) << shift;
+                    if (!(byte & 0x80)) break;
+                    shift += 7;
+                }
+                ts += (long long)((v >> 1) ^ (0 - (v & 1)));
+
+                while (run < file->offset_run_count && next_run_row <= row) {
+                    const unsigned char *r = file->offsets + 16 * run;
+                    utc_offset = (long long)load_u64(r + 8);
+                    run++;
+                    next_run_row = run < file->offset_run_count
+                                       ? (size_t)load_u64(r + 16)
+                                       : file->rows;
+                }
+            }
+
+            int level = (file->levels[row >> 2] >> ((row & 3) * 2)) & 3;
+            if (level >= LOG_LEVEL_COUNT) return 1;
+
+            uint32_t id = 0;
+            if (replay || grep || level == LOG_LEVEL_ERROR) {
+                id = load_id(file, row);
+                if (id >= file->string_count) return 1;
+            }
+
+            /* Same order of checks as parse_log_line() */
+            if (grep) {
+                int match = row_matches(q, id, level, ts + utc_offset);
+                if (match < 0) return 1;
+                if (!match) {
+                    result->rejected[PARSE_NO_MATCH]++;
+                    continue;
+                }
+            }
+            if (has_range && (ts < filter->since || ts >= filter->until)) {
+                result->rejected[PARSE_OUT_OF_RANGE]++;
+                continue;
+            }
+
+            accepted++;
+
+            if (replay) {
+                LogEntry entry;
+                memset(&entry, 0, sizeof(entry));
+                entry.level = (LogLevel)level;
+                entry.message = string_at(file, id, &entry.message_len);
+                if (!entry.message) return 1;
+                entry.timestamp_unix = ts;
+                entry.utc_offset = utc_offset;
+
+                process_log_line(result, &entry);
+                continue;
+            }
+
+            counts[level]++;
+            if (level == LOG_LEVEL_ERROR && q->error_counts[id]++ == 0) {
+                q->error_order[q->error_seen++] = id;
+            }
+
+            if (config->group_by != GROUP_BY_NONE) {
+                if (enter_bucket(q, ts, utc_offset, width) != 0) return -1;
+
+                q->bucket.total++;
+                if (level == LOG_LEVEL_INFO)  q->bucket.info++;
+                if (level == LOG_LEVEL_WARN)  q->bucket.warn++;
+                if (level == LOG_LEVEL_ERROR) q->bucket.error++;
+            }
+        }
+    }
+
+    if (!replay) {
+        result->total_lines += accepted;
+        result->info_count += counts[LOG_LEVEL_INFO];
+        result->warn_count += counts[LOG_LEVEL_WARN];
+        result->error_total += counts[LOG_LEVEL_ERROR];
+
+        if (q->bucket_open &&
+            add_time_bucket_counts(result, &q->bucket) != 0) {
+            return -1;
+        }
+    }
+
+    *processed = accepted;
+    return 0;
+}
+
+/* ---------- Public API ---------- */
+
+int column_writer_init(ColumnWriter *writer) {
+    if (!writer) return -1;
+
+    memset(writer, 0, sizeof(*writer));
+
+    if (hash_index_init(&writer->index, 0) != 0) return -1;
+    if (arena_init(&writer->text, 0) != 0) {
+        hash_index_free(&writer->index);
+        return -1;
+    }
+
+    return 0;
+}
+
+int column_writer_add(ColumnWriter *writer, const LogEntry *entry) {
+    if (!writer || !entry ||
+        entry->level < 0 || entry->level >= LOG_LEVEL_COUNT) {
+        return -1;
+    }
+
+    if (writer->rows >= writer->row_capacity && grow_rows(writer) != 0) {
+        return -1;
+    }
+
+    uint32_t id = intern_message(writer, entry->message, entry->message_len);
+    if (id == UINT32_MAX) return -1;
+
+    long long ts = entry->timestamp_unix;
+
+    if (writer->rows % BLOCK_ROWS == 0 && start_block(writer, ts) != 0) {
+        return -1;
+    }
+
+    if (put_offset(writer, entry->utc_offset) != 0 ||
+        put_delta(writer, ts - writer->last_unix) != 0) {
+        return -1;
+    }
+    writer->last_unix = ts;
+
+    uint64_t *block = writer->blocks + 4 * (writer->block_count - 1);
+    if (ts < (long long)block[2]) block[2] = (uint64_t)ts;
+    if (ts > (long long)block[3]) block[3] = (uint64_t)ts;
+
+    size_t row = writer->rows++;
+    writer->levels[row >> 2] |= (unsigned char)(entry->level << ((row & 3) * 2));
+    writer->ids[row] = id;
+    return 0;
+}
+
+void column_writer_reject(ColumnWriter *writer, ParseStatus status) {
+    if (!writer || status <= PARSE_OK || status >= PARSE_STATUS_COUNT) return;
+
+    writer->rejected[status]++;
+}
+
+int column_writer_save(const ColumnWriter *writer, const char *path) {
+    if (!writer || !path) return -1;
+
+    /* Write a temporary file and rename it into place */
+    size_t path_len = strlen(path);
+    char *tmp_path = malloc(path_len + 5);
+    if (!tmp_path) {
+        fprintf(stderr, "Error: Memory allocation failed\n");
+        return -1;
+    }
+    memcpy(tmp_path, path, path_len);
+    memcpy(tmp_path + path_len, ".tmp", 5);
+
+    int status = -1;
+    FILE *file = fopen(tmp_path, "wb");
+    if (file) {
+        int ok = write_columns(writer, file) == 0;
+        ok = (fclose(file) == 0) && ok;
+
+        if (ok && rename(tmp_path, path) == 0) {
+            status = 0;
+        } else {
+            remove(tmp_path);
+        }
+    }
+
+    if (status != 0) {
+        fprintf(stderr, "Error: Could not write columnar file '%s'\n", path);
+    }
+
+    free(tmp_path);
+    return status;
+}
+
+void column_writer_free(ColumnWriter *writer) {
+    if (!writer) return;
+
+    free(writer->timestamps);
+    free(writer->offset_runs);
+    free(writer->blocks);
+    free(writer->levels);
+    free(writer->ids);
+    free(writer->string_offsets);
+    free(writer->string_lengths);
+    hash_index_free(&writer->index);
+    arena_free(&writer->text);
+    memset(writer, 0, sizeof(*writer));
+}
+
+int columnar_detect(const char *data, size_t len) {
+    return data && len >= 8 && memcmp(data, COLUMNAR_MAGIC, 8) == 0;
+}
+
+int analyze_columnar(
+    AnalysisResult *result,
+    const char *data,
+    size_t len,
+    const LineFilter *filter,
+    size_t *processed,
+    StageTimes *times
+) {
+    if (!result || !data || !processed) return -1;
+
+    double start = times ? stats_clock() : 0;
+
+    ColumnFile file;
+    if (open_columns(&file, data, len) != 0) return 1;
+
+    ColumnQuery q;
+    memset(&q, 0, sizeof(q));
+    q.file = &file;
+    q.filter = filter;
+    q.result = result;
+
+    const AnalysisConfig *config = &result->config;
+    int replay = config->approx_top || config->distinct || config->field;
+    int status = 0;
+
+    if (filter && filter->grep && init_grep(&q) != 0) status = -1;
+
+    if (status == 0 && !replay) {
+        q.error_counts = calloc(file.string_count + 1, sizeof(size_t));
+        q.error_order = malloc((file.string_count + 1) * sizeof(uint32_t));
+        if (!q.error_counts || !q.error_order) status = -1;
+    }
+
+    double scan_start = times ? stats_clock() : 0;
+    if (times) times->seconds[STAGE_READ] += scan_start - start;
+
+    if (status == 0) status = scan_rows(&q, processed);
+
+    double scan_end = times ? stats_clock() : 0;
+    if (times) {
+        times->seconds[STAGE_PARSE] += scan_end - scan_start;
+        times->bytes += len;
+    }
+
+    if (status == 0 && !replay) status = add_error_counts(&q);
+
+    if (times) times->seconds[STAGE_AGGREGATE] += stats_clock() - scan_end;
+
+    for (int s = 1; s < PARSE_STATUS_COUNT; s++) {
+        result->rejected[s] += file.rejected[s];
+    }
+
+    free(q.grep_state);
+    free(q.error_counts);
+    free(q.error_order);
+    free(q.line);
+    return status;
+}
@@ -0,0 +1,432 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "decompress.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+#define RING_SLOTS     4
+#define RING_SLOT_SIZE (4 * 1024 * 1024)
+#define INPUT_CHUNK    (256 * 1024)
+
+struct Decompressor {
+    Compression type;
+    const char *name;  // for diagnostics
+
+    /* Compressed input: prefix, then fd */
+    const char *prefix;
+    size_t prefix_len;
+    int prefix_used;
+    int fd;
+    char *input;
+
+    /* Ring of decompressed blocks */
+    char *slots[RING_SLOTS];
+    size_t lengths[RING_SLOTS];
+    size_t produced;  // blocks published by the producer
+    size_t consumed;  // blocks released by the consumer
+    int holding;      // consumer holds block `consumed`
+
+    int done;
+    int failed;
+    int stop;
+
+    pthread_mutex_t lock;
+    pthread_cond_t not_empty;
+    pthread_cond_t not_full;
+    pthread_t thread;
+};
+
+/* Producer-side output cursor */
+typedef struct {
+    char *block;
+    size_t fill;
+} Output;
+
+/* ---------- Helpers ---------- */
+
+#if defined(HAVE_ZLIB) || defined(HAVE_ZSTD)
+#define HAVE_CODEC
+#endif
+
+#ifdef HAVE_CODEC
+/*
+ * Returns the next chunk of compressed input, or 0 bytes at EOF.
+ * Returns -1 on read error.
+ */
+static long next_input(Decompressor *d, const char **data) {
+    if (!d->prefix_used) {
+        d->prefix_used = 1;
+        if (d->prefix_len > 0) {
+            *data = d->prefix;
+            return (long)d->prefix_len;
+        }
+    }
+
+    if (d->fd < 0) return 0;
+
+    ssize_t n;
+    do {
+        n = read(d->fd, d->input, INPUT_CHUNK);
+    } while (n < 0 && errno == EINTR);
+
+    *data = d->input;
+    return n < 0 ? -1 : (long)n;
+}
+#endif
+
+/*
+ * Waits for a free ring slot. Returns NULL if the consumer stopped.
+ */
+static char *acquire_slot(Decompressor *d) {
+    pthread_mutex_lock(&d->lock);
+    while (!d->stop && d->produced - d->consumed >= RING_SLOTS) {
+        pthread_cond_wait(&d->not_full, &d->lock);
+    }
+    char *slot = d->stop ? NULL : d->slots[d->produced % RING_SLOTS];
+    pthread_mutex_unlock(&d->lock);
+
+    return slot;
+}
+
+static void publish_slot(Decompressor *d, size_t len) {
+    pthread_mutex_lock(&d->lock);
+    d->lengths[d->produced % RING_SLOTS] = len;
+    d->produced++;
+    pthread_cond_signal(&d->not_empty);
+    pthread_mutex_unlock(&d->lock);
+}
+
+#ifdef HAVE_CODEC
+/*
+ * Publishes the current block if it is full and acquires the next one.
+ * Returns 0 to continue, non-zero if the consumer stopped.
+ */
+static int rotate_if_full(Decompressor *d, Output *out) {
+    if (out->fill < RING_SLOT_SIZE) return 0;
+
+    publish_slot(d, out->fill);
+    out->fill = 0;
+    out->block = acquire_slot(d);
+
+    return out->block ? 0 : -1;
+}
+#endif
+
+#ifdef HAVE_ZLIB
+static void warn_trailing_data(const Decompressor *d) {
+    fprintf(stderr, "Warning: Ignoring trailing data after the gzip "
+                    "stream in '%s'\n", d->name);
+}
+
+/*
+ * Inflates gzip or zlib data, including concatenated gzip members.
+ * Data after the last member that is not another member only draws a
+ * warning.
+ * Returns 0 on success, non-zero on corrupt or truncated input.
+ */
+static int run_gzip(Decompressor *d, Output *out) {
+    z_stream zs;
+    memset(&zs, 0, sizeof(zs));
+
+    /* 15 window bits + 32: detect gzip or zlib headers */
+    if (inflateInit2(&zs, 15 + 32) != Z_OK) return -1;
+
+    int status = 0;
+    int stream_end = 0;
+    int magic_split = 0;  // a member's first magic byte ended the chunk
+
+    for (;;) {
+        if (zs.avail_in == 0) {
+            const char *data;
+            long n = next_input(d, &data);
+            if (n < 0) {
+                status = -1;
+                break;
+            }
+            if (n == 0) {
+                if (magic_split) {
+                    warn_trailing_data(d);  // a lone 0x1f byte
+                } else if (!stream_end) {
+                    status = -1;  // truncated
+                }
+                break;
+            }
+
+            zs.next_in = (Bytef *)data;
+            zs.avail_in = (uInt)n;
+
+            if (magic_split) {
+                magic_split = 0;
+                if ((unsigned char)data[0] != 0x8b) {
+                    warn_trailing_data(d);
+                    break;
+                }
+            }
+        }
+
+        /*
+         * After a member only another gzip member may follow; anything
+         * else (zero padding, garbage) is ignored like gzip(1) does.
+         */
+        if (stream_end) {
+            const unsigned char *p = zs.next_in;
+            if (p[0] != 0x1f || (zs.avail_in > 1 && p[1] != 0x8b)) {
+                warn_trailing_data(d);
+                break;
+            }
+            magic_split = zs.avail_in == 1;
+            inflateReset(&zs);  // next gzip member
+            stream_end = 0;
+        }
+
+        zs.next_out = (Bytef *)out->block + out->fill;
+        zs.avail_out = (uInt)(RING_SLOT_SIZE - out->fill);
+
+        int rc = inflate(&zs, Z_NO_FLUSH);
+        out->fill = RING_SLOT_SIZE - zs.avail_out;
+
+        if (rc == Z_STREAM_END) {
+            stream_end = 1;
+        } else if (rc != Z_OK && rc != Z_BUF_ERROR) {
+            status = -1;
+            break;
+        }
+
+        if (rotate_if_full(d, out) != 0) break;
+    }
+
+    inflateEnd(&zs);
+    return status;
+}
+#endif
+
+#ifdef HAVE_ZSTD
+/*
+ * Decompresses a sequence of zstd frames.
+ * Returns 0 on success, non-zero on corrupt or truncated input.
+ */
+static int run_zstd(Decompressor *d, Output *out) {
+    ZSTD_DStream *ds = ZSTD_createDStream();
+    if (!ds) return -1;
+    ZSTD_initDStream(ds);
+
+    ZSTD_inBuffer in = { NULL, 0, 0 };
+    size_t pending = 0;  // non-zero while a frame is incomplete
+    int status = 0;
+
+    for (;;) {
+        if (in.pos == in.size) {
+            const char *data;
+            long n = next_input(d, &data);
+            if (n < 0) {
+                status = -1;
+                break;
+            }
+            if (n == 0) {
+                if (pending != 0) status = -1;  // truncated
+                break;
+            }
+
+            in.src = data;
+            in.size = (size_t)n;
+            in.pos = 0;
+        }
+
+        ZSTD_outBuffer zout = {
+            out->block + out->fill, RING_SLOT_SIZE - out->fill, 0
+        };
+
+        pending = ZSTD_decompressStream(ds, &zout, &in);
+        out->fill += zout.pos;
+
+        if (ZSTD_isError(pending)) {
+            status = -1;
+            break;
+        }
+
+        if (rotate_if_full(d, out) != 0) break;
+    }
+
+    ZSTD_freeDStream(ds);
+    return status;
+}
+#endif
+
+static void *decompress_thread(void *arg) {
+    Decompressor *d = arg;
+    Output out = { acquire_slot(d), 0 };
+    int status = -1;
+
+    if (out.block) {
+#ifdef HAVE_ZLIB
+        if (d->type == COMPRESSION_GZIP) status = run_gzip(d, &out);
+#endif
+#ifdef HAVE_ZSTD
+        if (d->type == COMPRESSION_ZSTD) status = run_zstd(d, &out);
+#endif
+        if (out.block && out.fill > 0) publish_slot(d, out.fill);
+    }
+
+    pthread_mutex_lock(&d->lock);
+    d->done = 1;
+    d->failed = status != 0 && !d->stop;
+    pthread_cond_signal(&d->not_empty);
+    pthread_mutex_unlock(&d->lock);
+
+    return NULL;
+}
+
+static void free_decompressor(Decompressor *d) {
+    for (size_t i = 0; i < RING_SLOTS; i++) {
+        free(d->slots[i]);
+    }
+    free(d->input);
+    free(d);
+}
+
+/* ---------- Public API ---------- */
+
+Compression detect_compression(const char *data, size_t len) {
+    const unsigned char *p = (const unsigned char *)data;
+
+    if (len >= 2 && p[0] == 0x1f && p[1] == 0x8b) return COMPRESSION_GZIP;
+    if (len >= 4 && p[0] == 0x28 && p[1] == 0xb5 &&
+        p[2] == 0x2f && p[3] == 0xfd) {
+        return COMPRESSION_ZSTD;
+    }
+
+    return COMPRESSION_NONE;
+}
+
+const char *compression_name(Compression type) {
+    switch (type) {
+        case COMPRESSION_GZIP: return "gzip";
+        case COMPRESSION_ZSTD: return "zstd";
+        default:               return "none";
+    }
+}
+
+int compression_supported(Compression type) {
+    switch (type) {
+        case COMPRESSION_NONE: return 1;
+#ifdef HAVE_ZLIB
+        case COMPRESSION_GZIP: return 1;
+#endif
+#ifdef HAVE_ZSTD
+        case COMPRESSION_ZSTD: return 1;
+#endif
+        default:               return 0;
+    }
+}
+
+Decompressor *decompressor_start(
+    Compression type,
+    const char *name,
+    const char *prefix,
+    size_t prefix_len,
+    int fd
+) {
+    if (type == COMPRESSION_NONE || !compression_supported(type)) {
+        return NULL;
+    }
+
+    Decompressor *d = calloc(1, sizeof(*d));
+    if (!d) return NULL;
+
+    d->type = type;
+    d->name = name;
+    d->prefix = prefix;
+    d->prefix_len = prefix_len;
+    d->fd = fd;
+
+    for (size_t i = 0; i < RING_SLOTS; i++) {
+        d->slots[i] = malloc(RING_SLOT_SIZE);
+        if (!d->slots[i]) {
+            free_decompressor(d);
+            return NULL;
+        }
+    }
+
+    if (fd >= 0 && !(d->input = malloc(INPUT_CHUNK))) {
+        free_decompressor(d);
+        return NULL;
+    }
+
+    if (pthread_mutex_init(&d->lock, NULL) != 0) {
+        free_decompressor(d);
+        return NULL;
+    }
+    pthread_cond_init(&d->not_empty, NULL);
+    pthread_cond_init(&d->not_full, NULL);
+
+    if (pthread_create(&d->thread, NULL, decompress_thread, d) != 0) {
+        pthread_cond_destroy(&d->not_empty);
+        pthread_cond_destroy(&d->not_full);
+        pthread_mutex_destroy(&d->lock);
+        free_decompressor(d);
+        return NULL;
+    }
+
+    return d;
+}
+
+const char *decompressor_next(Decompressor *d, size_t *len) {
+    if (!d || !len) return NULL;
+
+    pthread_mutex_lock(&d->lock);
+
+    /* Hand the previous block back to the producer */
+    if (d->holding) {
+        d->consumed++;
+        d->holding = 0;
+        pthread_cond_signal(&d->not_full);
+    }
+
+    while (d->produced == d->consumed && !d->done) {
+        pthread_cond_wait(&d->not_empty, &d->lock);
+    }
+
+    const char *block = NULL;
+    if (d->produced > d->consumed) {
+        size_t slot = d->consumed % RING_SLOTS;
+        block = d->slots[slot];
+        *len = d->lengths[slot];
+        d->holding = 1;
+    }
+
+    pthread_mutex_unlock(&d->lock);
+    return block;
+}
+
+int decompressor_failed(const Decompressor *d) {
+    return d ? d->failed : 0;
+}
+
+void decompressor_stop(Decompressor *d) {
+    if (!d) return;
+
+    pthread_mutex_lock(&d->lock);
+    d->stop = 1;
+    pthread_cond_signal(&d->not_full);
+    pthread_mutex_unlock(&d->lock);
+
+    pthread_join(d->thread, NULL);
+
+    pthread_cond_destroy(&d->not_empty);
+    pthread_cond_destroy(&d->not_full);
+    pthread_mutex_destroy(&d->lock);
+    free_decompressor(d);
+}
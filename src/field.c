@@ -0,0 +1,131 @@
+#include "field.h"
+
+#include <string.h>
+
+/* ---------- Helpers ---------- */
+
+static int is_digit(unsigned char c) {
+    return c >= '0' && c <= '9';
+}
+
+static int is_word(unsigned char c) {
+    return is_digit(c) || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+           c == '_';
+}
+
+/*
+ * Parses "digits[.digits]" at p (n bytes left) into *value.
+ * Returns the number of bytes consumed, or 0 if there is no number.
+ */
+static size_t parse_number(const unsigned char *p, size_t n, double *value) {
+    size_t i = 0;
+    double v = 0;
+
+    while (i < n && is_digit(p[i])) {
+        v = v * 10 + (p[i] - '0');
+        i++;
+    }
+    if (i == 0) return 0;
+
+    if (i + 1 < n && p[i] == '.' && is_digit(p[i + 1])) {
+        double scale = 0.1;
+        for (i++; i < n && is_digit(p[i]); i++) {
+            v += (p[i] - '0') * scale;
+            scale /= 10;
+        }
+    }
+
+    *value = v;
+    return i;
+}
+
+/*
+ * Matches a time unit (ns, us, ms, s) forming the whole word at p and
+ * stores its factor to milliseconds.
+ * Returns the unit length, or 0 if the word at p is not a time unit.
+ */
+static size_t match_unit(const unsigned char *p, size_t n, double *factor) {
+    static const struct {
+        const char *suffix;
+        double factor;
+    } units[] = {
+        { "ns", 1e-6 }, { "us", 1e-3 }, { "ms", 1.0 }, { "s", 1e3 }
+    };
+
+    for (size_t u = 0; u < sizeof(units) / sizeof(units[0]); u++) {
+        size_t len = strlen(units[u].suffix);
+
+        if (len <= n && memcmp(p, units[u].suffix, len) == 0 &&
+            (len == n || !is_word(p[len]))) {
+            *factor = units[u].factor;
+            return len;
+        }
+    }
+
+    return 0;
+}
+
+/*
+ * Parses the separator and value after a field name at p.
+ * The unit is either attached ("5ms") or, only after a space separator,
+ * the next word ("took 5 ms"). A word there that is not a time unit
+ * ("5sec", "took 5 seconds") rejects the value rather than guessing.
+ * Returns 0 on success.
+ */
+static int parse_field_value(const unsigned char *p, size_t n, double *value) {
+    size_t i = 0;
+
+    if (i >= n || (p[i] != '=' && p[i] != ':' && p[i] != ' ')) return -1;
+    int prose = p[i] == ' ';
+    i++;
+    while (i < n && p[i] == ' ') i++;
+
+    size_t used = parse_number(p + i, n - i, value);
+    if (used == 0) return -1;
+    i += used;
+
+    double factor = 1.0;
+
+    if (i < n && is_word(p[i])) {
+        if (match_unit(p + i, n - i, &factor) == 0) return -1;
+    } else if (prose && i + 1 < n && p[i] == ' ' && is_word(p[i + 1])) {
+        if (match_unit(p + i + 1, n - i - 1, &factor) == 0) return -1;
+    }
+
+    *value *= factor;
+    return 0;
+}
+
+/* ---------- Public API ---------- */
+
+int extract_field(
+    const char *message,
+    size_t len,
+    const char *name,
+    size_t name_len,
+    double *value
+) {
+    if (!message || !name || name_len == 0 || !value) return -1;
+
+    const unsigned char *p = (const unsigned char *)message;
+    size_t pos = 0;
+
+    while (pos + name_len < len) {
+        const char *hit = memchr(message + pos, name[0], len - pos);
+        if (!hit) break;
+
+        size_t at = (size_t)(hit - message);
+        size_t after = at + name_len;
+
+        if (after < len &&
+            (at == 0 || !is_word(p[at - 1])) &&
+            memcmp(hit, name, name_len) == 0 &&
+            parse_field_value(p + after, len - after, value) == 0) {
+            return 0;
+        }
+
+        pos = at + 1;
+    }
+
+    return -1;
+}
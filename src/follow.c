@@ -0,0 +1,427 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "follow.h"
+#include "parallel.h"
+#include "parser.h"
+#include "utils.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#endif
+
+/* Upper bound on how long we sleep without re-checking the file */
+#define POLL_TIMEOUT_MS 1000
+
+/* Leading bytes remembered to recognize a truncated-and-regrown file */
+#define HEAD_BYTES 64
+
+struct Follower {
+    const char *path;
+    int fd;
+    dev_t dev;
+    ino_t ino;
+    off_t offset;
+
+    /* First bytes of the file as read, compared on every step */
+    char head[HEAD_BYTES];
+    size_t head_len;
+
+    /* Bytes read but not yet processed (a partial last line) */
+    char *pending;
+    size_t pending_len;
+    size_t pending_capacity;
+
+    AnalysisResult *result;
+    LogParser parser;
+    size_t processed;
+    size_t unreported;
+
+    int notify_fd;
+    int file_wd;
+    int dir_wd;
+};
+
+static volatile sig_atomic_t stop_requested = 0;
+
+/* ---------- Helpers ---------- */
+
+static void handle_stop(int sig) {
+    (void)sig;
+    stop_requested = 1;
+}
+
+static long long monotonic_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+/*
+ * Processes complete lines in the pending buffer; with `flush`, also
+ * processes a trailing partial line.
+ */
+static void process_pending(Follower *f, int flush) {
+    if (f->pending_len == 0) return;
+
+    size_t upto = f->pending_len;
+
+    if (!flush) {
+        const char *p = f->pending + f->pending_len;
+        while (p > f->pending && p[-1] != '\n') p--;
+        upto = (size_t)(p - f->pending);
+        if (upto == 0) return;
+    }
+
+    size_t n = analyze_buffer(f->result, &f->parser, f->pending, upto);
+    f->processed += n;
+    f->unreported += n;
+
+    memmove(f->pending, f->pending + upto, f->pending_len - upto);
+    f->pending_len -= upto;
+}
+
+/*
+ * Reads what is currently available from the file, stopping once about
+ * `budget` bytes have been read.
+ * Returns 1 if the budget ran out, 0 at end of file, -1 on read error.
+ */
+static int read_available(Follower *f, size_t budget) {
+    size_t total = 0;
+
+    for (;;) {
+        if (total >= budget) return 1;
+
+        if (f->pending_len == f->pending_capacity) {
+            size_t new_capacity = f->pending_capacity * 2;
+            char *new_pending = realloc(f->pending, new_capacity);
+            if (!new_pending) return -1;
+
+            f->pending = new_pending;
+            f->pending_capacity = new_capacity;
+        }
+
+        ssize_t n = read(f->fd, f->pending + f->pending_len,
+                         f->pending_capacity - f->pending_len);
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0) return -1;
+        if (n == 0) return 0;
+
+        if (f->head_len < HEAD_BYTES && f->offset == (off_t)f->head_len) {
+            size_t take = HEAD_BYTES - f->head_len;
+            if (take > (size_t)n) take = (size_t)n;
+            memcpy(f->head + f->head_len, f->pending + f->pending_len, take);
+            f->head_len += take;
+        }
+
+        f->pending_len += (size_t)n;
+        f->offset += n;
+        total += (size_t)n;
+        process_pending(f, 0);
+    }
+}
+
+static void watch_file(Follower *f) {
+#ifdef __linux__
+    if (f->notify_fd < 0) return;
+
+    if (f->file_wd >= 0) inotify_rm_watch(f->notify_fd, f->file_wd);
+    f->file_wd = inotify_add_watch(f->notify_fd, f->path,
+                                   IN_MODIFY | IN_ATTRIB |
+                                   IN_MOVE_SELF | IN_DELETE_SELF);
+#else
+    (void)f;
+#endif
+}
+
+/*
+ * Opens the path and records its identity.
+ * Returns 0 on success, non-zero if the file does not exist (yet).
+ */
+static int open_current(Follower *f) {
+    int fd = open(f->path, O_RDONLY);
+    if (fd < 0) return -1;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return -1;
+    }
+
+    f->fd = fd;
+    f->dev = st.st_dev;
+    f->ino = st.st_ino;
+    f->offset = 0;
+    f->head_len = 0;
+
+    watch_file(f);
+    return 0;
+}
+
+/*
+ * Returns non-zero if the open file was truncated in place since we
+ * read it: it is now shorter than our offset, or (copytruncate followed
+ * by new writes past the old offset) its first bytes changed.
+ * A file regrown with exactly the same leading bytes goes unnoticed.
+ */
+static int truncated(Follower *f) {
+    struct stat st;
+
+    if (fstat(f->fd, &st) != 0) return 0;
+    if (st.st_size < f->offset) return 1;
+    if (f->head_len == 0) return 0;
+
+    char head[HEAD_BYTES];
+    ssize_t n = pread(f->fd, head, f->head_len, 0);
+    return n >= 0 &&
+           ((size_t)n < f->head_len || memcmp(head, f->head, f->head_len) != 0);
+}
+
+/*
+ * Restarts reading a truncated file from offset 0.
+ */
+static void restart(Follower *f) {
+    /* What we have of the old contents is complete */
+    process_pending(f, 1);
+    lseek(f->fd, 0, SEEK_SET);
+    f->offset = 0;
+    f->head_len = 0;
+}
+
+/*
+ * Detects truncation and rename + create rotation.
+ * Returns non-zero if reading restarted on a truncated or new file.
+ */
+static int check_rotation(Follower *f) {
+    struct stat st;
+
+    if (f->fd >= 0 && truncated(f)) {
+        restart(f);
+        return 1;
+    }
+
+    if (stat(f->path, &st) != 0) return 0;  // moved away, not recreated yet
+    if (f->fd >= 0 && st.st_dev == f->dev && st.st_ino == f->ino) return 0;
+
+    /* A new file took the name: finish the old one first */
+    if (f->fd >= 0) {
+        read_available(f, SIZE_MAX);
+        process_pending(f, 1);
+        close(f->fd);
+        f->fd = -1;
+    }
+
+    return open_current(f) == 0;
+}
+
+/*
+ * Discards queued inotify events; the file itself is re-checked by the
+ * caller.
+ */
+static void drain_events(Follower *f) {
+#ifdef __linux__
+    char events[4096];
+
+    if (f->notify_fd < 0) return;
+    while (read(f->notify_fd, events, sizeof(events)) > 0) {
+        /* Only the wakeup matters */
+    }
+#else
+    (void)f;
+#endif
+}
+
+/*
+ * Waits for file activity or the timeout.
+ */
+static void wait_for_change(Follower *f, int timeout_ms) {
+#ifdef __linux__
+    if (f->notify_fd >= 0) {
+        struct pollfd pfd = { f->notify_fd, POLLIN, 0 };
+
+        if (poll(&pfd, 1, timeout_ms) > 0) drain_events(f);
+        return;
+    }
+#else
+    (void)f;
+#endif
+    poll(NULL, 0, timeout_ms);
+}
+
+static void setup_notify(Follower *f, char *dir) {
+    f->notify_fd = -1;
+    f->file_wd = -1;
+    f->dir_wd = -1;
+
+#ifdef __linux__
+    f->notify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (f->notify_fd < 0) return;
+
+    /* Watch the directory to notice the name being recreated */
+    f->dir_wd = inotify_add_watch(f->notify_fd, dir,
+                                  IN_CREATE | IN_MOVED_TO);
+#else
+    (void)dir;
+#endif
+}
+
+/* ---------- Public API ---------- */
+
+Follower *follower_open(
+    const char *filename,
+    const LineFilter *filter,
+    AnalysisResult *result
+) {
+    if (!filename || !result) return NULL;
+
+    Follower *f = calloc(1, sizeof(*f));
+    if (!f) return NULL;
+
+    f->path = filename;
+    f->fd = -1;
+    f->result = result;
+    log_parser_init(&f->parser, filter);
+
+    f->pending_capacity = BUFFER_SIZE;
+    f->pending = malloc(f->pending_capacity);
+
+    /* Directory containing the file, for rotation events */
+    char *dir = malloc(strlen(filename) + 2);
+    if (!f->pending || !dir) {
+        free(dir);
+        free(f->pending);
+        free(f);
+        return NULL;
+    }
+
+    const char *slash = strrchr(filename, '/');
+    if (slash) {
+        size_t dir_len = slash == filename ? 1 : (size_t)(slash - filename);
+        memcpy(dir, filename, dir_len);
+        dir[dir_len] = '\0';
+    } else {
+        strcpy(dir, ".");
+    }
+
+    setup_notify(f, dir);
+    free(dir);
+
+    if (open_current(f) != 0) {
+        if (f->notify_fd >= 0) close(f->notify_fd);
+        free(f->pending);
+        free(f);
+        return NULL;
+    }
+
+    return f;
+}
+
+int follower_notify_fd(const Follower *f) {
+    return f ? f->notify_fd : -1;
+}
+
+int follower_step(Follower *f, size_t budget) {
+    if (!f) return -1;
+
+    drain_events(f);
+
+    if (f->fd >= 0) {
+        /* Before reading, so regrown contents are read from the start */
+        if (truncated(f)) restart(f);
+
+        int more = read_available(f, budget);
+        if (more != 0) return more;
+    }
+
+    return check_rotation(f) ? 1 : 0;
+}
+
+size_t follower_close(Follower *f) {
+    if (!f) return 0;
+
+    process_pending(f, 1);
+    size_t processed = f->processed;
+
+    if (f->fd >= 0) close(f->fd);
+    if (f->notify_fd >= 0) close(f->notify_fd);
+    free(f->pending);
+    free(f);
+    return processed;
+}
+
+int follow_file(
+    const char *filename,
+    const LineFilter *filter,
+    AnalysisResult *result,
+    unsigned interval_sec,
+    FollowReportFn report,
+    void *ctx,
+    size_t *processed
+) {
+    if (!filename || !result || !report || !processed) return -1;
+
+    Follower *f = follower_open(filename, filter, result);
+    if (!f) return -1;
+
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = handle_stop;
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+
+    int status = 0;
+    int report_failed = 0;
+    long long interval_ms = (long long)interval_sec * 1000;
+    long long next_report = monotonic_ms();
+
+    while (!stop_requested) {
+        int ready;
+        do {
+            ready = follower_step(f, SIZE_MAX);
+        } while (ready > 0);
+
+        if (ready < 0) {
+            status = -1;
+            break;
+        }
+
+        long long now = monotonic_ms();
+        if (now >= next_report) {
+            if (f->unreported > 0) {
+                status = report(result, ctx);
+                f->unreported = 0;
+                if (status != 0) {
+                    report_failed = 1;
+                    break;
+                }
+            }
+            next_report = now + interval_ms;
+        }
+
+        long long wait = next_report - now;
+        if (wait > POLL_TIMEOUT_MS) wait = POLL_TIMEOUT_MS;
+        wait_for_change(f, (int)wait);
+    }
+
+    /* Count whatever is left, including an unterminated last line */
+    if (f->fd >= 0) read_available(f, SIZE_MAX);
+    process_pending(f, 1);
+    if (!report_failed) {
+        int report_status = report(result, ctx);
+        if (status == 0) status = report_status;
+    }
+
+    *processed = follower_close(f);
+    return status;
+}
@@ -0,0 +1,455 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "grep.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Largest full DFA table built; bigger sets match on the sparse trie */
+#define DFA_MAX_BYTES (32 * 1024 * 1024)
+
+/* ---------- Helpers ---------- */
+
+/*
+ * Assigns a class to every byte that occurs in a pattern and records
+ * the bytes patterns start with.
+ */
+static void assign_classes(GrepSet *set) {
+    memset(set->byte_class, 0, sizeof(set->byte_class));
+    scan_byte_set_init(&set->starts);
+    set->class_count = 1;
+
+    for (size_t i = 0; i < set->count; i++) {
+        const unsigned char *p =
+            (const unsigned char *)arena_get(&set->text, set->offsets[i]);
+
+        scan_byte_set_add(&set->starts, p[0]);
+
+        for (size_t j = 0; j < set->lengths[i]; j++) {
+            if (set->byte_class[p[j]] == 0) {
+                set->byte_class[p[j]] = (uint16_t)set->class_count++;
+            }
+        }
+    }
+}
+
+/*
+ * Builds the trie of all patterns into set->next (0 = no edge; no trie
+ * edge leads back to the root).
+ * Returns the number of states.
+ */
+static size_t build_trie(GrepSet *set) {
+    size_t states = 1;
+
+    for (size_t i = 0; i < set->count; i++) {
+        const unsigned char *p =
+            (const unsigned char *)arena_get(&set->text, set->offsets[i]);
+        size_t s = 0;
+
+        for (size_t j = 0; j < set->lengths[i]; j++) {
+            uint32_t *edge = &set->next[s * set->class_count +
+                                        set->byte_class[p[j]]];
+            if (*edge == 0) *edge = (uint32_t)states++;
+            s = *edge;
+        }
+
+        set->accept[s] = 1;
+    }
+
+    return states;
+}
+
+/*
+ * Turns the trie into a DFA: computes failure links breadth-first and
+ * fills every missing edge with the edge of the failure state, and
+ * marks states whose failure chain reaches an accepting state.
+ * Returns 0 on success, non-zero on OOM.
+ */
+static int build_dfa(GrepSet *set, size_t states) {
+    uint32_t *fail = calloc(states, sizeof(uint32_t));
+    uint32_t *queue = malloc(states * sizeof(uint32_t));
+    if (!fail || !queue) {
+        free(fail);
+        free(queue);
+        return -1;
+    }
+
+    size_t classes = set->class_count;
+    size_t head = 0, tail = 0;
+
+    /* Children of the root fail to the root; missing edges stay there */
+    for (size_t c = 0; c < classes; c++) {
+        if (set->next[c] != 0) queue[tail++] = set->next[c];
+    }
+
+    while (head < tail) {
+        uint32_t s = queue[head++];
+        uint32_t *row = &set->next[(size_t)s * classes];
+        const uint32_t *fail_row = &set->next[(size_t)fail[s] * classes];
+
+        for (size_t c = 0; c < classes; c++) {
+            if (row[c] == 0) {
+                row[c] = fail_row[c];
+                continue;
+            }
+
+            uint32_t t = row[c];
+            fail[t] = fail_row[c];
+            if (set->accept[fail[t]]) set->accept[t] = 1;
+            queue[tail++] = t;
+        }
+    }
+
+    free(fail);
+    free(queue);
+    return 0;
+}
+
+/*
+ * Returns the offset of the next byte at or after i that can start a
+ * pattern, or len. A single start byte is found with memchr() directly,
+ * which for short lines beats the kernel dispatch of scan_find_any().
+ */
+static size_t skip_to_start(
+    const GrepSet *set,
+    const char *text,
+    size_t len,
+    size_t i
+) {
+    if (set->starts.count == 1) {
+        const char *hit = memchr(text + i, set->starts.bytes[0], len - i);
+        return hit ? (size_t)(hit - text) : len;
+    }
+    return scan_find_any(text, len, i, &set->starts);
+}
+
+/* Children at which a trie state gets a child row */
+#define ROW_MIN_CHILDREN 4
+
+/*
+ * Returns the trie child of state s on class c, or 0 if there is none.
+ */
+static uint32_t trie_child(const GrepSet *set, uint32_t s, uint16_t c) {
+    if (set->row_of[s] != 0) {
+        size_t row = set->row_of[s] - 1;
+        return set->rows[row * set->class_count + c];
+    }
+
+    for (uint32_t t = set->child[s]; t != 0; t = set->sibling[t]) {
+        if (set->label[t] == c) return t;
+    }
+    return 0;
+}
+
+/*
+ * Gives state s a child row holding its current children, if the row
+ * budget allows; without one it keeps using its child list.
+ * Returns 0 on success (or when over budget), non-zero on OOM.
+ */
+static int add_child_row(GrepSet *set, uint32_t s) {
+    size_t classes = set->class_count;
+
+    if ((set->row_count + 1) * classes * sizeof(uint32_t) > DFA_MAX_BYTES) {
+        return 0;
+    }
+
+    if (set->row_count == set->row_capacity) {
+        size_t new_capacity = set->row_capacity ? set->row_capacity * 2 : 16;
+        uint32_t *rows =
+            realloc(set->rows, new_capacity * classes * sizeof(uint32_t));
+        if (!rows) return -1;
+
+        set->rows = rows;
+        set->row_capacity = new_capacity;
+    }
+
+    uint32_t *row = &set->rows[set->row_count * classes];
+    memset(row, 0, classes * sizeof(uint32_t));
+    for (uint32_t t = set->child[s]; t != 0; t = set->sibling[t]) {
+        row[set->label[t]] = t;
+    }
+
+    set->row_of[s] = (uint32_t)++set->row_count;
+    return 0;
+}
+
+/*
+ * Builds the sparse trie: child lists, plus child rows for states that
+ * reach ROW_MIN_CHILDREN children (the root gets one up front), counted
+ * in `children` (zeroed, one per state).
+ * Returns the number of states, or 0 on OOM.
+ */
+static size_t build_sparse_trie(GrepSet *set, uint8_t *children) {
+    size_t states = 1;
+
+    if (add_child_row(set, 0) != 0) return 0;
+
+    for (size_t i = 0; i < set->count; i++) {
+        const unsigned char *p =
+            (const unsigned char *)arena_get(&set->text, set->offsets[i]);
+        uint32_t s = 0;
+
+        for (size_t j = 0; j < set->lengths[i]; j++) {
+            uint16_t c = set->byte_class[p[j]];
+            uint32_t t = trie_child(set, s, c);
+
+            if (t == 0) {
+                t = (uint32_t)states++;
+                set->label[t] = c;
+                set->sibling[t] = set->child[s];
+                set->child[s] = t;
+
+                if (set->row_of[s] != 0) {
+                    size_t row = set->row_of[s] - 1;
+                    set->rows[row * set->class_count + c] = t;
+                } else if (++children[s] == ROW_MIN_CHILDREN &&
+                           add_child_row(set, s) != 0) {
+                    return 0;
+                }
+            }
+            s = t;
+        }
+
+        set->accept[s] = 1;
+    }
+
+    return states;
+}
+
+/*
+ * Computes the failure links of the sparse trie breadth-first and
+ * marks states whose failure chain reaches an accepting state.
+ * Returns 0 on success, non-zero on OOM.
+ */
+static int build_fail_links(GrepSet *set, size_t states) {
+    uint32_t *queue = malloc(states * sizeof(uint32_t));
+    if (!queue) return -1;
+
+    size_t head = 0, tail = 0;
+
+    /* Children of the root fail to the root */
+    for (uint32_t t = set->child[0]; t != 0; t = set->sibling[t]) {
+        set->fail[t] = 0;
+        queue[tail++] = t;
+    }
+
+    while (head < tail) {
+        uint32_t s = queue[head++];
+
+        for (uint32_t t = set->child[s]; t != 0; t = set->sibling[t]) {
+            uint32_t f = set->fail[s];
+            uint32_t target;
+
+            while ((target = trie_child(set, f, set->label[t])) == 0 &&
+                   f != 0) {
+                f = set->fail[f];
+            }
+
+            set->fail[t] = target;
+            if (set->accept[target]) set->accept[t] = 1;
+            queue[tail++] = t;
+        }
+    }
+
+    free(queue);
+    return 0;
+}
+
+/*
+ * Frees the compiled automaton, keeping the patterns.
+ */
+static void free_automaton(GrepSet *set) {
+    free(set->next);
+    free(set->child);
+    free(set->sibling);
+    free(set->label);
+    free(set->fail);
+    free(set->row_of);
+    free(set->rows);
+    free(set->accept);
+    set->next = NULL;
+    set->child = NULL;
+    set->sibling = NULL;
+    set->label = NULL;
+    set->fail = NULL;
+    set->row_of = NULL;
+    set->rows = NULL;
+    set->row_count = 0;
+    set->row_capacity = 0;
+    set->accept = NULL;
+}
+
+/*
+ * Allocates and builds the sparse automaton for `states` states.
+ * Returns 0 on success, non-zero on OOM.
+ */
+static int compile_sparse(GrepSet *set, size_t states) {
+    set->child = calloc(states, sizeof(uint32_t));
+    set->sibling = calloc(states, sizeof(uint32_t));
+    set->label = calloc(states, sizeof(uint16_t));
+    set->fail = calloc(states, sizeof(uint32_t));
+    set->row_of = calloc(states, sizeof(uint32_t));
+    set->accept = calloc(states, 1);
+    uint8_t *children = calloc(states, 1);
+    if (!set->child || !set->sibling || !set->label || !set->fail ||
+        !set->row_of || !set->accept || !children) {
+        free(children);
+        return -1;
+    }
+
+    states = build_sparse_trie(set, children);
+    free(children);
+    if (states == 0) return -1;
+
+    return build_fail_links(set, states);
+}
+
+/*
+ * Matches with the sparse trie, following failure links on a miss.
+ */
+static int match_sparse(const GrepSet *set, const char *text, size_t len) {
+    const unsigned char *p = (const unsigned char *)text;
+    size_t i = 0;
+    uint32_t s = 0;
+
+    while (i < len) {
+        /* At the root only a start byte can lead anywhere: skip ahead */
+        if (s == 0) {
+            i = skip_to_start(set, text, len, i);
+            if (i == len) return 0;
+        }
+
+        uint16_t c = set->byte_class[p[i++]];
+        uint32_t t;
+        while ((t = trie_child(set, s, c)) == 0 && s != 0) s = set->fail[s];
+
+        s = t;
+        if (set->accept[s]) return 1;
+    }
+
+    return 0;
+}
+
+/* ---------- Public API ---------- */
+
+int grep_set_init(GrepSet *set) {
+    if (!set) return -1;
+
+    memset(set, 0, sizeof(*set));
+    return arena_init(&set->text, 0);
+}
+
+int grep_set_add(GrepSet *set, const char *pattern, size_t len) {
+    if (!set || !pattern || len == 0) return -1;
+
+    if (set->count >= set->capacity) {
+        size_t new_capacity = set->capacity ? set->capacity * 2 : 16;
+        size_t *offsets =
+            realloc(set->offsets, new_capacity * sizeof(size_t));
+        if (!offsets) return -1;
+        set->offsets = offsets;
+
+        size_t *lengths =
+            realloc(set->lengths, new_capacity * sizeof(size_t));
+        if (!lengths) return -1;
+        set->lengths = lengths;
+
+        set->capacity = new_capacity;
+    }
+
+    size_t offset = arena_append(&set->text, pattern, len);
+    if (offset == ARENA_NPOS) return -1;
+
+    set->offsets[set->count] = offset;
+    set->lengths[set->count] = len;
+    set->count++;
+    return 0;
+}
+
+int grep_set_add_file(GrepSet *set, const char *path) {
+    if (!set || !path) return -1;
+
+    FILE *file = fopen(path, "r");
+    if (!file) return -1;
+
+    char *line = NULL;
+    size_t capacity = 0;
+    ssize_t len;
+    int status = 0;
+
+    while ((len = getline(&line, &capacity, file)) >= 0) {
+        if (len > 0 && line[len - 1] == '\n') len--;
+        if (len > 0 && line[len - 1] == '\r') len--;
+        if (len == 0) continue;
+
+        if (grep_set_add(set, line, (size_t)len) != 0) {
+            status = -1;
+            break;
+        }
+    }
+
+    if (ferror(file)) status = -1;
+
+    free(line);
+    fclose(file);
+    return status;
+}
+
+int grep_set_compile(GrepSet *set) {
+    if (!set || set->count == 0) return -1;
+
+    size_t total = 0;
+    for (size_t i = 0; i < set->count; i++) total += set->lengths[i];
+
+    assign_classes(set);
+    free_automaton(set);
+
+    /* States are uint32_t; more pattern bytes than that cannot be indexed */
+    size_t states = total + 1;
+    if (total >= UINT32_MAX) return -1;
+
+    if (states > DFA_MAX_BYTES / sizeof(uint32_t) / set->class_count) {
+        return compile_sparse(set, states);
+    }
+
+    set->next = calloc(states * set->class_count, sizeof(uint32_t));
+    set->accept = calloc(states, 1);
+    if (!set->next || !set->accept) return -1;
+
+    states = build_trie(set);
+    return build_dfa(set, states);
+}
+
+int grep_set_match(const GrepSet *set, const char *text, size_t len) {
+    if (!set || !set->accept || !text) return 0;
+    if (!set->next) return match_sparse(set, text, len);
+
+    const unsigned char *p = (const unsigned char *)text;
+    size_t classes = set->class_count;
+    size_t i = 0;
+    uint32_t s = 0;
+
+    while (i < len) {
+        /* At the root only a start byte can lead anywhere: skip ahead */
+        if (s == 0) {
+            i = skip_to_start(set, text, len, i);
+            if (i == len) return 0;
+        }
+
+        s = set->next[(size_t)s * classes + set->byte_class[p[i++]]];
+        if (set->accept[s]) return 1;
+    }
+
+    return 0;
+}
+
+void grep_set_free(GrepSet *set) {
+    if (!set) return;
+
+    arena_free(&set->text);
+    free(set->offsets);
+    free(set->lengths);
+    free_automaton(set);
+    memset(set, 0, sizeof(*set));
+}
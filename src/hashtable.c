@@ -0,0 +1,168 @@
+#include "hashtable.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/* Grow once the table is 70% full */
+#define LOAD_NUM 7
+#define LOAD_DEN 10
+
+/* ---------- Hashing ---------- */
+
+static uint64_t mix64(uint64_t x) {
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ULL;
+    x ^= x >> 33;
+    return x;
+}
+
+/*
+ * Word-at-a-time multiply/rotate hash with a murmur-style finalizer.
+ */
+uint64_t hash_bytes(const void *data, size_t len) {
+    const unsigned char *p = data;
+    uint64_t h = 0x9e3779b97f4a7c15ULL ^ (uint64_t)len;
+
+    while (len >= 8) {
+        uint64_t w;
+        memcpy(&w, p, 8);
+        h ^= w * 0x87c37b91114253d5ULL;
+        h = (h << 31) | (h >> 33);
+        h *= 0x4cf5ad432745937fULL;
+        p += 8;
+        len -= 8;
+    }
+
+    uint64_t tail = 0;
+    for (size_t i = 0; i < len; i++) {
+        tail |= (uint64_t)p[i] << (8 * i);
+    }
+    h ^= tail * 0x87c37b91114253d5ULL;
+
+    return mix64(h);
+}
+
+/* ---------- Table ---------- */
+
+int hash_index_init(HashIndex *index, size_t capacity) {
+    if (!index) return -1;
+
+    size_t cap = 16;
+    while (cap < capacity) cap *= 2;
+
+    index->slots = calloc(cap, sizeof(HashSlot));
+    if (!index->slots) return -1;
+
+    index->capacity = cap;
+    index->count = 0;
+    index->lookups = 0;
+    index->probes = 0;
+    return 0;
+}
+
+HashSlot *hash_index_lookup(
+    HashIndex *index,
+    uint64_t hash,
+    HashMatchFn match,
+    const void *ctx
+) {
+    size_t mask = index->capacity - 1;
+    size_t i = (size_t)hash & mask;
+    size_t probes = 1;
+
+    index->lookups++;
+
+    for (;; probes++) {
+        HashSlot *slot = &index->slots[i];
+
+        if (slot->index == 0 ||
+            (slot->hash == hash && match(ctx, slot->index - 1))) {
+            index->probes += probes;
+            return slot;
+        }
+
+        i = (i + 1) & mask;
+    }
+}
+
+/*
+ * Doubles the table, re-placing slots by their stored hash.
+ */
+static int grow(HashIndex *index) {
+    size_t new_capacity = index->capacity * 2;
+    HashSlot *slots = calloc(new_capacity, sizeof(HashSlot));
+    if (!slots) return -1;
+
+    size_t mask = new_capacity - 1;
+    for (size_t i = 0; i < index->capacity; i++) {
+        HashSlot *old = &index->slots[i];
+        if (old->index == 0) continue;
+
+        size_t j = (size_t)old->hash & mask;
+        while (slots[j].index != 0) j = (j + 1) & mask;
+        slots[j] = *old;
+    }
+
+    free(index->slots);
+    index->slots = slots;
+    index->capacity = new_capacity;
+    return 0;
+}
+
+int hash_index_insert(
+    HashIndex *index,
+    HashSlot *slot,
+    uint64_t hash,
+    size_t entry_index
+) {
+    slot->hash = hash;
+    slot->index = entry_index + 1;
+    index->count++;
+
+    if (index->count * LOAD_DEN >= index->capacity * LOAD_NUM &&
+        grow(index) != 0 &&
+        index->count + 1 >= index->capacity) {
+        /* Keep one empty slot so probes always terminate */
+        slot->index = 0;
+        index->count--;
+        return -1;
+    }
+    return 0;
+}
+
+void hash_index_remove(HashIndex *index, HashSlot *slot) {
+    size_t mask = index->capacity - 1;
+    size_t hole = (size_t)(slot - index->slots);
+
+    /* Backward-shift deletion: pull later entries of the probe run into
+       the hole unless that would move them before their home slot */
+    for (size_t j = (hole + 1) & mask; index->slots[j].index != 0;
+         j = (j + 1) & mask) {
+        size_t home = (size_t)index->slots[j].hash & mask;
+        int stays = hole < j ? (home > hole && home <= j)
+                             : (home > hole || home <= j);
+        if (stays) continue;
+
+        index->slots[hole] = index->slots[j];
+        hole = j;
+    }
+
+    index->slots[hole].index = 0;
+    index->count--;
+}
+
+void hash_index_clear(HashIndex *index) {
+    memset(index->slots, 0, index->capacity * sizeof(HashSlot));
+    index->count = 0;
+}
+
+void hash_index_free(HashIndex *index) {
+    if (!index) return;
+
+    free(index->slots);
+    index->slots = NULL;
+    index->capacity = 0;
+    index->count = 0;
+}
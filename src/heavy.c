@@ -0,0 +1,383 @@
+#include "heavy.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+    const HeavyHitters *hh;
+    const char *message;
+    size_t len;
+} HeavyKey;
+
+/* ---------- Helpers ---------- */
+
+static int item_matches(const void *ctx, size_t index) {
+    const HeavyKey *key = ctx;
+    const HeavyItem *item = &key->hh->items[index];
+
+    return item->message_len == key->len &&
+           memcmp(item->message, key->message, key->len) == 0;
+}
+
+static HashSlot *find_slot(
+    HeavyHitters *hh,
+    const char *message,
+    size_t len,
+    uint64_t *hash
+) {
+    HeavyKey key = { hh, message, len };
+
+    *hash = hash_bytes(message, len);
+    return hash_index_lookup(&hh->index, *hash, item_matches, &key);
+}
+
+/*
+ * Ensures an owned buffer holds at least `needed` bytes, keeping its
+ * contents. Returns 0 on success, non-zero on OOM.
+ */
+static int reserve(char **buf, size_t *capacity, size_t needed) {
+    if (needed <= *capacity) return 0;
+
+    char *grown = realloc(*buf, needed);
+    if (!grown) return -1;
+
+    *buf = grown;
+    *capacity = needed;
+    return 0;
+}
+
+/* Copies text into a buffer already reserved for it */
+static void set_text(char *buf, size_t *len, const char *text, size_t n) {
+    memcpy(buf, text, n);
+    buf[n] = '\0';
+    *len = n;
+}
+
+/*
+ * Heap order: smaller count first; among equal counts the newest item
+ * is evicted first, so long-monitored items are kept.
+ */
+static int heap_before(const HeavyHitters *hh, size_t a, size_t b) {
+    const HeavyItem *x = &hh->items[a];
+    const HeavyItem *y = &hh->items[b];
+
+    return x->count < y->count || (x->count == y->count && x->seq > y->seq);
+}
+
+static void heap_swap(HeavyHitters *hh, size_t i, size_t j) {
+    size_t t = hh->heap[i];
+    hh->heap[i] = hh->heap[j];
+    hh->heap[j] = t;
+
+    hh->items[hh->heap[i]].heap_pos = i;
+    hh->items[hh->heap[j]].heap_pos = j;
+}
+
+static void sift_up(HeavyHitters *hh, size_t i) {
+    while (i > 0) {
+        size_t parent = (i - 1) / 2;
+        if (!heap_before(hh, hh->heap[i], hh->heap[parent])) break;
+
+        heap_swap(hh, i, parent);
+        i = parent;
+    }
+}
+
+static void sift_down(HeavyHitters *hh, size_t i) {
+    for (;;) {
+        size_t smallest = i;
+        size_t left = 2 * i + 1;
+        size_t right = left + 1;
+
+        if (left < hh->size &&
+            heap_before(hh, hh->heap[left], hh->heap[smallest])) {
+            smallest = left;
+        }
+        if (right < hh->size &&
+            heap_before(hh, hh->heap[right], hh->heap[smallest])) {
+            smallest = right;
+        }
+        if (smallest == i) return;
+
+        heap_swap(hh, i, smallest);
+        i = smallest;
+    }
+}
+
+/*
+ * Ranking used for reporting: higher count first, then smaller error,
+ * then earlier entry.
+ */
+static int compare_rank(const void *a, const void *b) {
+    const HeavyItem *x = *(const HeavyItem *const *)a;
+    const HeavyItem *y = *(const HeavyItem *const *)b;
+
+    if (x->count != y->count) return x->count > y->count ? -1 : 1;
+    if (x->error != y->error) return x->error < y->error ? -1 : 1;
+    return (x->seq > y->seq) - (x->seq < y->seq);
+}
+
+static int compare_items_rank(const void *a, const void *b) {
+    const HeavyItem *x = a;
+    const HeavyItem *y = b;
+
+    return compare_rank(&x, &y);
+}
+
+static int compare_seq(const void *a, const void *b) {
+    const HeavyItem *x = *(const HeavyItem *const *)a;
+    const HeavyItem *y = *(const HeavyItem *const *)b;
+
+    return (x->seq > y->seq) - (x->seq < y->seq);
+}
+
+/*
+ * Rebuilds the hash index and the heap from the item array.
+ */
+static void rebuild(HeavyHitters *hh) {
+    hash_index_clear(&hh->index);
+
+    for (size_t i = 0; i < hh->size; i++) {
+        HeavyItem *item = &hh->items[i];
+        uint64_t hash;
+        HashSlot *slot = find_slot(hh, item->message, item->message_len,
+                                   &hash);
+
+        /* Never grows: the table is sized for twice the capacity */
+        hash_index_insert(&hh->index, slot, hash, i);
+
+        hh->heap[i] = i;
+        item->heap_pos = i;
+    }
+
+    for (size_t i = hh->size / 2; i-- > 0;) sift_down(hh, i);
+}
+
+/* ---------- Public API ---------- */
+
+int heavy_init(HeavyHitters *hh, size_t capacity) {
+    if (!hh) return -1;
+
+    memset(hh, 0, sizeof(*hh));
+    if (capacity == 0) return -1;
+
+    hh->items = calloc(capacity, sizeof(HeavyItem));
+    hh->heap = malloc(capacity * sizeof(size_t));
+
+    if (!hh->items || !hh->heap ||
+        hash_index_init(&hh->index, capacity * 2) != 0) {
+        heavy_free(hh);
+        return -1;
+    }
+
+    hh->capacity = capacity;
+    return 0;
+}
+
+int heavy_add(
+    HeavyHitters *hh,
+    const char *message,
+    size_t len,
+    const char *example,
+    size_t example_len,
+    size_t count,
+    size_t error
+) {
+    if (!hh || !message) return -1;
+
+    uint64_t hash;
+    HashSlot *slot = find_slot(hh, message, len, &hash);
+
+    if (slot->index != 0) {
+        HeavyItem *item = &hh->items[slot->index - 1];
+        item->count += count;
+        item->error += error;
+        hh->total += count;
+
+        sift_down(hh, item->heap_pos);
+        return 0;
+    }
+
+    int full = hh->size == hh->capacity;
+    size_t i = full ? hh->heap[0] : hh->size;
+    HeavyItem *item = &hh->items[i];
+
+    /* Allocate first so that OOM leaves the summary unchanged */
+    if (reserve(&item->message, &item->message_capacity, len + 1) != 0 ||
+        (example && reserve(&item->example, &item->example_capacity,
+                            example_len + 1) != 0)) {
+        return -1;
+    }
+
+    size_t evicted = 0;
+    if (full) {
+        /* The newcomer may have been counted under the evicted item */
+        uint64_t old_hash;
+        hash_index_remove(&hh->index,
+                          find_slot(hh, item->message, item->message_len,
+                                    &old_hash));
+        slot = find_slot(hh, message, len, &hash);
+        evicted = item->count;
+    } else {
+        hh->heap[i] = i;
+        item->heap_pos = i;
+        hh->size++;
+    }
+
+    set_text(item->message, &item->message_len, message, len);
+    if (example) {
+        set_text(item->example, &item->example_len, example, example_len);
+    } else {
+        item->example_len = 0;
+        if (item->example) item->example[0] = '\0';
+    }
+
+    item->count = evicted + count;
+    item->error = evicted + error;
+    item->seq = hh->next_seq++;
+    hh->total += count;
+
+    hash_index_insert(&hh->index, slot, hash, i);
+
+    if (full) {
+        sift_down(hh, item->heap_pos);
+    } else {
+        sift_up(hh, item->heap_pos);
+    }
+    return 0;
+}
+
+int heavy_merge(HeavyHitters *dst, const HeavyHitters *src) {
+    if (!dst || !src) return -1;
+    if (src->size == 0) {
+        dst->total += src->total;
+        return 0;
+    }
+
+    /*
+     * A message missing from a full summary occurred at most as often
+     * as that summary's smallest count; add that bound (to count and
+     * error) for every message the other side did not monitor.
+     */
+    size_t min_dst = dst->size == dst->capacity && dst->size > 0
+                         ? dst->items[dst->heap[0]].count
+                         : 0;
+    size_t min_src = src->size == src->capacity
+                         ? src->items[src->heap[0]].count
+                         : 0;
+
+    /* Make room for every candidate; trimmed back to capacity below */
+    size_t length = dst->capacity;
+    size_t needed = dst->size + src->size;
+
+    const HeavyItem **order = malloc(src->size * sizeof(*order));
+    if (!order) return -1;
+
+    if (needed > length) {
+        HeavyItem *items = realloc(dst->items, needed * sizeof(HeavyItem));
+        if (!items) {
+            free(order);
+            return -1;
+        }
+
+        memset(items + length, 0, (needed - length) * sizeof(HeavyItem));
+        dst->items = items;
+        length = needed;
+    }
+
+    for (size_t i = 0; i < dst->size; i++) {
+        dst->items[i].count += min_src;
+        dst->items[i].error += min_src;
+    }
+
+    /* Visit src in entry order so new items keep a stable order */
+    for (size_t i = 0; i < src->size; i++) order[i] = &src->items[i];
+    qsort(order, src->size, sizeof(*order), compare_seq);
+
+    int status = 0;
+    for (size_t i = 0; i < src->size; i++) {
+        const HeavyItem *s = order[i];
+        uint64_t hash;
+        HashSlot *slot = find_slot(dst, s->message, s->message_len, &hash);
+
+        if (slot->index != 0) {
+            HeavyItem *d = &dst->items[slot->index - 1];
+            d->count = d->count - min_src + s->count;
+            d->error = d->error - min_src + s->error;
+            continue;
+        }
+
+        HeavyItem *d = &dst->items[dst->size];
+        if (reserve(&d->message, &d->message_capacity,
+                    s->message_len + 1) != 0 ||
+            (s->example && reserve(&d->example, &d->example_capacity,
+                                   s->example_len + 1) != 0)) {
+            status = -1;
+            break;
+        }
+
+        set_text(d->message, &d->message_len, s->message, s->message_len);
+        if (s->example) {
+            set_text(d->example, &d->example_len, s->example,
+                     s->example_len);
+        }
+        d->count = s->count + min_dst;
+        d->error = s->error + min_dst;
+        d->seq = dst->next_seq++;
+        dst->size++;
+    }
+    free(order);
+
+    dst->total += src->total;
+
+    /* Keep the `capacity` highest counts */
+    if (dst->size > dst->capacity) {
+        qsort(dst->items, dst->size, sizeof(HeavyItem), compare_items_rank);
+        dst->size = dst->capacity;
+    }
+
+    if (length > dst->capacity) {
+        for (size_t i = dst->capacity; i < length; i++) {
+            free(dst->items[i].message);
+            free(dst->items[i].example);
+        }
+
+        HeavyItem *items =
+            realloc(dst->items, dst->capacity * sizeof(HeavyItem));
+        if (items) dst->items = items;
+    }
+
+    rebuild(dst);
+    return status;
+}
+
+size_t heavy_top(const HeavyHitters *hh, size_t n, const HeavyItem **out) {
+    if (!hh || !out || n == 0 || hh->size == 0) return 0;
+
+    const HeavyItem **all = malloc(hh->size * sizeof(*all));
+    if (!all) return 0;
+
+    for (size_t i = 0; i < hh->size; i++) all[i] = &hh->items[i];
+    qsort(all, hh->size, sizeof(*all), compare_rank);
+
+    if (n > hh->size) n = hh->size;
+    memcpy(out, all, n * sizeof(*out));
+
+    free(all);
+    return n;
+}
+
+void heavy_free(HeavyHitters *hh) {
+    if (!hh) return;
+
+    /* Buffers past `size` can be left over from a failed insert */
+    for (size_t i = 0; hh->items && i < hh->capacity; i++) {
+        free(hh->items[i].message);
+        free(hh->items[i].example);
+    }
+
+    free(hh->items);
+    free(hh->heap);
+    hash_index_free(&hh->index);
+    memset(hh, 0, sizeof(*hh));
+}
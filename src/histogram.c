@@ -0,0 +1,185 @@
+#include "histogram.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define SUB_BUCKETS ((size_t)1 << HISTOGRAM_SUB_BITS)
+
+/* Values are stored as integer thousandths, capped well below 2^64 */
+#define SCALE     1000.0
+#define MAX_UNITS ((uint64_t)1 << 62)
+
+/* ---------- Helpers ---------- */
+
+static unsigned highest_bit(uint64_t v) {
+    unsigned bit = 0;
+
+    if (v >> 32) { v >>= 32; bit += 32; }
+    if (v >> 16) { v >>= 16; bit += 16; }
+    if (v >> 8)  { v >>= 8;  bit += 8; }
+    if (v >> 4)  { v >>= 4;  bit += 4; }
+    if (v >> 2)  { v >>= 2;  bit += 2; }
+    if (v >> 1)  { bit += 1; }
+    return bit;
+}
+
+/*
+ * Maps a value to its counter: values below 2 * SUB_BUCKETS get one
+ * counter each, then every power of two gets SUB_BUCKETS counters.
+ */
+static size_t value_index(uint64_t v) {
+    if (v < 2 * SUB_BUCKETS) return (size_t)v;
+
+    unsigned shift = highest_bit(v) - HISTOGRAM_SUB_BITS;
+    size_t octave = shift - 1;
+    size_t sub = (size_t)(v >> shift) - SUB_BUCKETS;
+
+    return 2 * SUB_BUCKETS + octave * SUB_BUCKETS + sub;
+}
+
+/*
+ * Returns the middle of the value range counted by counter `index`.
+ */
+static double index_value(size_t index) {
+    if (index < 2 * SUB_BUCKETS) return (double)index;
+
+    size_t k = index - 2 * SUB_BUCKETS;
+    unsigned shift = (unsigned)(k / SUB_BUCKETS) + 1;
+    uint64_t low = (uint64_t)(SUB_BUCKETS + k % SUB_BUCKETS) << shift;
+    uint64_t width = (uint64_t)1 << shift;
+
+    return (double)low + (double)(width - 1) / 2.0;
+}
+
+/*
+ * Makes counters [low, high) available, growing by whole powers of two
+ * at either end.
+ */
+static int ensure_range(Histogram *hist, size_t low, size_t high) {
+    size_t end = hist->base + hist->length;
+
+    if (hist->counts && low >= hist->base && high <= end) return 0;
+    if (hist->counts) {
+        if (hist->base < low) low = hist->base;
+        if (end > high) high = end;
+    }
+
+    low = low / SUB_BUCKETS * SUB_BUCKETS;
+    high = (high + SUB_BUCKETS - 1) / SUB_BUCKETS * SUB_BUCKETS;
+
+    size_t length = high - low;
+    size_t *counts = realloc(hist->counts, length * sizeof(size_t));
+    if (!counts) return -1;
+
+    /* Slide the existing counters up to their place in the new range */
+    size_t offset = hist->counts ? hist->base - low : 0;
+    if (hist->length > 0 && offset > 0) {
+        memmove(counts + offset, counts, hist->length * sizeof(size_t));
+    }
+    memset(counts, 0, offset * sizeof(size_t));
+    memset(counts + offset + hist->length, 0,
+           (length - offset - hist->length) * sizeof(size_t));
+
+    hist->counts = counts;
+    hist->base = low;
+    hist->length = length;
+    return 0;
+}
+
+/* ---------- Public API ---------- */
+
+void histogram_init(Histogram *hist) {
+    if (!hist) return;
+
+    memset(hist, 0, sizeof(*hist));
+}
+
+int histogram_add(Histogram *hist, double value) {
+    if (!hist) return -1;
+    if (!(value > 0)) value = 0;  // also catches NaN
+    if (value > (double)MAX_UNITS / SCALE) value = (double)MAX_UNITS / SCALE;
+
+    size_t index = value_index((uint64_t)(value * SCALE + 0.5));
+
+    if (ensure_range(hist, index, index + 1) != 0) return -1;
+    hist->counts[index - hist->base]++;
+
+    if (hist->total == 0 || value < hist->min) hist->min = value;
+    if (hist->total == 0 || value > hist->max) hist->max = value;
+    hist->sum += value;
+    hist->total++;
+    return 0;
+}
+
+int histogram_merge(Histogram *dst, const Histogram *src) {
+    if (!dst || !src) return -1;
+    if (src->total == 0) return 0;
+    if (ensure_range(dst, src->base, src->base + src->length) != 0) {
+        return -1;
+    }
+
+    size_t *counts = dst->counts + (src->base - dst->base);
+    for (size_t i = 0; i < src->length; i++) {
+        counts[i] += src->counts[i];
+    }
+
+    if (dst->total == 0 || src->min < dst->min) dst->min = src->min;
+    if (dst->total == 0 || src->max > dst->max) dst->max = src->max;
+    dst->sum += src->sum;
+    dst->total += src->total;
+    return 0;
+}
+
+double histogram_quantile(const Histogram *hist, double q) {
+    double value = 0;
+
+    histogram_quantiles(hist, &q, 1, &value);
+    return value;
+}
+
+void histogram_quantiles(
+    const Histogram *hist,
+    const double *qs,
+    size_t count,
+    double *out
+) {
+    if (!qs || !out) return;
+
+    size_t seen = 0;
+    size_t i = 0;
+
+    for (size_t k = 0; k < count; k++) {
+        if (!hist || hist->total == 0) {
+            out[k] = 0;
+            continue;
+        }
+
+        double q = qs[k] < 0 ? 0 : qs[k] > 1 ? 1 : qs[k];
+
+        /* Nearest rank: the smallest value with at least q of all at or below */
+        size_t rank = (size_t)(q * (double)hist->total);
+        if ((double)rank < q * (double)hist->total) rank++;
+        if (rank == 0) rank = 1;
+
+        /* Resume where the previous (smaller) quantile stopped */
+        double value = hist->max;
+        for (; i < hist->length; i++) {
+            if (seen + hist->counts[i] >= rank) {
+                value = index_value(hist->base + i) / SCALE;
+                break;
+            }
+            seen += hist->counts[i];
+        }
+
+        if (value < hist->min) value = hist->min;
+        if (value > hist->max) value = hist->max;
+        out[k] = value;
+    }
+}
+
+void histogram_free(Histogram *hist) {
+    if (!hist) return;
+
+    free(hist->counts);
+    histogram_init(hist);
+}
@@ -0,0 +1,87 @@
+#include "hll.h"
+
+#include <math.h>
+#include <stdlib.h>
+
+/* ---------- Helpers ---------- */
+
+static int ensure_registers(HyperLogLog *hll) {
+    if (hll->registers) return 0;
+
+    hll->registers = calloc((size_t)1 << hll->precision, 1);
+    return hll->registers ? 0 : -1;
+}
+
+/* ---------- Public API ---------- */
+
+void hll_init(HyperLogLog *hll, unsigned precision) {
+    if (!hll) return;
+
+    if (precision < 4) precision = 4;
+    if (precision > 18) precision = 18;
+
+    hll->registers = NULL;
+    hll->precision = precision;
+}
+
+int hll_add(HyperLogLog *hll, uint64_t hash) {
+    if (!hll || ensure_registers(hll) != 0) return -1;
+
+    /* Top bits pick the register, the rest give the rank */
+    unsigned p = hll->precision;
+    size_t index = (size_t)(hash >> (64 - p));
+    uint64_t rest = hash << p;
+
+    uint8_t rank = 1;
+    while (rank <= 64 - p && !(rest & 0x8000000000000000ULL)) {
+        rest <<= 1;
+        rank++;
+    }
+
+    if (rank > hll->registers[index]) hll->registers[index] = rank;
+    return 0;
+}
+
+int hll_merge(HyperLogLog *dst, const HyperLogLog *src) {
+    if (!dst || !src || dst->precision != src->precision) return -1;
+    if (!src->registers) return 0;
+    if (ensure_registers(dst) != 0) return -1;
+
+    size_t m = (size_t)1 << dst->precision;
+    for (size_t i = 0; i < m; i++) {
+        if (src->registers[i] > dst->registers[i]) {
+            dst->registers[i] = src->registers[i];
+        }
+    }
+    return 0;
+}
+
+uint64_t hll_estimate(const HyperLogLog *hll) {
+    if (!hll || !hll->registers) return 0;
+
+    size_t m = (size_t)1 << hll->precision;
+    double sum = 0.0;
+    size_t zeros = 0;
+
+    for (size_t i = 0; i < m; i++) {
+        sum += ldexp(1.0, -(int)hll->registers[i]);
+        if (hll->registers[i] == 0) zeros++;
+    }
+
+    double alpha = 0.7213 / (1.0 + 1.079 / (double)m);
+    double estimate = alpha * (double)m * (double)m / sum;
+
+    /* Small range: linear counting is more accurate */
+    if (estimate <= 2.5 * (double)m && zeros > 0) {
+        estimate = (double)m * log((double)m / (double)zeros);
+    }
+
+    return (uint64_t)(estimate + 0.5);
+}
+
+void hll_free(HyperLogLog *hll) {
+    if (!hll) return;
+
+    free(hll->registers);
+    hll->registers = NULL;
+}
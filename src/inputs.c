@@ -0,0 +1,156 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "inputs.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dirent.h>
+#include <glob.h>
+#include <sys/stat.h>
+
+/* ---------- Helpers ---------- */
+
+static int push_path(InputList *list, const char *path) {
+    if (list->count >= list->capacity) {
+        size_t new_capacity = list->capacity ? list->capacity * 2 : 16;
+        char **new_paths =
+            realloc(list->paths, new_capacity * sizeof(char *));
+        if (!new_paths) return -1;
+
+        list->paths = new_paths;
+        list->capacity = new_capacity;
+    }
+
+    size_t len = strlen(path);
+    char *copy = malloc(len + 1);
+    if (!copy) return -1;
+    memcpy(copy, path, len + 1);
+
+    list->paths[list->count++] = copy;
+    return 0;
+}
+
+static int compare_paths(const void *a, const void *b) {
+    return strcmp(*(char *const *)a, *(char *const *)b);
+}
+
+/*
+ * Appends the regular files of `dir`, sorted by name.
+ */
+static int add_directory(InputList *list, const char *dir) {
+    DIR *d = opendir(dir);
+    if (!d) {
+        fprintf(stderr, "Error: Could not open directory '%s'\n", dir);
+        return -1;
+    }
+
+    size_t first = list->count;
+    size_t dir_len = strlen(dir);
+    int status = 0;
+    struct dirent *ent;
+
+    while (status == 0 && (ent = readdir(d)) != NULL) {
+        if (ent->d_name[0] == '.') continue;
+
+        size_t name_len = strlen(ent->d_name);
+        char *path = malloc(dir_len + name_len + 2);
+        if (!path) {
+            status = -1;
+            break;
+        }
+
+        memcpy(path, dir, dir_len);
+        size_t pos = dir_len;
+        if (pos == 0 || path[pos - 1] != '/') path[pos++] = '/';
+        memcpy(path + pos, ent->d_name, name_len + 1);
+
+        struct stat st;
+        if (stat(path, &st) == 0 && S_ISREG(st.st_mode)) {
+            status = push_path(list, path);
+        }
+        free(path);
+    }
+
+    closedir(d);
+
+    qsort(list->paths + first, list->count - first,
+          sizeof(char *), compare_paths);
+
+    return status;
+}
+
+/*
+ * Adds one path, expanding it if it is a directory.
+ */
+static int add_path(InputList *list, const char *path) {
+    struct stat st;
+
+    if (stat(path, &st) == 0 && S_ISDIR(st.st_mode)) {
+        return add_directory(list, path);
+    }
+    return push_path(list, path);
+}
+
+static int add_glob(InputList *list, const char *pattern) {
+    glob_t g;
+    int rc = glob(pattern, 0, NULL, &g);
+
+    if (rc == GLOB_NOMATCH) {
+        fprintf(stderr, "Error: No files match '%s'\n", pattern);
+        return -1;
+    }
+    if (rc != 0) {
+        fprintf(stderr, "Error: Could not expand '%s'\n", pattern);
+        return -1;
+    }
+
+    int status = 0;
+    for (size_t i = 0; status == 0 && i < g.gl_pathc; i++) {
+        status = add_path(list, g.gl_pathv[i]);
+    }
+
+    globfree(&g);
+    return status;
+}
+
+/* ---------- Public API ---------- */
+
+int expand_inputs(const char *const *args, size_t count, InputList *out) {
+    if (!args || !out) return -1;
+
+    out->paths = NULL;
+    out->count = 0;
+    out->capacity = 0;
+
+    for (size_t i = 0; i < count; i++) {
+        struct stat st;
+        int status;
+
+        if (stat(args[i], &st) != 0 && strpbrk(args[i], "*?[") != NULL) {
+            status = add_glob(out, args[i]);
+        } else {
+            status = add_path(out, args[i]);
+        }
+
+        if (status != 0) {
+            input_list_free(out);
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+void input_list_free(InputList *list) {
+    if (!list) return;
+
+    for (size_t i = 0; i < list->count; i++) {
+        free(list->paths[i]);
+    }
+    free(list->paths);
+
+    list->paths = NULL;
+    list->count = 0;
+    list->capacity = 0;
+}
@@ -1,83 +1,746 @@
+#define _POSIX_C_SOURCE 200809L
+
 #include <stdio.h>
 #include <stdlib.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 #include "cli.h"
+#include "columnar.h"
 #include "utils.h"
 #include "parser.h"
 #include "aggregator.h"
+#include "parallel.h"
+#include "pipeline.h"
+#include "follow.h"
+#include "inputs.h"
 #include "report.h"
+#include "serve.h"
+#include "sink.h"
+#include "state.h"
+#include "stats.h"
+#include "timerange.h"
 
-int main(int argc, char *argv[]) {
-    CliOptions options;
+#define PROGRESS_INTERVAL 10000
 
-    /* Parse CLI */
-    CliResult cli_result = parse_cli(argc, argv, &options);
-    if (cli_result == CLI_EXIT) return 0;
-    if (cli_result == CLI_ERROR) return 1;
+/*
+ * Shows the running line count on stderr when both streams are a
+ * terminal, where the final "Done!" line on stdout overwrites it. The
+ * count stays out of stdout so the report is the same whichever path
+ * produced it: the threaded ones have no per-line progress to show.
+ */
+static void show_progress(size_t lines) {
+    if (isatty(STDOUT_FILENO) && isatty(STDERR_FILENO)) {
+        fprintf(stderr, "\rProcessed %zu lines...", lines);
+    }
+}
 
-    /* Open log file */
-    FileReader *reader = file_reader_open(options.filename);
-    if (!reader) {
-        fprintf(stderr, "Error: Could not open file '%s'\n",
-                options.filename);
-        return 1;
+/*
+ * Analyzes `len` bytes of complete lines, in parallel chunks or
+ * through the I/O pipeline if requested. Only the final line count is
+ * printed, as there is no per-line progress to show.
+ * Stage times go to `times` if non-NULL.
+ * Returns 0 on success, non-zero on failure.
+ */
+static int analyze_region(
+    const CliOptions *options,
+    AnalysisResult *result,
+    const char *data,
+    size_t len,
+    size_t *processed,
+    StageTimes *times
+) {
+    if (options->pipeline) {
+        size_t workers = options->threads ? options->threads : 1;
+        if (analyze_pipeline(result, NULL, data, len, workers,
+                             &options->filter, processed, times) != 0) {
+            fprintf(stderr, "Error: Pipelined analysis failed\n");
+            return 1;
+        }
+    } else if (options->threads > 1) {
+        if (analyze_parallel(result, data, len, options->threads,
+                             &options->filter, processed, times) != 0) {
+            fprintf(stderr, "Error: Parallel analysis failed\n");
+            return 1;
+        }
+    } else {
+        LogParser parser;
+        log_parser_init(&parser, &options->filter);
+        *processed = analyze_buffer_timed(result, &parser, data, len, times);
     }
 
-    /* Initialize analyzer */
-    AnalysisResult *result = init_analyzer(options.group_by);
-    if (!result) {
+    return 0;
+}
+
+/*
+ * Aggregates a mapped columnar file (see --convert) into result.
+ * Returns 0 on success, non-zero on failure (an error has been printed).
+ */
+static int analyze_converted(
+    const CliOptions *options,
+    const char *filename,
+    AnalysisResult *result,
+    const char *data,
+    size_t len,
+    size_t *processed,
+    StageTimes *times
+) {
+    int status = analyze_columnar(result, data, len, &options->filter,
+                                  processed, times);
+    if (status > 0) {
+        fprintf(stderr, "Error: '%s' is not a valid columnar file\n",
+                filename);
+    } else if (status < 0) {
         fprintf(stderr, "Error: Memory allocation failed\n");
-        file_reader_close(reader);
+    }
+
+    return status != 0;
+}
+
+/*
+ * Reads the whole file into result, printing progress.
+ * Stage times go to `times` if non-NULL.
+ * Returns 0 on success, non-zero on failure.
+ */
+static int analyze_file(
+    const CliOptions *options,
+    const char *filename,
+    AnalysisResult *result,
+    size_t *processed,
+    StageTimes *times
+) {
+    double start = times ? stats_clock() : 0;
+
+    FileReader *reader = file_reader_open(filename);
+    if (!reader) {
+        fprintf(stderr, "Error: Could not open file '%s'\n", filename);
         return 1;
     }
 
-    printf("Analyzing log file: %s\n", options.filename);
+    printf("Analyzing log file: %s\n", filename);
     printf("Press Ctrl+C to abort...\n\n");
 
-    /* Process file line by line */
-    char *line;
-    LogEntry entry;
     size_t processed_lines = 0;
+    const char *data;
+    size_t data_len;
+
+    if ((data = file_reader_mapping(reader, &data_len)) != NULL &&
+        columnar_detect(data, data_len)) {
+
+        /* Converted with --convert: read only the columns needed */
+        if (times) times->seconds[STAGE_READ] += stats_clock() - start;
+
+        if (analyze_converted(options, filename, result, data, data_len,
+                              &processed_lines, times) != 0) {
+            file_reader_close(reader);
+            return 1;
+        }
+
+    } else if ((options->threads > 1 || options->pipeline ||
+                line_filter_has_range(&options->filter) || times) &&
+               (data = file_reader_mapping(reader, &data_len)) != NULL) {
+
+        /* Binary-search a time range, then process chunks in parallel */
+        narrow_to_time_window(reader, &options->filter, &data, &data_len);
+        if (times) times->seconds[STAGE_READ] += stats_clock() - start;
+
+        if (analyze_region(options, result, data, data_len,
+                           &processed_lines, times) != 0) {
+            file_reader_close(reader);
+            return 1;
+        }
+
+    } else if (options->threads > 1 || options->pipeline) {
+
+        /* Streamed input: overlap reading with parse threads */
+        size_t workers = options->threads ? options->threads : 1;
+        if (times) times->seconds[STAGE_READ] += stats_clock() - start;
+
+        if (analyze_pipeline(result, reader, NULL, 0, workers,
+                             &options->filter, &processed_lines,
+                             times) != 0) {
+            fprintf(stderr, "Error: Pipelined analysis failed\n");
+            file_reader_close(reader);
+            return 1;
+        }
+
+    } else if (times) {
+
+        /* Time the stages over batches of lines */
+        LogParser parser;
+        log_parser_init(&parser, &options->filter);
+        times->seconds[STAGE_READ] += stats_clock() - start;
+
+        if (analyze_reader_timed(result, &parser, reader, times,
+                                 &processed_lines) != 0) {
+            fprintf(stderr, "Error: Memory allocation failed\n");
+            file_reader_close(reader);
+            return 1;
+        }
+
+    } else {
+
+        /* Process file line by line */
+        const char *line;
+        size_t line_len;
+        LogParser parser;
+        LogEntry entry;
+
+        log_parser_init(&parser, &options->filter);
+
+        while ((line = file_reader_read_line(reader, &line_len)) != NULL) {
+            ParseStatus parsed =
+                parse_log_line(&parser, line, line_len, &entry);
+            if (parsed != PARSE_OK) {
+                record_rejected_line(result, parsed);
+                continue;
+            }
 
-    while ((line = file_reader_read_line(reader)) != NULL) {
-        if (parse_log_line(line, &entry) == 0) {
             process_log_line(result, &entry);
             processed_lines++;
 
             /* Progress indicator */
-            if (processed_lines % 10000 == 0) {
-                printf("\rProcessed %zu lines...", processed_lines);
-                fflush(stdout);
+            if (processed_lines % PROGRESS_INTERVAL == 0) {
+                show_progress(processed_lines);
             }
         }
     }
 
+    if (file_reader_failed(reader)) {
+        fprintf(stderr, "\nError: Could not read '%s' to the end\n",
+                filename);
+        file_reader_close(reader);
+        return 1;
+    }
+
     printf("\rProcessed %zu lines... Done!\n\n", processed_lines);
 
-    /* Generate report */
-    if (options.output_format == OUTPUT_TEXT) {
-        print_summary(result, options.errors_only);
+    file_reader_close(reader);
+    *processed = processed_lines;
+    return 0;
+}
+
+/*
+ * Analyzes a file incrementally against the --state snapshot: restores
+ * the saved result when the file still starts with the snapshotted
+ * content, analyzes only the bytes appended since, and saves a new
+ * snapshot covering every complete line.
+ * Stage times go to `times` if non-NULL.
+ * Returns 0 on success, non-zero on failure.
+ */
+static int analyze_incremental(
+    const CliOptions *options,
+    const char *filename,
+    AnalysisResult *result,
+    size_t *processed,
+    StageTimes *times
+) {
+    double start = times ? stats_clock() : 0;
+
+    FileReader *reader = file_reader_open(filename);
+    if (!reader) {
+        fprintf(stderr, "Error: Could not open file '%s'\n", filename);
+        return 1;
+    }
+
+    struct stat st;
+    size_t len = 0;
+    const char *data = file_reader_mapping(reader, &len);
+
+    if (fstat(reader->fd, &st) != 0 || !S_ISREG(st.st_mode) ||
+        (!data && (reader->decomp || st.st_size > 0))) {
+        fprintf(stderr, "Error: --state requires an uncompressed "
+                        "regular file\n");
+        file_reader_close(reader);
+        return 1;
+    }
+    if (!data) data = "";  // empty file
+
+    if (columnar_detect(data, len)) {
+        fprintf(stderr, "Error: --state cannot resume a columnar file\n");
+        file_reader_close(reader);
+        return 1;
+    }
 
-        if (!options.errors_only || result->error_total > 0) {
-            print_top_errors(result, options.top_n);
+    printf("Analyzing log file: %s\n", filename);
+    printf("Press Ctrl+C to abort...\n\n");
+
+    StateSnapshot snapshot;
+    size_t offset = 0;
+
+    int loaded = state_read(options->state_path, &snapshot);
+    if (loaded < 0) {
+        file_reader_close(reader);
+        return 1;
+    }
+
+    if (loaded == 2) {
+        printf("State was saved by an older version; "
+               "analyzing from the start\n\n");
+    } else if (loaded == 0) {
+        if (snapshot.group_by != options->group_by) {
+            printf("State was saved with a different --group-by; "
+                   "analyzing from the start\n\n");
+        } else if (!state_checkpoint_matches(&snapshot.checkpoint,
+                                             st.st_dev, st.st_ino,
+                                             data, len)) {
+            printf("Log file was rotated or rewritten since the last run; "
+                   "analyzing from the start\n\n");
+        } else if (state_restore(&snapshot, result) != 0) {
+            fprintf(stderr, "Error: Could not restore state from '%s'\n",
+                    options->state_path);
+            state_snapshot_free(&snapshot);
+            file_reader_close(reader);
+            return 1;
+        } else {
+            offset = (size_t)snapshot.checkpoint.offset;
+            printf("Resuming at byte %zu (%zu lines already analyzed)\n\n",
+                   offset, result->total_lines);
         }
+        state_snapshot_free(&snapshot);
+    }
 
-        print_time_buckets_text(result);
+    if (times) times->seconds[STAGE_READ] += stats_clock() - start;
 
-    } else if (options.output_format == OUTPUT_JSON) {
-        print_report_json(result,
-                          options.errors_only,
-                          options.top_n);
+    /* Only complete lines are checkpointed; a partial tail is re-read */
+    size_t end = len;
+    while (end > offset && data[end - 1] != '\n') end--;
 
-    } else if (options.output_format == OUTPUT_CSV) {
-        print_report_csv(result,
-                         options.errors_only,
-                         options.top_n);
+    size_t processed_lines = 0;
+    int status = analyze_region(options, result, data + offset,
+                                end - offset, &processed_lines, times);
+
+    StateCheckpoint checkpoint;
+    state_checkpoint_init(&checkpoint, st.st_dev, st.st_ino, data, end);
+    if (status == 0) {
+        status = state_write(options->state_path, result, &checkpoint);
+    }
+
+    if (status == 0 && end < len) {
+        LogParser parser;
+        log_parser_init(&parser, NULL);
+        processed_lines += analyze_buffer_timed(result, &parser, data + end,
+                                                len - end, times);
+    }
+
+    if (status == 0) {
+        printf("\rProcessed %zu lines... Done!\n\n", processed_lines);
     }
 
-    /* Cleanup */
-    cleanup_analyzer(result);
     file_reader_close(reader);
+    *processed = processed_lines;
+    return status;
+}
 
+/*
+ * Analyzes several files concurrently and merges them into result in
+ * input order. Per-file results are kept in *files for --per-file;
+ * files that could not be read are left NULL and counted in *skipped.
+ * Stage times go to `times` if non-NULL.
+ * Returns 0 on success, non-zero on failure.
+ */
+static int analyze_many(
+    const CliOptions *options,
+    const InputList *inputs,
+    AnalysisResult *result,
+    AnalysisResult **files,
+    size_t *processed,
+    size_t *skipped,
+    StageTimes *times
+) {
+    size_t workers = options->threads ? options->threads : cpu_count();
+
+    printf("Analyzing %zu log files with %zu threads\n",
+           inputs->count,
+           workers < inputs->count ? workers : inputs->count);
+    printf("Press Ctrl+C to abort...\n\n");
+    fflush(stdout);
+
+    size_t *counts = calloc(inputs->count, sizeof(size_t));
+    if (!counts) {
+        fprintf(stderr, "Error: Memory allocation failed\n");
+        return 1;
+    }
+
+    int status = analyze_files(inputs->paths, inputs->count, workers,
+                               &result->config, &options->filter,
+                               files, counts, skipped, times);
+
+    double merge_start = times ? stats_clock() : 0;
+
+    *processed = 0;
+    for (size_t i = 0; status == 0 && i < inputs->count; i++) {
+        if (!files[i]) continue;
+        if (merge_analysis(result, files[i]) != 0) {
+            fprintf(stderr, "Error: Memory allocation failed\n");
+            status = 1;
+        }
+        *processed += counts[i];
+    }
+    free(counts);
+
+    if (times) times->seconds[STAGE_MERGE] += stats_clock() - merge_start;
+
+    if (status != 0) return 1;
+
+    printf("Processed %zu lines... Done!\n\n", *processed);
     return 0;
 }
+
+/*
+ * Parses every input in order and writes the accepted lines to the
+ * --convert file, printing progress.
+ * Returns 0 on success, non-zero on failure.
+ */
+static int convert_inputs(const CliOptions *options, const InputList *inputs) {
+    ColumnWriter writer;
+    if (column_writer_init(&writer) != 0) {
+        fprintf(stderr, "Error: Memory allocation failed\n");
+        return 1;
+    }
+
+    printf("Converting %zu log file%s to %s\n", inputs->count,
+           inputs->count == 1 ? "" : "s", options->convert_path);
+    printf("Press Ctrl+C to abort...\n\n");
+
+    size_t lines = 0;
+    int status = 0;
+
+    for (size_t i = 0; status == 0 && i < inputs->count; i++) {
+        const char *path = inputs->paths[i];
+        FileReader *reader = file_reader_open(path);
+        if (!reader) {
+            fprintf(stderr, "Error: Could not open file '%s'\n", path);
+            status = 1;
+            break;
+        }
+
+        const char *data;
+        size_t len;
+        if ((data = file_reader_mapping(reader, &len)) != NULL &&
+            columnar_detect(data, len)) {
+            fprintf(stderr, "Error: '%s' is already a columnar file\n", path);
+            file_reader_close(reader);
+            status = 1;
+            break;
+        }
+
+        LogParser parser;
+        LogEntry entry;
+        const char *line;
+        size_t line_len;
+
+        log_parser_init(&parser, &options->filter);
+
+        while ((line = file_reader_read_line(reader, &line_len)) != NULL) {
+            ParseStatus parsed =
+                parse_log_line(&parser, line, line_len, &entry);
+            if (parsed != PARSE_OK) {
+                column_writer_reject(&writer, parsed);
+                continue;
+            }
+
+            if (column_writer_add(&writer, &entry) != 0) {
+                fprintf(stderr, "\nError: Memory allocation failed\n");
+                status = 1;
+                break;
+            }
+
+            if (++lines % PROGRESS_INTERVAL == 0) show_progress(lines);
+        }
+
+        if (status == 0 && file_reader_failed(reader)) {
+            fprintf(stderr, "\nError: Could not read '%s' to the end\n",
+                    path);
+            status = 1;
+        }
+        file_reader_close(reader);
+    }
+
+    if (status == 0 &&
+        column_writer_save(&writer, options->convert_path) != 0) {
+        status = 1;
+    }
+
+    if (status == 0) {
+        printf("\rProcessed %zu lines... Done!\n\n", lines);
+        printf("Wrote %zu lines (%zu distinct messages) to %s\n",
+               writer.rows, writer.string_count, options->convert_path);
+    }
+
+    column_writer_free(&writer);
+    return status;
+}
+
+/*
+ * Writes the report in the selected output format to `out` and
+ * flushes it. `files` is the optional per-file breakdown.
+ * Returns 0 on success, non-zero on failure.
+ */
+static int emit_report(
+    const CliOptions *options,
+    ReportSink *out,
+    AnalysisResult *result,
+    const FileReport *files,
+    size_t file_count
+) {
+    if (finalize_analysis(result) != 0) {
+        fprintf(stderr, "Error: Memory allocation failed\n");
+        return 1;
+    }
+
+    /* Select top errors once for whichever writer runs */
+    TopErrors top;
+    TopFields fields;
+    if (top_errors_select(&top, result, options->top_n) != 0) {
+        fprintf(stderr, "Error: Memory allocation failed\n");
+        return 1;
+    }
+    if (top_fields_select(&fields, result, options->top_n) != 0) {
+        fprintf(stderr, "Error: Memory allocation failed\n");
+        top_errors_free(&top);
+        return 1;
+    }
+
+    /* Progress lines go through stdio to the same stdout */
+    fflush(stdout);
+
+    if (options->output_format == OUTPUT_TEXT) {
+        print_summary(out, result, options->errors_only);
+
+        if (!options->errors_only || result->error_total > 0) {
+            print_top_errors(out, result, &top);
+        }
+
+        print_field_text(out, result, &fields);
+
+        print_time_buckets_text(out, result);
+
+        print_per_file_text(out, files, file_count, options->errors_only);
+
+    } else if (options->output_format == OUTPUT_JSON) {
+        print_report_json(out, result,
+                          options->errors_only,
+                          &top, &fields,
+                          files, file_count);
+
+    } else if (options->output_format == OUTPUT_CSV) {
+        print_report_csv(out, result,
+                         options->errors_only,
+                         &top, &fields,
+                         files, file_count);
+    }
+
+    top_errors_free(&top);
+    top_fields_free(&fields);
+
+    if (sink_flush(out) != 0) {
+        fprintf(stderr, "Error: Could not write report to %s\n",
+                options->output_path ? options->output_path : "stdout");
+        return 1;
+    }
+    return 0;
+}
+
+/* What follow_report() needs */
+typedef struct {
+    const CliOptions *options;
+    ReportSink *out;
+    bool failed;  // a report could not be written
+} FollowContext;
+
+/*
+ * Report callback for follow mode.
+ * A failed write stops following.
+ */
+static int follow_report(AnalysisResult *result, void *ctx) {
+    FollowContext *follow = ctx;
+
+    if (follow->options->output_format == OUTPUT_TEXT) {
+        sink_putc(follow->out, '\n');
+    }
+    if (emit_report(follow->options, follow->out, result, NULL, 0) != 0) {
+        follow->failed = true;
+        return 1;
+    }
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    CliOptions options;
+
+    /* Parse CLI */
+    CliResult cli_result = parse_cli(argc, argv, &options);
+    if (cli_result != CLI_OK) {
+        cli_free(&options);
+        return cli_result == CLI_EXIT ? 0 : 1;
+    }
+
+    /* --stats timings; NULL keeps the untimed paths */
+    StageTimes stage_times;
+    StageTimes *times = options.stats ? &stage_times : NULL;
+    double wall_start = stats_clock();
+
+    stage_times_init(&stage_times);
+
+    /* Resolve files, directories and globs */
+    InputList inputs;
+    if (expand_inputs(options.inputs, options.input_count, &inputs) != 0) {
+        cli_free(&options);
+        return 1;
+    }
+
+    /* No inputs at all is only allowed for --serve */
+    if (inputs.count == 0 && options.input_count > 0) {
+        fprintf(stderr, "Error: No log files found\n");
+        cli_free(&options);
+        return 1;
+    }
+
+    if ((options.follow || options.state_path) && inputs.count != 1) {
+        fprintf(stderr, "Error: --%s accepts a single log file\n",
+                options.follow ? "follow" : "state");
+        input_list_free(&inputs);
+        cli_free(&options);
+        return 1;
+    }
+
+    if (options.convert_path) {
+        int converted = convert_inputs(&options, &inputs);
+        input_list_free(&inputs);
+        cli_free(&options);
+        return converted;
+    }
+
+    /* Initialize analyzer */
+    AnalysisConfig config = {
+        options.group_by, options.templates, options.approx_top,
+        options.distinct, options.field
+    };
+    AnalysisResult *result = init_analyzer(&config);
+    AnalysisResult **files = calloc(inputs.count, sizeof(*files));
+    FileReport *reports = calloc(inputs.count, sizeof(*reports));
+    if (!result || !files || !reports) {
+        fprintf(stderr, "Error: Memory allocation failed\n");
+        cleanup_analyzer(result);
+        free(files);
+        free(reports);
+        input_list_free(&inputs);
+        cli_free(&options);
+        return 1;
+    }
+
+    /* Open the report output first, so a bad path fails before analysis */
+    ReportSink out;
+    if (sink_open(&out, options.output_path) != 0) {
+        if (options.output_path) {
+            fprintf(stderr, "Error: Could not create output file '%s'\n",
+                    options.output_path);
+        } else {
+            fprintf(stderr, "Error: Memory allocation failed\n");
+        }
+        cleanup_analyzer(result);
+        free(files);
+        free(reports);
+        input_list_free(&inputs);
+        cli_free(&options);
+        return 1;
+    }
+
+    size_t processed_lines = 0;
+    size_t skipped = 0;
+    size_t report_count = 0;
+    int status;
+
+    if (options.follow) {
+        printf("Following log file: %s\n", inputs.paths[0]);
+        printf("Press Ctrl+C to stop...\n");
+        fflush(stdout);
+
+        /* Reports are emitted by follow_file on each interval */
+        FollowContext follow = { &options, &out, false };
+        status = follow_file(inputs.paths[0], &options.filter, result,
+                             options.interval, follow_report,
+                             &follow, &processed_lines) != 0;
+        if (status != 0 && !follow.failed) {
+            fprintf(stderr, "Error: Could not follow file '%s'\n",
+                    inputs.paths[0]);
+        }
+    } else if (options.serve_path) {
+        printf("Serving %zu log file(s) on %s\n", inputs.count,
+               options.serve_path);
+        printf("Press Ctrl+C to stop...\n");
+        fflush(stdout);
+
+        /* Queries are answered on the socket; a final report on exit */
+        status = serve_socket(options.serve_path, inputs.paths,
+                              inputs.count, &options.filter, result,
+                              options.top_n, options.errors_only,
+                              &processed_lines) != 0;
+        if (status == 0) {
+            if (options.output_format == OUTPUT_TEXT) sink_putc(&out, '\n');
+            status = emit_report(&options, &out, result, NULL, 0);
+        }
+    } else {
+        if (options.state_path) {
+            status = analyze_incremental(&options, inputs.paths[0],
+                                         result, &processed_lines, times);
+        } else if (inputs.count == 1 && !options.per_file) {
+            status = analyze_file(&options, inputs.paths[0],
+                                  result, &processed_lines, times);
+        } else {
+            status = analyze_many(&options, &inputs, result, files,
+                                  &processed_lines, &skipped, times);
+
+            /* Files that could not be read have no per-file entry */
+            for (size_t i = 0; i < inputs.count; i++) {
+                if (!files[i]) continue;
+                reports[report_count].path = inputs.paths[i];
+                reports[report_count].result = files[i];
+                report_count++;
+            }
+        }
+
+        /* Generate report */
+        if (status == 0) {
+            double report_start = stats_clock();
+
+            status = emit_report(&options, &out, result,
+                                 options.per_file ? reports : NULL,
+                                 report_count);
+
+            stage_times.seconds[STAGE_REPORT] = stats_clock() - report_start;
+        }
+
+        if (status == 0 && times) {
+            print_stats(stderr, times, stats_clock() - wall_start, result,
+                        processed_lines,
+                        options.output_format == OUTPUT_JSON);
+        }
+
+        /* The report covers the other files, but the run still failed */
+        if (status == 0 && skipped > 0) {
+            fprintf(stderr, "Error: %zu of %zu files could not be read\n",
+                    skipped, inputs.count);
+            status = 1;
+        }
+    }
+
+    /* Cleanup */
+    if (sink_close(&out) != 0 && status == 0) {
+        fprintf(stderr, "Error: Could not write report to %s\n",
+                options.output_path ? options.output_path : "stdout");
+        status = 1;
+    }
+
+    for (size_t i = 0; i < inputs.count; i++) {
+        cleanup_analyzer(files[i]);
+    }
+    free(files);
+    free(reports);
+    cleanup_analyzer(result);
+    input_list_free(&inputs);
+    cli_free(&options);
+
+    return status;
+}
@@ -0,0 +1,513 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "parallel.h"
+#include "columnar.h"
+#include "parser.h"
+#include "scan.h"
+#include "timerange.h"
+#include "utils.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+
+/* Lines per timed batch; the stage clocks are read once per batch */
+#define STATS_BATCH 256
+
+typedef struct {
+    const char *data;
+    size_t len;
+    const LineFilter *filter;
+    AnalysisResult *result;
+    size_t processed;
+    StageTimes *times;  // NULL unless --stats
+} ChunkTask;
+
+typedef struct {
+    const char *line[STATS_BATCH];
+    size_t len[STATS_BATCH];
+    size_t count;
+} LineBatch;
+
+/* Shared work queue for the per-file pool */
+typedef struct {
+    char *const *paths;
+    size_t count;
+    const AnalysisConfig *config;
+    const LineFilter *filter;
+    AnalysisResult **results;
+    size_t *processed;
+    StageTimes *times;  // NULL unless --stats; updated under lock
+
+    pthread_mutex_t lock;
+    size_t next;
+    int failed;      // out of memory: stop handing out files
+    size_t skipped;  // files that could not be read
+} FileQueue;
+
+/* ---------- Helpers ---------- */
+
+/*
+ * Returns the offset just past the first newline at or after pos,
+ * or len if there is none.
+ */
+static size_t next_line_start(const char *data, size_t len, size_t pos) {
+    if (pos >= len) return len;
+
+    const char *nl = memchr(data + pos, '\n', len - pos);
+    return nl ? (size_t)(nl - data) + 1 : len;
+}
+
+/*
+ * Parses and then aggregates a batch of lines, timing the two stages
+ * separately. Returns the number of lines that parsed successfully.
+ */
+static size_t run_batch(
+    AnalysisResult *result,
+    LogParser *parser,
+    const LineBatch *batch,
+    StageTimes *times
+) {
+    LogEntry entries[STATS_BATCH];
+    ParseStatus parsed[STATS_BATCH];
+    size_t processed = 0;
+
+    double start = stats_clock();
+    for (size_t i = 0; i < batch->count; i++) {
+        parsed[i] = parse_log_line(parser, batch->line[i], batch->len[i],
+                                   &entries[i]);
+    }
+
+    double mid = stats_clock();
+    for (size_t i = 0; i < batch->count; i++) {
+        if (parsed[i] == PARSE_OK) {
+            process_log_line(result, &entries[i]);
+            processed++;
+        } else {
+            record_rejected_line(result, parsed[i]);
+        }
+    }
+
+    double end = stats_clock();
+    times->seconds[STAGE_PARSE] += mid - start;
+    times->seconds[STAGE_AGGREGATE] += end - mid;
+    return processed;
+}
+
+static void *chunk_worker(void *arg) {
+    ChunkTask *task = arg;
+    LogParser parser;
+
+    log_parser_init(&parser, task->filter);
+    task->processed = analyze_buffer_timed(task->result, &parser, task->data,
+                                           task->len, task->times);
+    return NULL;
+}
+
+/*
+ * Analyzes one file sequentially.
+ * Returns 0 on success, 1 if the file could not be opened, decoded or
+ * decompressed, or -1 on OOM (an error has been printed).
+ */
+static int analyze_path(
+    const char *path,
+    const LineFilter *filter,
+    AnalysisResult *result,
+    size_t *processed,
+    StageTimes *times
+) {
+    double start = times ? stats_clock() : 0;
+
+    FileReader *reader = file_reader_open(path);
+    if (!reader) {
+        fprintf(stderr, "Error: Could not open file '%s'\n", path);
+        return 1;
+    }
+
+    int status = 0;
+
+    LogParser parser;
+    log_parser_init(&parser, filter);
+
+    const char *data;
+    size_t len;
+
+    if ((data = file_reader_mapping(reader, &len)) != NULL &&
+        columnar_detect(data, len)) {
+        if (times) times->seconds[STAGE_READ] += stats_clock() - start;
+
+        int converted = analyze_columnar(result, data, len, filter,
+                                         processed, times);
+        if (converted > 0) {
+            fprintf(stderr, "Error: '%s' is not a valid columnar file\n",
+                    path);
+            status = 1;
+        } else if (converted < 0) {
+            fprintf(stderr, "Error: Memory allocation failed\n");
+            status = -1;
+        }
+    } else if (data) {
+        narrow_to_time_window(reader, filter, &data, &len);
+        if (times) times->seconds[STAGE_READ] += stats_clock() - start;
+
+        *processed = analyze_buffer_timed(result, &parser, data, len, times);
+    } else if (times) {
+        times->seconds[STAGE_READ] += stats_clock() - start;
+
+        if (analyze_reader_timed(result, &parser, reader, times,
+                                 processed) != 0) {
+            fprintf(stderr, "Error: Memory allocation failed\n");
+            status = -1;
+        }
+    } else {
+        LogEntry entry;
+        const char *line;
+        size_t line_len;
+
+        *processed = 0;
+        while ((line = file_reader_read_line(reader, &line_len)) != NULL) {
+            ParseStatus parsed =
+                parse_log_line(&parser, line, line_len, &entry);
+            if (parsed == PARSE_OK) {
+                process_log_line(result, &entry);
+                (*processed)++;
+            } else {
+                record_rejected_line(result, parsed);
+            }
+        }
+    }
+
+    if (status == 0 && file_reader_failed(reader)) {
+        fprintf(stderr, "Error: Could not read '%s' to the end\n", path);
+        status = 1;
+    }
+
+    file_reader_close(reader);
+    return status;
+}
+
+static void *file_worker(void *arg) {
+    FileQueue *queue = arg;
+
+    for (;;) {
+        pthread_mutex_lock(&queue->lock);
+        size_t i = queue->next++;
+        int stop = queue->failed;
+        pthread_mutex_unlock(&queue->lock);
+
+        if (stop || i >= queue->count) return NULL;
+
+        AnalysisResult *result = init_analyzer(queue->config);
+        StageTimes times;
+        int status = -1;
+
+        stage_times_init(&times);
+        if (!result) {
+            fprintf(stderr, "Error: Memory allocation failed\n");
+        } else {
+            status = analyze_path(queue->paths[i], queue->filter, result,
+                                  &queue->processed[i],
+                                  queue->times ? &times : NULL);
+        }
+
+        /* An unreadable file is left out; the others still count */
+        if (status > 0) {
+            cleanup_analyzer(result);
+            result = NULL;
+            queue->processed[i] = 0;
+        }
+        queue->results[i] = result;
+
+        if (status != 0 || queue->times) {
+            pthread_mutex_lock(&queue->lock);
+            if (status < 0) queue->failed = 1;
+            if (status > 0) queue->skipped++;
+            stage_times_add(queue->times, &times);
+            pthread_mutex_unlock(&queue->lock);
+        }
+    }
+}
+
+/* ---------- Public API ---------- */
+
+size_t cpu_count(void) {
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (size_t)n : 1;
+}
+
+size_t analyze_buffer(
+    AnalysisResult *result,
+    LogParser *parser,
+    const char *data,
+    size_t len
+) {
+    if (!result || !parser || !data) return 0;
+
+    LogEntry entry;
+    size_t ends[SCAN_BATCH];
+    size_t processed = 0;
+    size_t pos = 0;
+
+    while (pos < len) {
+        size_t count = scan_newlines(data, len, pos, ends, SCAN_BATCH);
+
+        /* No newline left: the rest is an unterminated last line */
+        if (count == 0) ends[count++] = len;
+
+        for (size_t i = 0; i < count; i++) {
+            ParseStatus parsed = parse_log_line(parser, data + pos,
+                                                ends[i] - pos, &entry);
+            if (parsed == PARSE_OK) {
+                process_log_line(result, &entry);
+                processed++;
+            } else {
+                record_rejected_line(result, parsed);
+            }
+
+            pos = ends[i] + 1;
+        }
+    }
+
+    return processed;
+}
+
+size_t analyze_buffer_timed(
+    AnalysisResult *result,
+    LogParser *parser,
+    const char *data,
+    size_t len,
+    StageTimes *times
+) {
+    if (!times) return analyze_buffer(result, parser, data, len);
+    if (!result || !parser || !data) return 0;
+
+    LineBatch batch;
+    size_t ends[STATS_BATCH];
+    size_t processed = 0;
+    size_t pos = 0;
+
+    while (pos < len) {
+        double start = stats_clock();
+
+        size_t count = scan_newlines(data, len, pos, ends, STATS_BATCH);
+        if (count == 0) ends[count++] = len;
+
+        for (batch.count = 0; batch.count < count; batch.count++) {
+            batch.line[batch.count] = data + pos;
+            batch.len[batch.count] = ends[batch.count] - pos;
+            pos = ends[batch.count] + 1;
+        }
+
+        times->seconds[STAGE_READ] += stats_clock() - start;
+        processed += run_batch(result, parser, &batch, times);
+    }
+
+    times->bytes += len;
+    return processed;
+}
+
+int analyze_reader_timed(
+    AnalysisResult *result,
+    LogParser *parser,
+    FileReader *reader,
+    StageTimes *times,
+    size_t *processed
+) {
+    if (!result || !parser || !reader || !times || !processed) return -1;
+
+    LineBatch batch;
+    size_t offsets[STATS_BATCH];
+    char *text = NULL;
+    size_t capacity = 0;
+    int done = 0;
+
+    *processed = 0;
+
+    while (!done) {
+        double start = stats_clock();
+        size_t used = 0;
+
+        /* Line views die on the next read, so the batch keeps copies */
+        for (batch.count = 0; batch.count < STATS_BATCH; batch.count++) {
+            size_t line_len;
+            const char *line = file_reader_read_line(reader, &line_len);
+            if (!line) {
+                done = 1;
+                break;
+            }
+
+            if (used + line_len > capacity) {
+                size_t new_capacity = capacity ? capacity * 2 : 65536;
+                while (new_capacity < used + line_len) new_capacity *= 2;
+
+                char *new_text = realloc(text, new_capacity);
+                if (!new_text) {
+                    free(text);
+                    return -1;
+                }
+                text = new_text;
+                capacity = new_capacity;
+            }
+
+            memcpy(text + used, line, line_len);
+            offsets[batch.count] = used;
+            batch.len[batch.count] = line_len;
+            used += line_len;
+            times->bytes += line_len + 1;
+        }
+
+        for (size_t i = 0; i < batch.count; i++) {
+            batch.line[i] = text + offsets[i];
+        }
+
+        times->seconds[STAGE_READ] += stats_clock() - start;
+        *processed += run_batch(result, parser, &batch, times);
+    }
+
+    free(text);
+    return 0;
+}
+
+int analyze_parallel(
+    AnalysisResult *result,
+    const char *data,
+    size_t len,
+    size_t threads,
+    const LineFilter *filter,
+    size_t *processed,
+    StageTimes *times
+) {
+    if (!result || !data || !processed || threads == 0) return -1;
+
+    ChunkTask *tasks = calloc(threads, sizeof(ChunkTask));
+    pthread_t *ids = calloc(threads, sizeof(pthread_t));
+    StageTimes *chunk_times =
+        times ? calloc(threads, sizeof(StageTimes)) : NULL;
+    if (!tasks || !ids || (times && !chunk_times)) {
+        free(tasks);
+        free(ids);
+        free(chunk_times);
+        return -1;
+    }
+
+    /* Cut chunks at newline boundaries */
+    size_t start = 0;
+    for (size_t i = 0; i < threads; i++) {
+        size_t end = (i + 1 == threads)
+                         ? len
+                         : next_line_start(data, len, len / threads * (i + 1));
+        if (end < start) end = start;
+
+        tasks[i].data = data + start;
+        tasks[i].len = end - start;
+        tasks[i].filter = filter;
+        tasks[i].times = times ? &chunk_times[i] : NULL;
+        start = end;
+    }
+
+    int status = 0;
+    size_t started = 0;
+
+    for (; started < threads; started++) {
+        ChunkTask *task = &tasks[started];
+
+        task->result = init_analyzer(&result->config);
+        if (!task->result ||
+            pthread_create(&ids[started], NULL, chunk_worker, task) != 0) {
+            cleanup_analyzer(task->result);
+            task->result = NULL;
+            status = -1;
+            break;
+        }
+    }
+
+    for (size_t i = 0; i < started; i++) {
+        pthread_join(ids[i], NULL);
+    }
+
+    /* Merge in input order so table ordering matches a sequential run */
+    double merge_start = times ? stats_clock() : 0;
+
+    *processed = 0;
+    for (size_t i = 0; i < started; i++) {
+        if (status == 0) {
+            if (merge_analysis(result, tasks[i].result) != 0) status = -1;
+            *processed += tasks[i].processed;
+        }
+        cleanup_analyzer(tasks[i].result);
+        if (times) stage_times_add(times, &chunk_times[i]);
+    }
+
+    if (times) times->seconds[STAGE_MERGE] += stats_clock() - merge_start;
+
+    free(tasks);
+    free(ids);
+    free(chunk_times);
+
+    return status;
+}
+
+int analyze_files(
+    char *const *paths,
+    size_t count,
+    size_t workers,
+    const AnalysisConfig *config,
+    const LineFilter *filter,
+    AnalysisResult **results,
+    size_t *processed,
+    size_t *skipped,
+    StageTimes *times
+) {
+    if (!paths || !config || !results || !processed || workers == 0) {
+        return -1;
+    }
+
+    if (workers > count) workers = count;
+
+    for (size_t i = 0; i < count; i++) {
+        results[i] = NULL;
+        processed[i] = 0;
+    }
+
+    FileQueue queue;
+    queue.paths = paths;
+    queue.count = count;
+    queue.config = config;
+    queue.filter = filter;
+    queue.results = results;
+    queue.processed = processed;
+    queue.times = times;
+    queue.next = 0;
+    queue.failed = 0;
+    queue.skipped = 0;
+
+    if (pthread_mutex_init(&queue.lock, NULL) != 0) return -1;
+
+    pthread_t *ids = calloc(workers, sizeof(pthread_t));
+    if (!ids) {
+        pthread_mutex_destroy(&queue.lock);
+        return -1;
+    }
+
+    size_t started = 0;
+    for (; started < workers; started++) {
+        if (pthread_create(&ids[started], NULL, file_worker, &queue) != 0) {
+            break;
+        }
+    }
+
+    /* With no threads at all, do the work on the calling thread */
+    if (started == 0) file_worker(&queue);
+
+    for (size_t i = 0; i < started; i++) {
+        pthread_join(ids[i], NULL);
+    }
+
+    free(ids);
+    pthread_mutex_destroy(&queue.lock);
+
+    if (skipped) *skipped = queue.skipped;
+    return queue.failed ? -1 : 0;
+}
@@ -1,32 +1,120 @@
+#define _POSIX_C_SOURCE 200809L
+
 #include "parser.h"
 
+#include <limits.h>
 #include <string.h>
-#include <stdio.h>
 #include <time.h>
 
+#define SECONDS_PER_DAY 86400LL
+
+/* How far around a timestamp to look for the next DST transition */
+#define SEGMENT_SEARCH_DAYS 31
+
+/* ---------- Calendar Arithmetic ---------- */
+
 /*
- * Converts timestamp string "YYYY-MM-DD HH:MM:SS" to Unix time.
- * Returns 0 on success, non-zero on failure.
+ * Days since 1970-01-01 for a proleptic Gregorian date.
+ * (Howard Hinnant's days_from_civil.) Out-of-range days are linear,
+ * so "Feb 31" normalizes the same way mktime() would.
  */
-static int parse_timestamp_unix(const char *timestamp, long long *out_unix) {
-    if (!timestamp || !out_unix) return -1;
+static long long days_from_civil(int y, int m, int d) {
+    y -= m <= 2;
+    long long era = (y >= 0 ? y : y - 399) / 400;
+    long long yoe = y - era * 400;
+    long long doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    long long doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe - 719468;
+}
 
-    int year, month, day, hour, minute, second;
+/*
+ * Local UTC offset at Unix time t, or 0 if it cannot be determined.
+ */
+static long long utc_offset_at(long long t) {
+    time_t tt = (time_t)t;
+    struct tm tm_value;
 
-    if (sscanf(timestamp,
-               "%4d-%2d-%2d %2d:%2d:%2d",
-               &year, &month, &day,
-               &hour, &minute, &second) != 6) {
-        return -1;
+    if (!localtime_r(&tt, &tm_value)) return 0;
+
+    long long local =
+        days_from_civil(tm_value.tm_year + 1900,
+                        tm_value.tm_mon + 1,
+                        tm_value.tm_mday) * SECONDS_PER_DAY +
+        tm_value.tm_hour * 3600LL +
+        tm_value.tm_min * 60LL +
+        tm_value.tm_sec;
+
+    return local - t;
+}
+
+/*
+ * Returns the first time in (known, probe] whose offset differs from
+ * `offset`, given that it differs at `probe` but not at `known`.
+ * Works in either direction.
+ */
+static long long find_transition(long long known, long long probe,
+                                 long long offset) {
+    while (known - probe > 1 || probe - known > 1) {
+        long long mid = known + (probe - known) / 2;
+        if (utc_offset_at(mid) == offset) known = mid;
+        else probe = mid;
     }
+    return probe;
+}
 
-    if (year < 1970 ||
-        month < 1 || month > 12 ||
-        day < 1 || day > 31 ||
-        hour < 0 || hour > 23 ||
-        minute < 0 || minute > 59 ||
-        second < 0 || second > 60) {
-        return -1;
+/*
+ * Finds the span around t over which the UTC offset stays constant,
+ * looking at most SEGMENT_SEARCH_DAYS either way.
+ */
+static void find_offset_segment(LogParser *parser, long long t) {
+    long long offset = utc_offset_at(t);
+    long long limit = SEGMENT_SEARCH_DAYS * SECONDS_PER_DAY;
+
+    long long end = t;
+    while (end - t < limit) {
+        long long next = end + SECONDS_PER_DAY;
+        if (utc_offset_at(next) != offset) {
+            end = find_transition(end, next, offset) - 1;
+            break;
+        }
+        end = next;
+    }
+
+    long long start = t;
+    while (t - start < limit) {
+        long long prev = start - SECONDS_PER_DAY;
+        if (utc_offset_at(prev) != offset) {
+            start = find_transition(start, prev, offset) + 1;
+            break;
+        }
+        start = prev;
+    }
+
+    parser->utc_offset = offset;
+    parser->segment_start = start;
+    parser->segment_end = end + 1;
+    parser->segment_valid = 1;
+}
+
+/*
+ * Converts broken-down local time to Unix time using the cached DST
+ * segment; falls back to mktime() only when leaving the segment.
+ * Returns 0 on success, non-zero on failure.
+ */
+static int local_to_unix(LogParser *parser,
+                         int year, int month, int day,
+                         int hour, int minute, int second,
+                         long long *out_unix) {
+    long long local =
+        days_from_civil(year, month, day) * SECONDS_PER_DAY +
+        hour * 3600LL + minute * 60LL + second;
+
+    if (parser->segment_valid) {
+        long long t = local - parser->utc_offset;
+        if (t >= parser->segment_start && t < parser->segment_end) {
+            *out_unix = t;
+            return 0;
+        }
     }
 
     struct tm tm_value;
@@ -43,10 +131,147 @@ static int parse_timestamp_unix(const char *timestamp, long long *out_unix) {
     time_t t = mktime(&tm_value);
     if (t == (time_t)-1) return -1;
 
+    find_offset_segment(parser, (long long)t);
+
     *out_unix = (long long)t;
     return 0;
 }
 
+/* ---------- Timestamp Parsing ---------- */
+
+static int parse_2digits(const char *p, int *out) {
+    unsigned d0 = (unsigned char)p[0] - '0';
+    unsigned d1 = (unsigned char)p[1] - '0';
+
+    if (d0 > 9 || d1 > 9) return -1;
+
+    *out = (int)(d0 * 10 + d1);
+    return 0;
+}
+
+/*
+ * Parses minutes and seconds of "...:MM:SS" at p (p points at MM).
+ */
+static int parse_min_sec(const char *p, int *minute, int *second) {
+    if (p[-1] != ':' || p[2] != ':') return -1;
+    if (parse_2digits(p, minute) != 0 || parse_2digits(p + 3, second) != 0) {
+        return -1;
+    }
+    if (*minute > 59 || *second > 60) return -1;
+
+    return 0;
+}
+
+/*
+ * Converts timestamp "YYYY-MM-DD HH:MM:SS" (exactly TIMESTAMP_LEN
+ * bytes, fixed layout) to Unix time. Lines sharing the cached
+ * "YYYY-MM-DD HH" prefix only convert minutes and seconds.
+ * Returns 0 on success, non-zero on failure.
+ */
+static int parse_timestamp_unix(LogParser *parser,
+                                const char *timestamp,
+                                long long *out_unix) {
+    if (!timestamp || !out_unix) return -1;
+
+    int minute, second;
+
+    /* Fast path: same date and hour as the previous line */
+    if (parser->hour_valid &&
+        memcmp(timestamp, parser->hour_prefix, TIMESTAMP_HOUR_LEN) == 0) {
+        if (parse_min_sec(timestamp + 14, &minute, &second) != 0) return -1;
+
+        *out_unix = parser->hour_base + minute * 60LL + second;
+        return 0;
+    }
+
+    int century, yy, month, day, hour;
+
+    if (timestamp[4] != '-' || timestamp[7] != '-' || timestamp[10] != ' ') {
+        return -1;
+    }
+
+    if (parse_2digits(timestamp, &century) != 0 ||
+        parse_2digits(timestamp + 2, &yy) != 0 ||
+        parse_2digits(timestamp + 5, &month) != 0 ||
+        parse_2digits(timestamp + 8, &day) != 0 ||
+        parse_2digits(timestamp + 11, &hour) != 0 ||
+        parse_min_sec(timestamp + 14, &minute, &second) != 0) {
+        return -1;
+    }
+
+    int year = century * 100 + yy;
+
+    if (year < 1970 ||
+        month < 1 || month > 12 ||
+        day < 1 || day > 31 ||
+        hour > 23) {
+        return -1;
+    }
+
+    long long hour_base;
+    if (local_to_unix(parser, year, month, day, hour, 0, 0,
+                      &hour_base) != 0) {
+        return -1;
+    }
+
+    /*
+     * Cache the hour only if HH:00:00 exists in local time and no DST
+     * transition falls inside the hour; otherwise convert the full
+     * time through the segment check.
+     */
+    long long local_hour =
+        days_from_civil(year, month, day) * SECONDS_PER_DAY + hour * 3600LL;
+
+    parser->hour_valid =
+        parser->segment_valid &&
+        hour_base + parser->utc_offset == local_hour &&
+        hour_base >= parser->segment_start &&
+        hour_base + 3600 <= parser->segment_end;
+
+    if (parser->hour_valid) {
+        memcpy(parser->hour_prefix, timestamp, TIMESTAMP_HOUR_LEN);
+        parser->hour_base = hour_base;
+
+        *out_unix = hour_base + minute * 60LL + second;
+        return 0;
+    }
+
+    return local_to_unix(parser, year, month, day,
+                         hour, minute, second, out_unix);
+}
+
+/* ---------- Public API ---------- */
+
+void line_filter_init(LineFilter *filter) {
+    if (!filter) return;
+
+    filter->since = LLONG_MIN;
+    filter->until = LLONG_MAX;
+    filter->grep = NULL;
+}
+
+int line_filter_has_range(const LineFilter *filter) {
+    return filter &&
+           (filter->since != LLONG_MIN || filter->until != LLONG_MAX);
+}
+
+void log_parser_init(LogParser *parser, const LineFilter *filter) {
+    if (!parser) return;
+
+    memset(parser, 0, sizeof(*parser));
+    parser->filter = filter;
+}
+
+int parse_timestamp(
+    LogParser *parser,
+    const char *timestamp,
+    long long *out_unix
+) {
+    if (!parser) return -1;
+
+    return parse_timestamp_unix(parser, timestamp, out_unix);
+}
+
 /*
  * Parses a single log line into LogEntry.
  * Expected format:
@@ -54,53 +279,78 @@ static int parse_timestamp_unix(const char *timestamp, long long *out_unix) {
  *
  * Returns 0 on success, non-zero on failure.
  */
-int parse_log_line(const char *line, LogEntry *entry) {
-    if (!line || !entry) return -1;
+ParseStatus parse_log_line(
+    LogParser *parser,
+    const char *line,
+    size_t len,
+    LogEntry *entry
+) {
+    if (!parser || !line || !entry) return PARSE_TOO_SHORT;
 
     memset(entry, 0, sizeof(*entry));
 
     /* Minimum length: timestamp + space */
-    if (strlen(line) < TIMESTAMP_LEN + 1) return -1;
+    if (len < TIMESTAMP_LEN + 1) return PARSE_TOO_SHORT;
+
+    /* Patterns are checked on the raw line, before any timestamp work */
+    if (parser->filter && parser->filter->grep &&
+        !grep_set_match(parser->filter->grep, line, len)) {
+        return PARSE_NO_MATCH;
+    }
 
     /* Extract timestamp */
     memcpy(entry->timestamp, line, TIMESTAMP_LEN);
     entry->timestamp[TIMESTAMP_LEN] = '\0';
 
-    if (parse_timestamp_unix(entry->timestamp,
+    if (parse_timestamp_unix(parser, entry->timestamp,
                              &entry->timestamp_unix) != 0) {
-        return -1;
+        return PARSE_BAD_TIMESTAMP;
+    }
+    entry->utc_offset = parser->utc_offset;
+
+    if (parser->filter &&
+        (entry->timestamp_unix < parser->filter->since ||
+         entry->timestamp_unix >= parser->filter->until)) {
+        return PARSE_OUT_OF_RANGE;
     }
 
     /* Move past timestamp and space */
     const char *p = line + TIMESTAMP_LEN + 1;
+    size_t remaining = len - (TIMESTAMP_LEN + 1);
 
     /* Parse log level */
-    if (strncmp(p, "INFO ", 5) == 0) {
+    if (remaining >= 5 && memcmp(p, "INFO ", 5) == 0) {
         entry->level = LOG_LEVEL_INFO;
         p += 5;
     }
-    else if (strncmp(p, "WARN ", 5) == 0) {
+    else if (remaining >= 5 && memcmp(p, "WARN ", 5) == 0) {
         entry->level = LOG_LEVEL_WARN;
         p += 5;
     }
-    else if (strncmp(p, "ERROR ", 6) == 0) {
+    else if (remaining >= 6 && memcmp(p, "ERROR ", 6) == 0) {
         entry->level = LOG_LEVEL_ERROR;
         p += 6;
     }
     else {
         entry->level = LOG_LEVEL_UNKNOWN;
-        return -1;
+        return PARSE_UNKNOWN_LEVEL;
     }
 
-    /* Copy message */
-    strncpy(entry->message, p, MAX_MESSAGE_LEN - 1);
-    entry->message[MAX_MESSAGE_LEN - 1] = '\0';
+    /* Message is a view into the line; no copy */
+    entry->message = p;
+    entry->message_len = (size_t)(line + len - p);
 
-    /* Trim trailing newline */
-    size_t len = strlen(entry->message);
-    if (len > 0 && entry->message[len - 1] == '\n') {
-        entry->message[len - 1] = '\0';
-    }
+    return PARSE_OK;
+}
 
-    return 0;
+const char *parse_status_name(ParseStatus status) {
+    switch (status) {
+        case PARSE_OK:            return "ok";
+        case PARSE_TOO_SHORT:     return "too_short";
+        case PARSE_BAD_TIMESTAMP: return "bad_timestamp";
+        case PARSE_UNKNOWN_LEVEL: return "unknown_level";
+        case PARSE_OUT_OF_RANGE:  return "out_of_range";
+        case PARSE_NO_MATCH:      return "no_match";
+        default:                  return "unknown";
+    }
 }
@@ -0,0 +1,380 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "pipeline.h"
+#include "parallel.h"
+#include "ring.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Blocks in flight per parse thread, plus two for the I/O thread */
+#define BLOCKS_PER_WORKER 2
+
+typedef struct {
+    const char *text;  // `data`, or a view into the input region
+    size_t len;
+    size_t seq;        // position in the input
+
+    char *data;  // owned buffer for reader input
+    size_t capacity;
+
+    /* Filled in by the parse thread */
+    AnalysisResult *result;  // NULL on OOM
+    size_t processed;
+    StageTimes times;
+} Block;
+
+typedef struct {
+    /* Input: a memory region, or a reader when `data` is NULL */
+    FileReader *reader;
+    const char *data;
+    size_t len;
+    size_t pos;
+
+    const AnalysisConfig *config;
+    const LineFilter *filter;
+    int timed;
+    size_t workers;
+
+    Block *blocks;
+    size_t block_count;
+    Ring free_blocks;  // merger -> I/O thread
+    Ring filled;       // I/O thread -> parse threads; NULL = stop
+    Ring parsed;       // parse threads -> merger; NULL = thread done
+
+    /* I/O thread state */
+    char *carry;  // partial line at the end of the last block
+    size_t carry_len;
+    size_t carry_capacity;
+    double read_seconds;
+    int failed;  // OOM while reading
+    int stop;    // set by the merger after a failure
+} Pipeline;
+
+/* ---------- Helpers ---------- */
+
+/*
+ * Returns the offset just past the last newline in data[0, len),
+ * or 0 if there is none.
+ */
+static size_t last_line_end(const char *data, size_t len) {
+    while (len > 0 && data[len - 1] != '\n') len--;
+    return len;
+}
+
+static int grow_block(Block *block, size_t capacity) {
+    if (capacity <= block->capacity) return 0;
+
+    char *data = realloc(block->data, capacity);
+    if (!data) return -1;
+
+    block->data = data;
+    block->capacity = capacity;
+    return 0;
+}
+
+/*
+ * Points a block at the next PIPELINE_BLOCK_SIZE bytes of the input
+ * region, extended to the end of the line they stop in, and touches
+ * every page so that page faults are taken here rather than by a
+ * parse thread. Sets *eof once the region is exhausted.
+ */
+static void view_block(Pipeline *p, Block *block, int *eof) {
+    static const size_t page = 4096;
+    size_t start = p->pos;
+    size_t end = start + PIPELINE_BLOCK_SIZE;
+
+    if (end >= p->len) {
+        end = p->len;
+    } else {
+        const char *nl = memchr(p->data + end, '\n', p->len - end);
+        end = nl ? (size_t)(nl - p->data) + 1 : p->len;
+    }
+
+    volatile char sink = 0;
+    for (size_t i = start; i < end; i += page) sink ^= p->data[i];
+    (void)sink;
+
+    block->text = p->data + start;
+    block->len = end - start;
+    p->pos = end;
+    if (end == p->len) *eof = 1;
+}
+
+/*
+ * Fills a block's buffer with the carried partial line and then reader
+ * input up to the last complete line, growing the buffer while a
+ * single line does not fit. Sets *eof once the input is exhausted.
+ * Returns 0 on success, non-zero on OOM.
+ */
+static int fill_block(Pipeline *p, Block *block, int *eof) {
+    size_t capacity = p->carry_len < PIPELINE_BLOCK_SIZE
+                          ? PIPELINE_BLOCK_SIZE : p->carry_len * 2;
+    if (grow_block(block, capacity) != 0) return -1;
+
+    if (p->carry_len > 0) memcpy(block->data, p->carry, p->carry_len);
+    block->len = p->carry_len;
+    p->carry_len = 0;
+
+    for (;;) {
+        if (block->len == block->capacity &&
+            grow_block(block, block->capacity * 2) != 0) {
+            return -1;
+        }
+
+        size_t n = file_reader_read_block(p->reader,
+                                          block->data + block->len,
+                                          block->capacity - block->len);
+        if (n == 0) {
+            *eof = 1;
+            block->text = block->data;
+            return 0;
+        }
+
+        block->len += n;
+        if (block->len < block->capacity) continue;
+
+        /* Full: keep whole lines, carry the rest into the next block */
+        size_t end = last_line_end(block->data, block->len);
+        if (end == 0) continue;
+
+        size_t tail = block->len - end;
+        if (tail > p->carry_capacity) {
+            char *carry = realloc(p->carry, block->capacity);
+            if (!carry) return -1;
+            p->carry = carry;
+            p->carry_capacity = block->capacity;
+        }
+
+        memcpy(p->carry, block->data + end, tail);
+        p->carry_len = tail;
+        block->len = end;
+        block->text = block->data;
+        return 0;
+    }
+}
+
+static void *io_thread(void *arg) {
+    Pipeline *p = arg;
+    size_t seq = 0;
+    int eof = 0;
+
+    while (!eof && !__atomic_load_n(&p->stop, __ATOMIC_RELAXED)) {
+        Block *block = ring_pop(&p->free_blocks);
+
+        double start = p->timed ? stats_clock() : 0;
+        if (p->data) {
+            view_block(p, block, &eof);
+        } else if (fill_block(p, block, &eof) != 0) {
+            p->failed = 1;
+            ring_push(&p->free_blocks, block);
+            break;
+        }
+        if (p->timed) p->read_seconds += stats_clock() - start;
+
+        if (block->len == 0) {
+            ring_push(&p->free_blocks, block);
+            break;
+        }
+
+        block->seq = seq++;
+        ring_push(&p->filled, block);
+    }
+
+    for (size_t i = 0; i < p->workers; i++) {
+        ring_push(&p->filled, NULL);
+    }
+    return NULL;
+}
+
+static void *parse_thread(void *arg) {
+    Pipeline *p = arg;
+    LogParser parser;
+    Block *block;
+
+    log_parser_init(&parser, p->filter);
+
+    while ((block = ring_pop(&p->filled)) != NULL) {
+        stage_times_init(&block->times);
+        block->processed = 0;
+        block->result = init_analyzer(p->config);
+
+        if (block->result) {
+            block->processed = analyze_buffer_timed(
+                block->result, &parser, block->text, block->len,
+                p->timed ? &block->times : NULL);
+        }
+
+        ring_push(&p->parsed, block);
+    }
+
+    ring_push(&p->parsed, NULL);
+    return NULL;
+}
+
+/*
+ * Merges parsed blocks into result in input order and hands their
+ * buffers back to the I/O thread, until every parse thread is done.
+ * Returns 0 on success, non-zero on OOM.
+ */
+static int merge_blocks(
+    Pipeline *p,
+    AnalysisResult *result,
+    size_t *processed,
+    StageTimes *times
+) {
+    Block **pending = calloc(p->block_count, sizeof(Block *));
+    int status = pending ? 0 : -1;
+    size_t next = 0;
+    size_t done = 0;
+
+    /* Without the reorder table, only drain so the threads can finish */
+    while (done < p->workers) {
+        Block *block = ring_pop(&p->parsed);
+        if (!block) {
+            done++;
+            continue;
+        }
+
+        if (!pending) {
+            cleanup_analyzer(block->result);
+            block->result = NULL;
+            __atomic_store_n(&p->stop, 1, __ATOMIC_RELAXED);
+            ring_push(&p->free_blocks, block);
+            continue;
+        }
+
+        /* In-flight blocks have distinct seq modulo block_count */
+        pending[block->seq % p->block_count] = block;
+
+        while ((block = pending[next % p->block_count]) != NULL &&
+               block->seq == next) {
+            pending[next % p->block_count] = NULL;
+            next++;
+
+            double start = times ? stats_clock() : 0;
+            if (status == 0 &&
+                (!block->result ||
+                 merge_analysis(result, block->result) != 0)) {
+                status = -1;
+                __atomic_store_n(&p->stop, 1, __ATOMIC_RELAXED);
+            }
+            *processed += block->processed;
+
+            cleanup_analyzer(block->result);
+            block->result = NULL;
+
+            if (times) {
+                stage_times_add(times, &block->times);
+                times->seconds[STAGE_MERGE] += stats_clock() - start;
+            }
+
+            ring_push(&p->free_blocks, block);
+        }
+    }
+
+    free(pending);
+    return status;
+}
+
+static void free_pipeline(Pipeline *p) {
+    for (size_t i = 0; i < p->block_count; i++) {
+        free(p->blocks[i].data);
+    }
+    free(p->blocks);
+    free(p->carry);
+    ring_free(&p->free_blocks);
+    ring_free(&p->filled);
+    ring_free(&p->parsed);
+}
+
+/*
+ * Allocates the blocks and rings for `workers` parse threads.
+ * Returns 0 on success, non-zero on OOM (p is then freed).
+ */
+static int init_pipeline(Pipeline *p, size_t workers) {
+    p->block_count = workers * BLOCKS_PER_WORKER + 2;
+    p->blocks = calloc(p->block_count, sizeof(Block));
+    if (!p->blocks) return -1;
+
+    /* Room for every block plus one NULL per parse thread */
+    size_t capacity = p->block_count + workers;
+    if (ring_init(&p->free_blocks, capacity) != 0 ||
+        ring_init(&p->filled, capacity) != 0 ||
+        ring_init(&p->parsed, capacity) != 0) {
+        free_pipeline(p);
+        return -1;
+    }
+
+    /* Buffers are allocated on first use; region input needs none */
+    for (size_t i = 0; i < p->block_count; i++) {
+        ring_push(&p->free_blocks, &p->blocks[i]);
+    }
+
+    return 0;
+}
+
+/* ---------- Public API ---------- */
+
+int analyze_pipeline(
+    AnalysisResult *result,
+    FileReader *reader,
+    const char *data,
+    size_t len,
+    size_t workers,
+    const LineFilter *filter,
+    size_t *processed,
+    StageTimes *times
+) {
+    if (!result || (!reader && !data) || !processed || workers == 0) {
+        return -1;
+    }
+
+    Pipeline p;
+    memset(&p, 0, sizeof(p));
+    p.reader = reader;
+    p.data = data;
+    p.len = len;
+    p.config = &result->config;
+    p.filter = filter;
+    p.timed = times != NULL;
+
+    if (init_pipeline(&p, workers) != 0) return -1;
+
+    pthread_t *ids = calloc(workers, sizeof(pthread_t));
+    pthread_t io;
+    if (!ids) {
+        free_pipeline(&p);
+        return -1;
+    }
+
+    for (; p.workers < workers; p.workers++) {
+        if (pthread_create(&ids[p.workers], NULL, parse_thread, &p) != 0) {
+            break;
+        }
+    }
+
+    int status = 0;
+    *processed = 0;
+
+    if (p.workers == 0) {
+        status = -1;
+    } else if (pthread_create(&io, NULL, io_thread, &p) != 0) {
+        for (size_t i = 0; i < p.workers; i++) ring_push(&p.filled, NULL);
+        status = -1;
+    } else {
+        status = merge_blocks(&p, result, processed, times);
+        pthread_join(io, NULL);
+        if (p.failed) status = -1;
+        if (times) times->seconds[STAGE_READ] += p.read_seconds;
+    }
+
+    for (size_t i = 0; i < p.workers; i++) {
+        pthread_join(ids[i], NULL);
+    }
+
+    free(ids);
+    free_pipeline(&p);
+    return status;
+}
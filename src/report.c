@@ -2,6 +2,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <time.h>
 
 #ifdef __linux__
@@ -18,236 +19,862 @@
 
 /* ---------- Text Summary ---------- */
 
-void print_summary(const AnalysisResult *result, bool errors_only) {
-    if (!result) return;
+/*
+ * Returns the --distinct estimate for one level.
+ */
+static unsigned long long distinct_count(const HyperLogLog *levels,
+                                         LogLevel level) {
+    return (unsigned long long)hll_estimate(&levels[level]);
+}
+
+/*
+ * Appends "label" value "\n" wrapped in a level color.
+ */
+static void put_level_line(
+    ReportSink *out,
+    const char *color,
+    const char *label,
+    unsigned long long value
+) {
+    sink_puts(out, color);
+    sink_puts(out, label);
+    sink_uint(out, value);
+    sink_puts(out, "\n" COLOR_RESET);
+}
+
+void print_summary(
+    ReportSink *out,
+    const AnalysisResult *result,
+    bool errors_only
+) {
+    if (!out || !result) return;
+
+    if (errors_only) {
+        sink_puts(out, COLOR_ERROR "Error Summary\n" COLOR_RESET);
+        sink_puts(out, "------------------\n");
+        sink_puts(out, "Total Errors : ");
+        sink_uint(out, result->error_total);
+        sink_putc(out, '\n');
+    } else {
+        sink_puts(out, "Log Summary\n");
+        sink_puts(out, "------------------\n");
+        sink_puts(out, "Total lines : ");
+        sink_uint(out, result->total_lines);
+        sink_putc(out, '\n');
+        put_level_line(out, COLOR_INFO, "INFO  : ", result->info_count);
+        put_level_line(out, COLOR_WARN, "WARN  : ", result->warn_count);
+        put_level_line(out, COLOR_ERROR, "ERROR : ", result->error_total);
+    }
+
+    if (!result->config.distinct) return;
 
+    const HyperLogLog *d = result->distinct;
     if (errors_only) {
-        printf(COLOR_ERROR "Error Summary\n" COLOR_RESET);
-        printf("------------------\n");
-        printf("Total Errors : %zu\n", result->error_total);
+        sink_puts(out, "Distinct errors (est.) : ");
+        sink_uint(out, distinct_count(d, LOG_LEVEL_ERROR));
+        sink_putc(out, '\n');
     } else {
-        printf("Log Summary\n");
-        printf("------------------\n");
-        printf("Total lines : %zu\n", result->total_lines);
-        printf(COLOR_INFO  "INFO  : %zu\n" COLOR_RESET, result->info_count);
-        printf(COLOR_WARN  "WARN  : %zu\n" COLOR_RESET, result->warn_count);
-        printf(COLOR_ERROR "ERROR : %zu\n" COLOR_RESET, result->error_total);
+        sink_puts(out, "\nDistinct messages (estimated)\n");
+        sink_puts(out, "------------------\n");
+        put_level_line(out, COLOR_INFO, "INFO  : ",
+                       distinct_count(d, LOG_LEVEL_INFO));
+        put_level_line(out, COLOR_WARN, "WARN  : ",
+                       distinct_count(d, LOG_LEVEL_WARN));
+        put_level_line(out, COLOR_ERROR, "ERROR : ",
+                       distinct_count(d, LOG_LEVEL_ERROR));
     }
 }
 
-/* ---------- Top Errors (Text) ---------- */
+/* ---------- Top Errors Selection ---------- */
 
-void print_top_errors(const AnalysisResult *result, size_t top_n) {
-    if (!result || top_n == 0) return;
+int top_errors_select(
+    TopErrors *top,
+    const AnalysisResult *result,
+    size_t top_n
+) {
+    if (!top || !result) return -1;
+
+    top->entries = NULL;
+    top->count = 0;
+    top->approximate = result->config.approx_top != 0;
+
+    size_t available = top->approximate ? result->heavy.size
+                                        : result->error_unique;
+    size_t n = available < top_n ? available : top_n;
+    if (n == 0) return 0;
+
+    top->entries = malloc(n * sizeof(*top->entries));
+    void *picked = malloc(n * sizeof(void *));
+    if (!top->entries || !picked) {
+        free(top->entries);
+        free(picked);
+        top->entries = NULL;
+        return -1;
+    }
 
-    if (result->error_unique == 0) {
-        printf("\nNo errors found.\n");
-        return;
+    if (top->approximate) {
+        const HeavyItem **items = picked;
+        top->count = heavy_top(&result->heavy, n, items);
+
+        for (size_t i = 0; i < top->count; i++) {
+            top->entries[i].message = items[i]->message;
+            top->entries[i].example = items[i]->example;
+            top->entries[i].message_len = items[i]->message_len;
+            top->entries[i].example_len = items[i]->example_len;
+            top->entries[i].count = items[i]->count;
+            top->entries[i].error = items[i]->error;
+        }
+    } else {
+        const ErrorEntry **errors = picked;
+        top->count = get_top_errors(result, n, errors);
+
+        for (size_t i = 0; i < top->count; i++) {
+            top->entries[i].message = error_entry_message(result, errors[i]);
+            top->entries[i].example = error_entry_example(result, errors[i]);
+            top->entries[i].message_len = errors[i]->message_len;
+            top->entries[i].example_len = errors[i]->example_len;
+            top->entries[i].count = errors[i]->count;
+            top->entries[i].error = 0;
+        }
+    }
+
+    free(picked);
+    return 0;
+}
+
+void top_errors_free(TopErrors *top) {
+    if (!top) return;
+
+    free(top->entries);
+    top->entries = NULL;
+    top->count = 0;
+}
+
+/* ---------- Field Selection ---------- */
+
+int top_fields_select(
+    TopFields *fields,
+    const AnalysisResult *result,
+    size_t top_n
+) {
+    if (!fields || !result) return -1;
+
+    fields->entries = NULL;
+    fields->count = 0;
+
+    size_t n = result->field_unique < top_n ? result->field_unique : top_n;
+    if (n == 0) return 0;
+
+    fields->entries = malloc(n * sizeof(*fields->entries));
+    if (!fields->entries) return -1;
+
+    fields->count = get_top_fields(result, n, fields->entries);
+    return 0;
+}
+
+void top_fields_free(TopFields *fields) {
+    if (!fields) return;
+
+    free(fields->entries);
+    fields->entries = NULL;
+    fields->count = 0;
+}
+
+/* ---------- Field Values ---------- */
+
+#define QUANTILE_COUNT 3
+
+static const double QUANTILES[QUANTILE_COUNT] = { 0.5, 0.9, 0.99 };
+static const char *const QUANTILE_NAMES[QUANTILE_COUNT] = {
+    "p50", "p90", "p99"
+};
+
+/*
+ * Formats a field value to about three significant digits (the
+ * histogram resolves 0.8%), without trailing zeros ("45.2", "1500").
+ */
+static void format_value(double value, char *buf, size_t size) {
+    int decimals = value >= 100 ? 0 : value >= 10 ? 1 : value >= 1 ? 2 : 3;
+    snprintf(buf, size, "%.*f", decimals, value);
+
+    char *end = buf + strlen(buf);
+    if (decimals > 0) {
+        while (end[-1] == '0') end--;
+        if (end[-1] == '.') end--;
+        *end = '\0';
+    }
+}
+
+/*
+ * Appends the quantiles and max of a histogram, each as
+ * prefix name separator value (e.g. " p50=12" or ",\"p50\":12").
+ * Appends `missing` instead of values when the histogram is empty.
+ */
+static void print_quantiles(
+    ReportSink *out,
+    const Histogram *hist,
+    const char *prefix,
+    const char *separator,
+    const char *missing
+) {
+    char buf[64];
+    double values[QUANTILE_COUNT + 1];
+
+    histogram_quantiles(hist, QUANTILES, QUANTILE_COUNT, values);
+    values[QUANTILE_COUNT] = hist->max;
+
+    for (int i = 0; i <= QUANTILE_COUNT; i++) {
+        const char *name = i < QUANTILE_COUNT ? QUANTILE_NAMES[i] : "max";
+
+        sink_puts(out, prefix);
+        sink_puts(out, name);
+        sink_puts(out, separator);
+
+        if (hist->total == 0) {
+            sink_puts(out, missing);
+            continue;
+        }
+
+        format_value(values[i], buf, sizeof(buf));
+        sink_puts(out, buf);
+    }
+}
+
+/*
+ * CSV cells for a histogram: count, quantiles and max (empty if none).
+ */
+static void print_quantiles_csv(ReportSink *out, const Histogram *hist) {
+    char buf[64];
+    double values[QUANTILE_COUNT + 1];
+
+    histogram_quantiles(hist, QUANTILES, QUANTILE_COUNT, values);
+    values[QUANTILE_COUNT] = hist->max;
+
+    sink_putc(out, ',');
+    sink_uint(out, hist->total);
+    for (int i = 0; i <= QUANTILE_COUNT; i++) {
+        sink_putc(out, ',');
+        if (hist->total == 0) continue;
+
+        format_value(values[i], buf, sizeof(buf));
+        sink_puts(out, buf);
     }
+}
+
+void print_field_text(
+    ReportSink *out,
+    const AnalysisResult *result,
+    const TopFields *fields
+) {
+    if (!out || !result || !fields || !result->config.field) return;
 
-    size_t n = result->error_unique < top_n
-                   ? result->error_unique
-                   : top_n;
+    const Histogram *all = &result->field_values;
 
-    ErrorEntry *top_errors = malloc(n * sizeof(ErrorEntry));
-    if (!top_errors) return;
+    if (all->total == 0) {
+        sink_puts(out, "\nNo values found for field '");
+        sink_puts(out, result->config.field);
+        sink_puts(out, "'.\n");
+        return;
+    }
+
+    sink_puts(out, "\nField '");
+    sink_puts(out, result->config.field);
+    sink_puts(out, "' (");
+    sink_uint(out, all->total);
+    sink_puts(out, " values):\n");
+    sink_puts(out, "------------------\n");
+    sink_puts(out, "All:");
+    print_quantiles(out, all, " ", "=", "-");
+    sink_putc(out, '\n');
+
+    if (fields->count == 0) return;
+
+    sink_puts(out, "By template:\n");
+    for (size_t i = 0; i < fields->count; i++) {
+        const FieldEntry *f = fields->entries[i];
+
+        sink_uint(out, i + 1);
+        sink_puts(out, ". ");
+        sink_write(out, field_entry_template(result, f), f->template_len);
+        sink_puts(out, " (");
+        sink_uint(out, f->values.total);
+        sink_puts(out, " values)\n  ");
+        print_quantiles(out, &f->values, " ", "=", "-");
+        sink_putc(out, '\n');
+    }
+}
 
-    get_top_errors(result, n, top_errors);
+/* ---------- Top Errors (Text) ---------- */
 
-    printf("\nTop %zu Errors:\n", n);
-    printf("------------------\n");
+void print_top_errors(
+    ReportSink *out,
+    const AnalysisResult *result,
+    const TopErrors *top
+) {
+    if (!out || !result || !top) return;
 
-    for (size_t i = 0; i < n; i++) {
-        printf("%zu. %s (%zu occurrences)\n",
-               i + 1,
-               top_errors[i].message,
-               top_errors[i].count);
+    if (top->count == 0) {
+        sink_puts(out, "\nNo errors found.\n");
+        return;
     }
 
-    free(top_errors);
+    sink_puts(out, "\nTop ");
+    sink_uint(out, top->count);
+    sink_puts(out, top->approximate ? " Errors (approximate):\n"
+                                    : " Errors:\n");
+    sink_puts(out, "------------------\n");
+
+    for (size_t i = 0; i < top->count; i++) {
+        const TopError *e = &top->entries[i];
+
+        sink_uint(out, i + 1);
+        sink_puts(out, ". ");
+        sink_write(out, e->message, e->message_len);
+        sink_puts(out, " (");
+        sink_uint(out, e->count);
+        if (top->approximate) {
+            sink_puts(out, " occurrences, overcounted by at most ");
+            sink_uint(out, e->error);
+            sink_puts(out, ")\n");
+        } else {
+            sink_puts(out, " occurrences)\n");
+        }
+
+        if (result->config.templates) {
+            sink_puts(out, "   e.g. ");
+            sink_write(out, e->example, e->example_len);
+            sink_putc(out, '\n');
+        }
+    }
 }
 
 /* ---------- Time Buckets (Text) ---------- */
 
-static void print_time_bucket_label(long long start_unix, GroupBy group_by) {
-    time_t t = (time_t)start_unix;
-    struct tm tm_value;
+/*
+ * Local time of the last converted bucket start, reused for the rest of
+ * its local hour so a minute-level dump calls localtime_r() about once
+ * per hour instead of once per row.
+ */
+typedef struct {
+    long long start;  // cached span [start, end); empty if start >= end
+    long long end;
+    struct tm tm;     // local time at `start`
+} LabelCache;
+
+static int local_time(long long t, struct tm *out) {
+    time_t tt = (time_t)t;
 
 #if defined(_POSIX_THREAD_SAFE_FUNCTIONS)
-    localtime_r(&t, &tm_value);
+    return localtime_r(&tt, out) ? 0 : -1;
 #else
-    struct tm *tmp = localtime(&t);
-    if (!tmp) return;
-    tm_value = *tmp;
+    struct tm *tmp = localtime(&tt);
+    if (!tmp) return -1;
+    *out = *tmp;
+    return 0;
 #endif
+}
 
-    char buf[32];
-    if (group_by == GROUP_BY_HOUR) {
-        strftime(buf, sizeof(buf), "%Y-%m-%d %H:00", &tm_value);
-    } else {
-        strftime(buf, sizeof(buf), "%Y-%m-%d %H:%M", &tm_value);
+/*
+ * Fills cache->tm for t. The span reaches to the end of t's local hour
+ * only if the clock still reads HH:59:59 one second before it, i.e. no
+ * UTC offset change falls inside the hour.
+ */
+static int refresh_label_cache(LabelCache *cache, long long t) {
+    struct tm last;
+
+    if (local_time(t, &cache->tm) != 0) return -1;
+
+    cache->start = t;
+    cache->end = t + (59 - cache->tm.tm_min) * 60LL +
+                 (60 - cache->tm.tm_sec);
+
+    if (local_time(cache->end - 1, &last) != 0 ||
+        last.tm_mday != cache->tm.tm_mday ||
+        last.tm_hour != cache->tm.tm_hour ||
+        last.tm_min != 59 || last.tm_sec != 59) {
+        cache->end = t + 1;
+    }
+
+    return 0;
+}
+
+static void print_time_bucket_label(
+    ReportSink *out,
+    LabelCache *cache,
+    long long start_unix,
+    GroupBy group_by
+) {
+    if ((start_unix < cache->start || start_unix >= cache->end) &&
+        refresh_label_cache(cache, start_unix) != 0) {
+        return;
     }
 
-    printf("%s", buf);
+    const struct tm *tm = &cache->tm;
+    long long minute = tm->tm_min + (start_unix - cache->start) / 60;
+
+    /* YYYY-MM-DD HH:MM, with :00 for hourly buckets */
+    sink_uint_padded(out, (unsigned long long)(tm->tm_year + 1900), 4);
+    sink_putc(out, '-');
+    sink_uint_padded(out, (unsigned long long)(tm->tm_mon + 1), 2);
+    sink_putc(out, '-');
+    sink_uint_padded(out, (unsigned long long)tm->tm_mday, 2);
+    sink_putc(out, ' ');
+    sink_uint_padded(out, (unsigned long long)tm->tm_hour, 2);
+    sink_putc(out, ':');
+    sink_uint_padded(out, group_by == GROUP_BY_HOUR
+                              ? 0 : (unsigned long long)minute, 2);
 }
 
-void print_time_buckets_text(const AnalysisResult *result) {
-    if (!result) return;
-    if (result->group_by == GROUP_BY_NONE) return;
+void print_time_buckets_text(ReportSink *out, const AnalysisResult *result) {
+    if (!out || !result) return;
+    if (result->config.group_by == GROUP_BY_NONE) return;
     if (result->time_bucket_count == 0) return;
 
-    printf("\nTime Buckets (%s):\n",
-           result->group_by == GROUP_BY_HOUR ? "hour" : "minute");
-    printf("-----------------------------------\n");
+    LabelCache cache = { 0, 0, { 0 } };
+
+    sink_puts(out, result->config.group_by == GROUP_BY_HOUR
+                       ? "\nTime Buckets (hour):\n"
+                       : "\nTime Buckets (minute):\n");
+    sink_puts(out, "-----------------------------------\n");
 
     for (size_t i = 0; i < result->time_bucket_count; i++) {
-        print_time_bucket_label(result->time_buckets[i].start_unix,
-                                result->group_by);
-        printf(" | total=%d info=%d warn=%d error=%d\n",
-               result->time_buckets[i].total,
-               result->time_buckets[i].info,
-               result->time_buckets[i].warn,
-               result->time_buckets[i].error);
+        const TimeBucket *b = &result->time_buckets[i];
+
+        print_time_bucket_label(out, &cache, b->start_unix,
+                                result->config.group_by);
+        sink_puts(out, " | total=");
+        sink_uint(out, b->total);
+        sink_puts(out, " info=");
+        sink_uint(out, b->info);
+        sink_puts(out, " warn=");
+        sink_uint(out, b->warn);
+        sink_puts(out, " error=");
+        sink_uint(out, b->error);
+        if (result->config.distinct) {
+            sink_puts(out, " distinct_info=");
+            sink_uint(out, distinct_count(b->distinct, LOG_LEVEL_INFO));
+            sink_puts(out, " distinct_warn=");
+            sink_uint(out, distinct_count(b->distinct, LOG_LEVEL_WARN));
+            sink_puts(out, " distinct_error=");
+            sink_uint(out, distinct_count(b->distinct, LOG_LEVEL_ERROR));
+        }
+        if (result->config.field) {
+            sink_puts(out, " | ");
+            sink_puts(out, result->config.field);
+            sink_puts(out, " n=");
+            sink_uint(out, b->field.total);
+            if (b->field.total > 0) {
+                print_quantiles(out, &b->field, " ", "=", "-");
+            }
+        }
+        sink_putc(out, '\n');
     }
 }
 
-/* ---------- JSON Helpers ---------- */
+/* ---------- Per-File Breakdown (Text) ---------- */
 
-static void print_json_escaped(const char *s) {
-    for (const char *p = s; p && *p; p++) {
-        switch (*p) {
-            case '\\': printf("\\\\"); break;
-            case '"':  printf("\\\""); break;
-            case '\n': printf("\\n");  break;
-            case '\r': printf("\\r");  break;
-            case '\t': printf("\\t");  break;
-            default:   putchar(*p);    break;
+void print_per_file_text(
+    ReportSink *out,
+    const FileReport *files,
+    size_t file_count,
+    bool errors_only
+) {
+    if (!out || !files || file_count == 0) return;
+
+    sink_puts(out, "\nPer-File Summary:\n");
+    sink_puts(out, "-----------------------------------\n");
+
+    for (size_t i = 0; i < file_count; i++) {
+        const AnalysisResult *r = files[i].result;
+
+        sink_puts(out, files[i].path);
+        if (errors_only) {
+            sink_puts(out, " | error=");
+            sink_uint(out, r->error_total);
+        } else {
+            sink_puts(out, " | total=");
+            sink_uint(out, r->total_lines);
+            sink_puts(out, " info=");
+            sink_uint(out, r->info_count);
+            sink_puts(out, " warn=");
+            sink_uint(out, r->warn_count);
+            sink_puts(out, " error=");
+            sink_uint(out, r->error_total);
         }
+        sink_putc(out, '\n');
     }
 }
 
+/* ---------- JSON Helpers ---------- */
+
+/*
+ * Appends ,"key":value.
+ */
+static void json_uint(ReportSink *out, const char *key,
+                      unsigned long long value) {
+    sink_puts(out, ",\"");
+    sink_puts(out, key);
+    sink_puts(out, "\":");
+    sink_uint(out, value);
+}
+
+/*
+ * Appends "key":"escaped value" (no leading comma) for `len` bytes of
+ * value.
+ */
+static void json_string(ReportSink *out, const char *key,
+                        const char *value, size_t len) {
+    sink_putc(out, '"');
+    sink_puts(out, key);
+    sink_puts(out, "\":\"");
+    sink_json_string(out, value, len);
+    sink_putc(out, '"');
+}
+
+/*
+ * Appends the level counters of a summary, bucket or file:
+ * "total_lines":..,"info":..,"warn":..,"error":.. (or the errors-only
+ * field), with `total_key` naming the first one.
+ */
+static void json_level_counts(
+    ReportSink *out,
+    const char *total_key,
+    size_t total,
+    size_t info,
+    size_t warn,
+    size_t error
+) {
+    sink_putc(out, '"');
+    sink_puts(out, total_key);
+    sink_puts(out, "\":");
+    sink_uint(out, total);
+    json_uint(out, "info", info);
+    json_uint(out, "warn", warn);
+    json_uint(out, "error", error);
+}
+
 /* ---------- JSON Report ---------- */
 
-void print_report_json(
+void print_summary_json(
+    ReportSink *out,
     const AnalysisResult *result,
-    bool errors_only,
-    size_t top_n
+    bool errors_only
 ) {
-    if (!result) return;
+    if (!out || !result) return;
 
-    printf("{");
-
-    /* Summary */
-    printf("\"summary\":{");
+    sink_puts(out, "\"summary\":{");
     if (errors_only) {
-        printf("\"total_errors\":%zu", result->error_total);
+        sink_puts(out, "\"total_errors\":");
+        sink_uint(out, result->error_total);
     } else {
-        printf("\"total_lines\":%zu,", result->total_lines);
-        printf("\"info\":%zu,", result->info_count);
-        printf("\"warn\":%zu,", result->warn_count);
-        printf("\"error\":%zu", result->error_total);
+        json_level_counts(out, "total_lines", result->total_lines,
+                          result->info_count, result->warn_count,
+                          result->error_total);
+    }
+    if (result->config.distinct) {
+        const HyperLogLog *d = result->distinct;
+        if (errors_only) {
+            json_uint(out, "distinct_errors",
+                      distinct_count(d, LOG_LEVEL_ERROR));
+        } else {
+            sink_puts(out, ",\"distinct\":{\"info\":");
+            sink_uint(out, distinct_count(d, LOG_LEVEL_INFO));
+            json_uint(out, "warn", distinct_count(d, LOG_LEVEL_WARN));
+            json_uint(out, "error", distinct_count(d, LOG_LEVEL_ERROR));
+            sink_putc(out, '}');
+        }
     }
-    printf("}");
+    sink_putc(out, '}');
+}
+
+void print_top_errors_json(
+    ReportSink *out,
+    const AnalysisResult *result,
+    const TopErrors *top
+) {
+    if (!out || !result || !top) return;
+
+    sink_puts(out, "\"top_errors\":[");
+    for (size_t i = 0; i < top->count; i++) {
+        const TopError *e = &top->entries[i];
+
+        if (i > 0) sink_putc(out, ',');
+        sink_putc(out, '{');
+        json_string(out, result->config.templates ? "template" : "message",
+                    e->message, e->message_len);
+        json_uint(out, "count", e->count);
+        if (top->approximate) json_uint(out, "count_error", e->error);
+        if (result->config.templates) {
+            sink_putc(out, ',');
+            json_string(out, "example", e->example, e->example_len);
+        }
+        sink_putc(out, '}');
+    }
+    sink_putc(out, ']');
+}
+
+void print_time_buckets_json(
+    ReportSink *out,
+    const AnalysisResult *result,
+    size_t first
+) {
+    if (!out || !result) return;
+
+    sink_puts(out, "\"time_buckets\":[");
+    for (size_t i = first; i < result->time_bucket_count; i++) {
+        const TimeBucket *b = &result->time_buckets[i];
+
+        if (i > first) sink_putc(out, ',');
+        sink_puts(out, "{\"start_unix\":");
+        sink_int(out, b->start_unix);
+        sink_putc(out, ',');
+        json_level_counts(out, "total", b->total,
+                          b->info, b->warn, b->error);
+        if (result->config.distinct) {
+            json_uint(out, "distinct_info",
+                      distinct_count(b->distinct, LOG_LEVEL_INFO));
+            json_uint(out, "distinct_warn",
+                      distinct_count(b->distinct, LOG_LEVEL_WARN));
+            json_uint(out, "distinct_error",
+                      distinct_count(b->distinct, LOG_LEVEL_ERROR));
+        }
+        if (result->config.field) {
+            sink_puts(out, ",\"field\":{\"count\":");
+            sink_uint(out, b->field.total);
+            print_quantiles(out, &b->field, ",\"", "\":", "null");
+            sink_putc(out, '}');
+        }
+        sink_putc(out, '}');
+    }
+    sink_putc(out, ']');
+}
+
+void print_report_json(
+    ReportSink *out,
+    const AnalysisResult *result,
+    bool errors_only,
+    const TopErrors *top,
+    const TopFields *fields,
+    const FileReport *files,
+    size_t file_count
+) {
+    if (!out || !result || !top || !fields) return;
+
+    sink_putc(out, '{');
+    print_summary_json(out, result, errors_only);
 
-    /* Top errors */
     if (!errors_only || result->error_total > 0) {
-        size_t n = result->error_unique < top_n
-                       ? result->error_unique
-                       : top_n;
-
-        printf(",\"top_errors\":[");
-
-        if (n > 0) {
-            ErrorEntry *top_errors = malloc(n * sizeof(ErrorEntry));
-            if (top_errors) {
-                get_top_errors(result, n, top_errors);
-                for (size_t i = 0; i < n; i++) {
-                    if (i > 0) printf(",");
-                    printf("{\"message\":\"");
-                    print_json_escaped(top_errors[i].message);
-                    printf("\",\"count\":%zu}", top_errors[i].count);
-                }
-                free(top_errors);
-            }
+        sink_putc(out, ',');
+        print_top_errors_json(out, result, top);
+    }
+
+    /* Field values */
+    if (result->config.field) {
+        sink_puts(out, ",\"field\":{");
+        json_string(out, "name", result->config.field,
+                    strlen(result->config.field));
+        json_uint(out, "count", result->field_values.total);
+        print_quantiles(out, &result->field_values, ",\"", "\":", "null");
+
+        sink_puts(out, ",\"templates\":[");
+        for (size_t i = 0; i < fields->count; i++) {
+            const FieldEntry *f = fields->entries[i];
+
+            if (i > 0) sink_putc(out, ',');
+            sink_putc(out, '{');
+            json_string(out, "template", field_entry_template(result, f),
+                        f->template_len);
+            json_uint(out, "count", f->values.total);
+            print_quantiles(out, &f->values, ",\"", "\":", "null");
+            sink_putc(out, '}');
         }
-        printf("]");
+        sink_puts(out, "]}");
     }
 
     /* Time buckets */
-    if (result->group_by != GROUP_BY_NONE &&
+    if (result->config.group_by != GROUP_BY_NONE &&
         result->time_bucket_count > 0) {
 
-        printf(",\"time_buckets\":[");
-        for (size_t i = 0; i < result->time_bucket_count; i++) {
-            if (i > 0) printf(",");
-            printf("{\"start_unix\":%lld,", result->time_buckets[i].start_unix);
-            printf("\"total\":%d,\"info\":%d,\"warn\":%d,\"error\":%d}",
-                   result->time_buckets[i].total,
-                   result->time_buckets[i].info,
-                   result->time_buckets[i].warn,
-                   result->time_buckets[i].error);
+        sink_putc(out, ',');
+        print_time_buckets_json(out, result, 0);
+    }
+
+    /* Per-file breakdown */
+    if (files && file_count > 0) {
+        sink_puts(out, ",\"files\":[");
+        for (size_t i = 0; i < file_count; i++) {
+            const AnalysisResult *r = files[i].result;
+
+            if (i > 0) sink_putc(out, ',');
+            sink_putc(out, '{');
+            json_string(out, "file", files[i].path, strlen(files[i].path));
+            if (errors_only) {
+                json_uint(out, "total_errors", r->error_total);
+            } else {
+                sink_putc(out, ',');
+                json_level_counts(out, "total_lines", r->total_lines,
+                                  r->info_count, r->warn_count,
+                                  r->error_total);
+            }
+            sink_putc(out, '}');
         }
-        printf("]");
+        sink_putc(out, ']');
     }
 
-    printf("}\n");
+    sink_puts(out, "}\n");
 }
 
 /* ---------- CSV Report ---------- */
 
+/*
+ * Appends one "name,value" metric row.
+ */
+static void csv_metric(ReportSink *out, const char *name,
+                       unsigned long long value) {
+    sink_puts(out, name);
+    sink_putc(out, ',');
+    sink_uint(out, value);
+    sink_putc(out, '\n');
+}
+
 void print_report_csv(
+    ReportSink *out,
     const AnalysisResult *result,
     bool errors_only,
-    size_t top_n
+    const TopErrors *top,
+    const TopFields *fields,
+    const FileReport *files,
+    size_t file_count
 ) {
-    if (!result) return;
+    if (!out || !result || !top || !fields) return;
 
-    printf("metric,value\n");
+    sink_puts(out, "metric,value\n");
 
     if (errors_only) {
-        printf("total_errors,%zu\n", result->error_total);
+        csv_metric(out, "total_errors", result->error_total);
     } else {
-        printf("total_lines,%zu\n", result->total_lines);
-        printf("info,%zu\n", result->info_count);
-        printf("warn,%zu\n", result->warn_count);
-        printf("error,%zu\n", result->error_total);
+        csv_metric(out, "total_lines", result->total_lines);
+        csv_metric(out, "info", result->info_count);
+        csv_metric(out, "warn", result->warn_count);
+        csv_metric(out, "error", result->error_total);
+    }
+    if (result->config.distinct) {
+        const HyperLogLog *d = result->distinct;
+        if (!errors_only) {
+            csv_metric(out, "distinct_info",
+                       distinct_count(d, LOG_LEVEL_INFO));
+            csv_metric(out, "distinct_warn",
+                       distinct_count(d, LOG_LEVEL_WARN));
+        }
+        csv_metric(out, "distinct_error", distinct_count(d, LOG_LEVEL_ERROR));
+    }
+    if (result->config.field) {
+        sink_puts(out, "field_count,");
+        sink_uint(out, result->field_values.total);
+        print_quantiles(out, &result->field_values, "\nfield_", ",", "");
+        sink_putc(out, '\n');
     }
 
     /* Top errors */
-    if (!errors_only || result->error_total > 0) {
-        size_t n = result->error_unique < top_n
-                       ? result->error_unique
-                       : top_n;
-
-        if (n > 0) {
-            ErrorEntry *top_errors = malloc(n * sizeof(ErrorEntry));
-            if (!top_errors) return;
+    if ((!errors_only || result->error_total > 0) && top->count > 0) {
+        sink_puts(out, result->config.templates ? "\nerror_template,count"
+                                                : "\nerror_message,count");
+        if (top->approximate) sink_puts(out, ",count_error");
+        if (result->config.templates) sink_puts(out, ",example");
+        sink_putc(out, '\n');
+
+        for (size_t i = 0; i < top->count; i++) {
+            const TopError *e = &top->entries[i];
+
+            sink_csv_field(out, e->message, e->message_len);
+            sink_putc(out, ',');
+            sink_uint(out, e->count);
+            if (top->approximate) {
+                sink_putc(out, ',');
+                sink_uint(out, e->error);
+            }
+            if (result->config.templates) {
+                sink_putc(out, ',');
+                sink_csv_field(out, e->example, e->example_len);
+            }
+            sink_putc(out, '\n');
+        }
+    }
 
-            get_top_errors(result, n, top_errors);
+    /* Field values by template */
+    if (fields->count > 0) {
+        sink_puts(out, "\nfield_template,count,p50,p90,p99,max\n");
 
-            printf("\nerror_message,count\n");
-            for (size_t i = 0; i < n; i++) {
-                printf("\"");
-                print_json_escaped(top_errors[i].message);
-                printf("\",%zu\n", top_errors[i].count);
-            }
+        for (size_t i = 0; i < fields->count; i++) {
+            const FieldEntry *f = fields->entries[i];
 
-            free(top_errors);
+            sink_csv_field(out, field_entry_template(result, f),
+                           f->template_len);
+            print_quantiles_csv(out, &f->values);
+            sink_putc(out, '\n');
         }
     }
 
     /* Time buckets */
-    if (result->group_by != GROUP_BY_NONE &&
+    if (result->config.group_by != GROUP_BY_NONE &&
         result->time_bucket_count > 0) {
 
-        printf("\nstart_unix,total,info,warn,error\n");
+        sink_puts(out, "\nstart_unix,total,info,warn,error");
+        if (result->config.distinct) {
+            sink_puts(out, ",distinct_info,distinct_warn,distinct_error");
+        }
+        if (result->config.field) {
+            sink_puts(out,
+                      ",field_count,field_p50,field_p90,field_p99,field_max");
+        }
+        sink_putc(out, '\n');
+
         for (size_t i = 0; i < result->time_bucket_count; i++) {
-            printf("%lld,%d,%d,%d,%d\n",
-                   result->time_buckets[i].start_unix,
-                   result->time_buckets[i].total,
-                   result->time_buckets[i].info,
-                   result->time_buckets[i].warn,
-                   result->time_buckets[i].error);
+            const TimeBucket *b = &result->time_buckets[i];
+
+            sink_int(out, b->start_unix);
+            sink_putc(out, ',');
+            sink_uint(out, b->total);
+            sink_putc(out, ',');
+            sink_uint(out, b->info);
+            sink_putc(out, ',');
+            sink_uint(out, b->warn);
+            sink_putc(out, ',');
+            sink_uint(out, b->error);
+            if (result->config.distinct) {
+                for (int level = 0; level < LOG_LEVEL_COUNT; level++) {
+                    sink_putc(out, ',');
+                    sink_uint(out, distinct_count(b->distinct,
+                                                  (LogLevel)level));
+                }
+            }
+            if (result->config.field) print_quantiles_csv(out, &b->field);
+            sink_putc(out, '\n');
+        }
+    }
+
+    /* Per-file breakdown */
+    if (files && file_count > 0) {
+        sink_puts(out, errors_only ? "\nfile,total_errors\n"
+                                   : "\nfile,total_lines,info,warn,error\n");
+
+        for (size_t i = 0; i < file_count; i++) {
+            const AnalysisResult *r = files[i].result;
+
+            sink_csv_field(out, files[i].path, strlen(files[i].path));
+            sink_putc(out, ',');
+            if (errors_only) {
+                sink_uint(out, r->error_total);
+            } else {
+                sink_uint(out, r->total_lines);
+                sink_putc(out, ',');
+                sink_uint(out, r->info_count);
+                sink_putc(out, ',');
+                sink_uint(out, r->warn_count);
+                sink_putc(out, ',');
+                sink_uint(out, r->error_total);
+            }
+            sink_putc(out, '\n');
         }
     }
 }
@@ -0,0 +1,117 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "ring.h"
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* ---------- Helpers ---------- */
+
+static size_t load_acquire(const size_t *p) {
+    return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+}
+
+static void store_release(size_t *p, size_t v) {
+    __atomic_store_n(p, v, __ATOMIC_RELEASE);
+}
+
+static void wait_semaphore(sem_t *sem) {
+    while (sem_wait(sem) != 0 && errno == EINTR) {
+    }
+}
+
+/*
+ * Claims the next position whose slot is in `state` relative to the
+ * position (0 = free for a producer, 1 = filled for a consumer).
+ * The semaphores guarantee such a slot exists; a claim only retries
+ * while another thread finishes handing over the slot.
+ */
+static RingSlot *claim_slot(Ring *ring, size_t *counter, size_t state,
+                            size_t *position) {
+    size_t pos = __atomic_load_n(counter, __ATOMIC_RELAXED);
+
+    for (;;) {
+        RingSlot *slot = &ring->slots[pos & ring->mask];
+        size_t seq = load_acquire(&slot->sequence);
+        long diff = (long)(seq - (pos + state));
+
+        if (diff == 0) {
+            if (__atomic_compare_exchange_n(counter, &pos, pos + 1, 1,
+                                            __ATOMIC_RELAXED,
+                                            __ATOMIC_RELAXED)) {
+                *position = pos;
+                return slot;
+            }
+        } else if (diff > 0) {
+            /* Another thread took this position; catch up */
+            pos = __atomic_load_n(counter, __ATOMIC_RELAXED);
+        }
+    }
+}
+
+/* ---------- Public API ---------- */
+
+int ring_init(Ring *ring, size_t capacity) {
+    if (!ring || capacity == 0) return -1;
+
+    memset(ring, 0, sizeof(*ring));
+
+    size_t size = 1;
+    while (size < capacity) size *= 2;
+
+    ring->slots = malloc(size * sizeof(RingSlot));
+    if (!ring->slots) return -1;
+
+    for (size_t i = 0; i < size; i++) {
+        ring->slots[i].sequence = i;
+        ring->slots[i].value = NULL;
+    }
+    ring->mask = size - 1;
+
+    if (sem_init(&ring->spaces, 0, (unsigned)size) != 0) {
+        free(ring->slots);
+        return -1;
+    }
+    if (sem_init(&ring->items, 0, 0) != 0) {
+        sem_destroy(&ring->spaces);
+        free(ring->slots);
+        return -1;
+    }
+
+    return 0;
+}
+
+void ring_push(Ring *ring, void *value) {
+    size_t pos;
+
+    wait_semaphore(&ring->spaces);
+
+    RingSlot *slot = claim_slot(ring, &ring->head, 0, &pos);
+    slot->value = value;
+    store_release(&slot->sequence, pos + 1);
+
+    sem_post(&ring->items);
+}
+
+void *ring_pop(Ring *ring) {
+    size_t pos;
+
+    wait_semaphore(&ring->items);
+
+    RingSlot *slot = claim_slot(ring, &ring->tail, 1, &pos);
+    void *value = slot->value;
+    store_release(&slot->sequence, pos + ring->mask + 1);
+
+    sem_post(&ring->spaces);
+    return value;
+}
+
+void ring_free(Ring *ring) {
+    if (!ring || !ring->slots) return;
+
+    sem_destroy(&ring->spaces);
+    sem_destroy(&ring->items);
+    free(ring->slots);
+    ring->slots = NULL;
+}
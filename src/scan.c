@@ -0,0 +1,306 @@
+#include "scan.h"
+
+#include <pthread.h>
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SCAN_X86 1
+#include <immintrin.h>
+#endif
+
+typedef size_t (*ScanFn)(const char *, size_t, size_t, size_t *, size_t);
+typedef size_t (*FindFn)(const char *, size_t, size_t, const ScanByteSet *);
+
+/* ---------- Scalar Kernel ---------- */
+
+static size_t scan_scalar(
+    const char *data,
+    size_t len,
+    size_t from,
+    size_t *out,
+    size_t max
+) {
+    size_t count = 0;
+
+    while (count < max && from < len) {
+        const char *nl = memchr(data + from, '\n', len - from);
+        if (!nl) break;
+
+        out[count++] = (size_t)(nl - data);
+        from = out[count - 1] + 1;
+    }
+
+    return count;
+}
+
+static size_t find_scalar(
+    const char *data,
+    size_t len,
+    size_t from,
+    const ScanByteSet *set
+) {
+    if (set->count == 1) {
+        const char *hit = memchr(data + from, set->bytes[0], len - from);
+        return hit ? (size_t)(hit - data) : len;
+    }
+
+    const unsigned char *p = (const unsigned char *)data;
+    while (from < len && !set->member[p[from]]) from++;
+    return from;
+}
+
+/* ---------- x86 Kernels ---------- */
+
+#ifdef SCAN_X86
+
+/*
+ * Appends the offsets of the set bits of a 64-byte block mask.
+ * Returns the new count; stops early when out is full.
+ */
+static size_t emit_block(
+    uint64_t mask,
+    size_t base,
+    size_t *out,
+    size_t count,
+    size_t max
+) {
+    while (mask && count < max) {
+        out[count++] = base + (size_t)__builtin_ctzll(mask);
+        mask &= mask - 1;
+    }
+
+    return count;
+}
+
+__attribute__((target("sse2")))
+static size_t scan_sse2(
+    const char *data,
+    size_t len,
+    size_t from,
+    size_t *out,
+    size_t max
+) {
+    const __m128i nl = _mm_set1_epi8('\n');
+    size_t count = 0;
+    size_t i = from;
+
+    for (; count < max && len - i >= 64; i += 64) {
+        const __m128i *p = (const __m128i *)(data + i);
+        uint64_t m0 = (unsigned)_mm_movemask_epi8(
+            _mm_cmpeq_epi8(_mm_loadu_si128(p), nl));
+        uint64_t m1 = (unsigned)_mm_movemask_epi8(
+            _mm_cmpeq_epi8(_mm_loadu_si128(p + 1), nl));
+        uint64_t m2 = (unsigned)_mm_movemask_epi8(
+            _mm_cmpeq_epi8(_mm_loadu_si128(p + 2), nl));
+        uint64_t m3 = (unsigned)_mm_movemask_epi8(
+            _mm_cmpeq_epi8(_mm_loadu_si128(p + 3), nl));
+
+        count = emit_block(m0 | m1 << 16 | m2 << 32 | m3 << 48,
+                           i, out, count, max);
+    }
+
+    if (count == max) return count;
+    return count + scan_scalar(data, len, i, out + count, max - count);
+}
+
+__attribute__((target("avx2")))
+static size_t scan_avx2(
+    const char *data,
+    size_t len,
+    size_t from,
+    size_t *out,
+    size_t max
+) {
+    const __m256i nl = _mm256_set1_epi8('\n');
+    size_t count = 0;
+    size_t i = from;
+
+    for (; count < max && len - i >= 64; i += 64) {
+        const __m256i *p = (const __m256i *)(data + i);
+        uint64_t lo = (unsigned)_mm256_movemask_epi8(
+            _mm256_cmpeq_epi8(_mm256_loadu_si256(p), nl));
+        uint64_t hi = (unsigned)_mm256_movemask_epi8(
+            _mm256_cmpeq_epi8(_mm256_loadu_si256(p + 1), nl));
+
+        count = emit_block(lo | hi << 32, i, out, count, max);
+    }
+
+    if (count == max) return count;
+    return count + scan_scalar(data, len, i, out + count, max - count);
+}
+
+/*
+ * Byte set search: OR of one compare per set byte, 16 bytes per step.
+ * Single bytes go to memchr(), large sets to the table loop.
+ */
+__attribute__((target("sse2")))
+static size_t find_sse2(
+    const char *data,
+    size_t len,
+    size_t from,
+    const ScanByteSet *set
+) {
+    if (set->count <= 1 || set->count > SCAN_SET_MAX) {
+        return find_scalar(data, len, from, set);
+    }
+
+    __m128i needles[SCAN_SET_MAX];
+    for (size_t k = 0; k < set->count; k++) {
+        needles[k] = _mm_set1_epi8((char)set->bytes[k]);
+    }
+
+    size_t i = from;
+    for (; len - i >= 16; i += 16) {
+        __m128i chunk = _mm_loadu_si128((const __m128i *)(data + i));
+        __m128i hit = _mm_cmpeq_epi8(chunk, needles[0]);
+        for (size_t k = 1; k < set->count; k++) {
+            hit = _mm_or_si128(hit, _mm_cmpeq_epi8(chunk, needles[k]));
+        }
+
+        unsigned mask = (unsigned)_mm_movemask_epi8(hit);
+        if (mask) return i + (size_t)__builtin_ctz(mask);
+    }
+
+    return find_scalar(data, len, i, set);
+}
+
+__attribute__((target("avx2")))
+static size_t find_avx2(
+    const char *data,
+    size_t len,
+    size_t from,
+    const ScanByteSet *set
+) {
+    if (set->count <= 1 || set->count > SCAN_SET_MAX) {
+        return find_scalar(data, len, from, set);
+    }
+
+    __m256i needles[SCAN_SET_MAX];
+    for (size_t k = 0; k < set->count; k++) {
+        needles[k] = _mm256_set1_epi8((char)set->bytes[k]);
+    }
+
+    size_t i = from;
+    for (; len - i >= 32; i += 32) {
+        __m256i chunk = _mm256_loadu_si256((const __m256i *)(data + i));
+        __m256i hit = _mm256_cmpeq_epi8(chunk, needles[0]);
+        for (size_t k = 1; k < set->count; k++) {
+            hit = _mm256_or_si256(hit, _mm256_cmpeq_epi8(chunk, needles[k]));
+        }
+
+        unsigned mask = (unsigned)_mm256_movemask_epi8(hit);
+        if (mask) return i + (size_t)__builtin_ctz(mask);
+    }
+
+    /* A short tail (most of a log line) still gets 16-byte steps */
+    return find_sse2(data, len, i, set);
+}
+
+#endif
+
+/* ---------- Dispatch ---------- */
+
+static const ScanFn KERNELS[SCAN_KERNEL_COUNT] = {
+#ifdef SCAN_X86
+    scan_scalar, scan_sse2, scan_avx2
+#else
+    scan_scalar, NULL, NULL
+#endif
+};
+
+static const FindFn FIND_KERNELS[SCAN_KERNEL_COUNT] = {
+#ifdef SCAN_X86
+    find_scalar, find_sse2, find_avx2
+#else
+    find_scalar, NULL, NULL
+#endif
+};
+
+static pthread_once_t detect_once = PTHREAD_ONCE_INIT;
+static ScanKernel active_kernel = SCAN_SCALAR;
+
+static int kernel_supported(ScanKernel kernel) {
+    if ((int)kernel < 0 || kernel >= SCAN_KERNEL_COUNT) return 0;
+    if (!KERNELS[kernel]) return 0;
+
+#ifdef SCAN_X86
+    __builtin_cpu_init();
+    if (kernel == SCAN_SSE2) return __builtin_cpu_supports("sse2");
+    if (kernel == SCAN_AVX2) return __builtin_cpu_supports("avx2");
+#endif
+
+    return 1;
+}
+
+static void detect_kernel(void) {
+    for (int k = SCAN_KERNEL_COUNT - 1; k > SCAN_SCALAR; k--) {
+        if (kernel_supported((ScanKernel)k)) {
+            active_kernel = (ScanKernel)k;
+            return;
+        }
+    }
+}
+
+/* ---------- Public API ---------- */
+
+size_t scan_newlines(
+    const char *data,
+    size_t len,
+    size_t from,
+    size_t *out,
+    size_t max
+) {
+    if (!data || !out || from >= len || max == 0) return 0;
+
+    pthread_once(&detect_once, detect_kernel);
+    return KERNELS[active_kernel](data, len, from, out, max);
+}
+
+void scan_byte_set_init(ScanByteSet *set) {
+    if (!set) return;
+
+    memset(set, 0, sizeof(*set));
+}
+
+void scan_byte_set_add(ScanByteSet *set, unsigned char byte) {
+    if (!set || set->member[byte]) return;
+
+    set->member[byte] = 1;
+    if (set->count < SCAN_SET_MAX) set->bytes[set->count] = byte;
+    set->count++;
+}
+
+size_t scan_find_any(
+    const char *data,
+    size_t len,
+    size_t from,
+    const ScanByteSet *set
+) {
+    if (!data || !set || from >= len) return len;
+
+    pthread_once(&detect_once, detect_kernel);
+    return FIND_KERNELS[active_kernel](data, len, from, set);
+}
+
+ScanKernel scan_kernel(void) {
+    pthread_once(&detect_once, detect_kernel);
+    return active_kernel;
+}
+
+int scan_use_kernel(ScanKernel kernel) {
+    pthread_once(&detect_once, detect_kernel);
+    if (!kernel_supported(kernel)) return -1;
+
+    active_kernel = kernel;
+    return 0;
+}
+
+const char *scan_kernel_name(ScanKernel kernel) {
+    switch (kernel) {
+        case SCAN_SCALAR: return "scalar";
+        case SCAN_SSE2:   return "sse2";
+        case SCAN_AVX2:   return "avx2";
+        default:          return "unknown";
+    }
+}
@@ -0,0 +1,784 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "serve.h"
+#include "follow.h"
+#include "parallel.h"
+#include "report.h"
+#include "sink.h"
+#include "utils.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#ifdef __linux__
+
+#include <fcntl.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+/* Upper bound on how long the loop sleeps without re-checking files */
+#define POLL_TIMEOUT_MS 1000
+
+/* Input taken from one source per loop iteration */
+#define CLIENT_READ_SIZE (64 * 1024)
+#define FILE_STEP_SIZE   (256 * 1024)
+
+/* A client line this long is processed without waiting for its newline */
+#define MAX_LINE_SIZE (1024 * 1024)
+
+/* Unsent output above which a client's input is left unread */
+#define MAX_PENDING_OUTPUT (16 * 1024 * 1024)
+
+#define MAX_EVENTS 64
+
+/* Longest line still checked for being a query */
+#define MAX_QUERY_LEN 64
+
+typedef struct {
+    int fd;
+
+    /* Bytes received but not yet processed (a partial last line) */
+    char *input;
+    size_t input_len;
+    size_t input_capacity;
+
+    ReportSink output;  // responses; buffer[sent, used) is unsent
+    size_t sent;
+
+    int eof;         // peer finished sending; close once output is sent
+    int queried;     // sent a valid query, so it reads replies
+    uint32_t events; // currently registered with epoll
+} Client;
+
+typedef struct {
+    AnalysisResult *result;
+    LogParser parser;  // for lines sent by clients
+    size_t processed;  // lines parsed successfully (files: once closed)
+    size_t top_n;
+    bool errors_only;
+
+    int listen_fd;
+    int epoll_fd;
+
+    Client **clients;  // by descriptor
+    size_t client_slots;
+
+    Follower **files;
+    int *file_ready;  // more input may be waiting
+    size_t file_count;
+} Server;
+
+typedef enum {
+    QUERY_NONE,
+    QUERY_SUMMARY,
+    QUERY_TOP,
+    QUERY_BUCKETS,
+    QUERY_REPORT,
+    QUERY_UNKNOWN   // shaped like a query, but no query has that name
+} QueryKind;
+
+static volatile sig_atomic_t stop_requested = 0;
+
+/* ---------- Helpers ---------- */
+
+static void handle_stop(int sig) {
+    (void)sig;
+    stop_requested = 1;
+}
+
+static long long monotonic_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static int set_nonblocking(int fd) {
+    int flags = fcntl(fd, F_GETFL);
+    if (flags < 0 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) != 0) return -1;
+    return fcntl(fd, F_SETFD, FD_CLOEXEC);
+}
+
+/*
+ * Returns non-zero if `path` is a socket nobody is listening on, left
+ * behind by a server that did not shut down cleanly.
+ */
+static int is_stale_socket(const char *path, const struct sockaddr_un *addr) {
+    struct stat st;
+    if (stat(path, &st) != 0 || !S_ISSOCK(st.st_mode)) return 0;
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) return 0;
+
+    int stale = connect(fd, (const struct sockaddr *)addr,
+                        sizeof(*addr)) != 0 && errno == ECONNREFUSED;
+    close(fd);
+    return stale;
+}
+
+/*
+ * Creates the listening socket, replacing a stale one at `path`.
+ * Returns the descriptor, or -1 (an error has been printed).
+ */
+static int open_listener(const char *path) {
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+
+    if (strlen(path) >= sizeof(addr.sun_path)) {
+        fprintf(stderr, "Error: Socket path too long: '%s'\n", path);
+        return -1;
+    }
+    strcpy(addr.sun_path, path);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        fprintf(stderr, "Error: Could not create socket: %s\n",
+                strerror(errno));
+        return -1;
+    }
+
+    int bound = bind(fd, (struct sockaddr *)&addr, sizeof(addr));
+    if (bound != 0 && errno == EADDRINUSE && is_stale_socket(path, &addr)) {
+        unlink(path);
+        bound = bind(fd, (struct sockaddr *)&addr, sizeof(addr));
+    }
+
+    if (bound != 0 || listen(fd, SOMAXCONN) != 0 ||
+        set_nonblocking(fd) != 0) {
+        fprintf(stderr, "Error: Could not listen on '%s': %s\n",
+                path, strerror(errno));
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+static int is_letter(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+}
+
+/*
+ * Parses a positive count; returns 0 if `arg` is not one.
+ */
+static int parse_count(const char *arg, size_t *out) {
+    char *end = NULL;
+    errno = 0;
+
+    unsigned long long value = strtoull(arg, &end, 10);
+    if (errno != 0 || end == arg || *end != '\0' || value == 0 ||
+        arg[0] == '-') {
+        return 0;
+    }
+
+    *out = (size_t)value;
+    return 1;
+}
+
+/*
+ * Classifies a client line. A line is a query if its first word is a
+ * query name; the argument after it, if any, is parsed into *count.
+ * A short line of one word of letters and at most one argument that
+ * names no query ("SUMMARY", "sumary") is QUERY_UNKNOWN. It may still
+ * be log text (a continuation line such as "Caused by"), so the caller
+ * decides whether it deserves an answer.
+ * Returns QUERY_NONE for log lines. *bad is set when the query's
+ * argument is missing where required or invalid.
+ */
+static QueryKind classify_line(
+    const char *line,
+    size_t len,
+    size_t *count,
+    int *bad
+) {
+    static const struct {
+        const char *name;
+        QueryKind kind;
+        int takes_count;
+    } queries[] = {
+        { "summary", QUERY_SUMMARY, 0 },
+        { "top",     QUERY_TOP,     1 },
+        { "buckets", QUERY_BUCKETS, 1 },
+        { "report",  QUERY_REPORT,  0 }
+    };
+
+    /* Log lines start with a timestamp; skip them cheaply */
+    if (len == 0 || len > MAX_QUERY_LEN || !is_letter(line[0])) {
+        return QUERY_NONE;
+    }
+
+    char text[MAX_QUERY_LEN + 1];
+    memcpy(text, line, len);
+    while (len > 0 && (text[len - 1] == '\r' || text[len - 1] == ' ')) len--;
+    text[len] = '\0';
+
+    char *arg = strchr(text, ' ');
+    if (arg) {
+        *arg++ = '\0';
+        while (*arg == ' ') arg++;
+    }
+
+    for (size_t i = 0; i < sizeof(queries) / sizeof(queries[0]); i++) {
+        if (strcmp(text, queries[i].name) != 0) continue;
+
+        *count = 0;
+        *bad = arg && (!queries[i].takes_count || !parse_count(arg, count));
+        return queries[i].kind;
+    }
+
+    /* Longer text (a continuation line, say) is left to the parser */
+    for (const char *p = text; *p; p++) {
+        if (!is_letter(*p)) return QUERY_NONE;
+    }
+    if (arg && strchr(arg, ' ')) return QUERY_NONE;
+
+    *count = 0;
+    *bad = 0;
+    return QUERY_UNKNOWN;
+}
+
+/* ---------- Queries ---------- */
+
+static void answer_error(ReportSink *out, const char *message) {
+    sink_puts(out, "{\"error\":\"");
+    sink_json_string(out, message, strlen(message));
+    sink_puts(out, "\"}\n");
+}
+
+/*
+ * Appends the answer to one query to the client's output.
+ */
+static void answer_query(
+    Server *s,
+    Client *c,
+    QueryKind kind,
+    size_t count,
+    int bad
+) {
+    ReportSink *out = &c->output;
+    AnalysisResult *result = s->result;
+
+    if (kind == QUERY_UNKNOWN) {
+        answer_error(out, "unknown query");
+        return;
+    }
+    if (bad) {
+        answer_error(out, kind == QUERY_TOP || kind == QUERY_BUCKETS
+                              ? "expected a positive count"
+                              : "unexpected argument");
+        return;
+    }
+
+    if (finalize_analysis(result) != 0) {
+        answer_error(out, "out of memory");
+        return;
+    }
+
+    if (kind == QUERY_SUMMARY) {
+        sink_putc(out, '{');
+        print_summary_json(out, result, s->errors_only);
+        sink_puts(out, "}\n");
+
+    } else if (kind == QUERY_TOP) {
+        TopErrors top;
+        if (top_errors_select(&top, result, count ? count : s->top_n) != 0) {
+            answer_error(out, "out of memory");
+            return;
+        }
+
+        sink_putc(out, '{');
+        print_top_errors_json(out, result, &top);
+        sink_puts(out, "}\n");
+        top_errors_free(&top);
+
+    } else if (kind == QUERY_BUCKETS) {
+        size_t buckets = result->time_bucket_count;
+        size_t first = count && count < buckets ? buckets - count : 0;
+
+        sink_putc(out, '{');
+        print_time_buckets_json(out, result, first);
+        sink_puts(out, "}\n");
+
+    } else if (kind == QUERY_REPORT) {
+        TopErrors top;
+        TopFields fields;
+        if (top_errors_select(&top, result, s->top_n) != 0) {
+            answer_error(out, "out of memory");
+            return;
+        }
+        if (top_fields_select(&fields, result, s->top_n) != 0) {
+            top_errors_free(&top);
+            answer_error(out, "out of memory");
+            return;
+        }
+
+        print_report_json(out, result, s->errors_only, &top, &fields,
+                          NULL, 0);
+        top_fields_free(&fields);
+        top_errors_free(&top);
+    }
+}
+
+/* ---------- Clients ---------- */
+
+/*
+ * Analyzes the complete lines in a client's input and answers its
+ * queries in order; with `flush`, also a trailing partial line.
+ */
+static void process_input(Server *s, Client *c, int flush) {
+    const char *data = c->input;
+    const char *end = data + c->input_len;
+    const char *pos = data;
+    const char *run = data;  // start of log lines not yet analyzed
+
+    while (pos < end) {
+        const char *nl = memchr(pos, '\n', (size_t)(end - pos));
+        if (!nl && !flush) break;
+
+        const char *line_end = nl ? nl : end;
+        const char *next = nl ? nl + 1 : end;
+        size_t count;
+        int bad;
+        QueryKind kind = classify_line(pos, (size_t)(line_end - pos),
+                                       &count, &bad);
+
+        /*
+         * Only a client known to read replies hears about a misspelt
+         * query; for one that only writes logs it is a log line, and
+         * unread replies would pile up until its input is throttled.
+         */
+        if (kind == QUERY_UNKNOWN && !c->queried) kind = QUERY_NONE;
+        if (kind != QUERY_NONE && kind != QUERY_UNKNOWN) c->queried = 1;
+
+        if (kind != QUERY_NONE) {
+            if (pos > run) {
+                s->processed += analyze_buffer(s->result, &s->parser, run,
+                                               (size_t)(pos - run));
+            }
+            answer_query(s, c, kind, count, bad);
+            run = next;
+        }
+        pos = next;
+    }
+
+    if (pos > run) {
+        s->processed += analyze_buffer(s->result, &s->parser, run,
+                                       (size_t)(pos - run));
+    }
+
+    c->input_len = (size_t)(end - pos);
+    memmove(c->input, pos, c->input_len);
+}
+
+static void close_client(Server *s, Client *c) {
+    epoll_ctl(s->epoll_fd, EPOLL_CTL_DEL, c->fd, NULL);
+    close(c->fd);
+    s->clients[c->fd] = NULL;
+
+    sink_close(&c->output);
+    free(c->input);
+    free(c);
+}
+
+/*
+ * Sends as much pending output as the socket takes.
+ * Returns 0 on success, non-zero if the client went away.
+ */
+static int send_output(Client *c) {
+    while (c->sent < c->output.used) {
+        ssize_t n = send(c->fd, c->output.buffer + c->sent,
+                         c->output.used - c->sent, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+        if (n < 0) return -1;
+
+        c->sent += (size_t)n;
+    }
+
+    if (c->sent == c->output.used) {
+        c->output.used = 0;
+        c->sent = 0;
+    }
+    return 0;
+}
+
+/*
+ * Reads one batch of a client's input and processes it.
+ * Returns 0 on success, non-zero if the client must be dropped.
+ */
+static int read_input(Server *s, Client *c) {
+    if (c->input_len == c->input_capacity) {
+        if (c->input_capacity >= MAX_LINE_SIZE) {
+            /* One huge line: take it as it is */
+            process_input(s, c, 1);
+        } else {
+            size_t capacity = c->input_capacity * 2;
+            char *input = realloc(c->input, capacity);
+            if (!input) return -1;
+
+            c->input = input;
+            c->input_capacity = capacity;
+        }
+    }
+
+    size_t room = c->input_capacity - c->input_len;
+    if (room > CLIENT_READ_SIZE) room = CLIENT_READ_SIZE;
+
+    ssize_t n = read(c->fd, c->input + c->input_len, room);
+    if (n < 0) {
+        return errno == EINTR || errno == EAGAIN ||
+               errno == EWOULDBLOCK ? 0 : -1;
+    }
+
+    if (n == 0) {
+        c->eof = 1;
+        process_input(s, c, 1);
+    } else {
+        c->input_len += (size_t)n;
+        process_input(s, c, 0);
+    }
+    return 0;
+}
+
+/*
+ * Handles epoll events for a client, then registers interest in input
+ * while its unsent output is small and in writability while any is
+ * left. Closes the client when it is done or gone.
+ */
+static void serve_client(Server *s, Client *c, uint32_t events) {
+    int gone = (events & EPOLLERR) != 0;
+
+    if (!gone && !c->eof && (events & (EPOLLIN | EPOLLHUP))) {
+        gone = read_input(s, c) != 0;
+    }
+    if (!gone) gone = c->output.failed || send_output(c) != 0;
+
+    size_t pending = c->output.used - c->sent;
+    if (gone || (c->eof && pending == 0)) {
+        close_client(s, c);
+        return;
+    }
+
+    uint32_t wanted = 0;
+    if (!c->eof && pending < MAX_PENDING_OUTPUT) wanted |= EPOLLIN;
+    if (pending > 0) wanted |= EPOLLOUT;
+
+    if (wanted != c->events) {
+        struct epoll_event ev;
+        memset(&ev, 0, sizeof(ev));
+        ev.events = wanted;
+        ev.data.fd = c->fd;
+        epoll_ctl(s->epoll_fd, EPOLL_CTL_MOD, c->fd, &ev);
+        c->events = wanted;
+    }
+}
+
+/*
+ * Accepts every pending connection.
+ */
+static void accept_clients(Server *s) {
+    for (;;) {
+        int fd = accept(s->listen_fd, NULL, NULL);
+        if (fd < 0 && errno == EINTR) continue;
+        if (fd < 0) return;
+
+        Client *c = calloc(1, sizeof(*c));
+        if (c) {
+            c->fd = fd;
+            c->input_capacity = BUFFER_SIZE;
+            c->input = malloc(c->input_capacity);
+            if (!c->input || sink_open_memory(&c->output) != 0) {
+                free(c->input);
+                free(c);
+                c = NULL;
+            }
+        }
+
+        if ((size_t)fd >= s->client_slots && c) {
+            size_t slots = s->client_slots ? s->client_slots : 64;
+            while (slots <= (size_t)fd) slots *= 2;
+
+            Client **clients = realloc(s->clients, slots * sizeof(*clients));
+            if (clients) {
+                memset(clients + s->client_slots, 0,
+                       (slots - s->client_slots) * sizeof(*clients));
+                s->clients = clients;
+                s->client_slots = slots;
+            }
+        }
+
+        struct epoll_event ev;
+        memset(&ev, 0, sizeof(ev));
+        ev.events = EPOLLIN;
+        ev.data.fd = fd;
+
+        if (!c || (size_t)fd >= s->client_slots || set_nonblocking(fd) != 0 ||
+            epoll_ctl(s->epoll_fd, EPOLL_CTL_ADD, fd, &ev) != 0) {
+            if (c) {
+                sink_close(&c->output);
+                free(c->input);
+                free(c);
+            }
+            close(fd);
+            continue;
+        }
+
+        c->events = EPOLLIN;
+        s->clients[fd] = c;
+    }
+}
+
+/* ---------- Server ---------- */
+
+/*
+ * Opens the followed files and registers their change notifications.
+ * Returns 0 on success, non-zero on failure (an error has been printed).
+ */
+static int open_files(
+    Server *s,
+    char *const *files,
+    size_t file_count,
+    const LineFilter *filter
+) {
+    if (file_count == 0) return 0;
+
+    s->files = calloc(file_count, sizeof(*s->files));
+    s->file_ready = calloc(file_count, sizeof(*s->file_ready));
+    if (!s->files || !s->file_ready) {
+        fprintf(stderr, "Error: Memory allocation failed\n");
+        return -1;
+    }
+
+    for (; s->file_count < file_count; s->file_count++) {
+        size_t i = s->file_count;
+
+        s->files[i] = follower_open(files[i], filter, s->result);
+        if (!s->files[i]) {
+            fprintf(stderr, "Error: Could not open file '%s'\n", files[i]);
+            return -1;
+        }
+        s->file_ready[i] = 1;
+
+        int fd = follower_notify_fd(s->files[i]);
+        if (fd >= 0) {
+            struct epoll_event ev;
+            memset(&ev, 0, sizeof(ev));
+            ev.events = EPOLLIN;
+            ev.data.fd = fd;
+            epoll_ctl(s->epoll_fd, EPOLL_CTL_ADD, fd, &ev);
+        }
+    }
+
+    return 0;
+}
+
+/*
+ * Reads the next step of every file with input waiting.
+ * Returns 1 if any file has more, 0 if all caught up, -1 on read error.
+ */
+static int step_files(Server *s) {
+    int more = 0;
+
+    for (size_t i = 0; i < s->file_count; i++) {
+        if (!s->file_ready[i]) continue;
+
+        int ready = follower_step(s->files[i], FILE_STEP_SIZE);
+        if (ready < 0) return -1;
+
+        s->file_ready[i] = ready;
+        more |= ready;
+    }
+
+    return more;
+}
+
+static void mark_files_ready(Server *s, int notify_fd) {
+    for (size_t i = 0; i < s->file_count; i++) {
+        if (notify_fd < 0 || follower_notify_fd(s->files[i]) == notify_fd) {
+            s->file_ready[i] = 1;
+        }
+    }
+}
+
+static int is_notify_fd(const Server *s, int fd) {
+    for (size_t i = 0; i < s->file_count; i++) {
+        if (follower_notify_fd(s->files[i]) == fd) return 1;
+    }
+    return 0;
+}
+
+/*
+ * Runs the event loop until a stop signal or a file read error.
+ */
+static int run_loop(Server *s, const char *socket_path) {
+    struct epoll_event events[MAX_EVENTS];
+    long long next_check = monotonic_ms() + POLL_TIMEOUT_MS;
+
+    while (!stop_requested) {
+        int more = step_files(s);
+        if (more < 0) {
+            fprintf(stderr, "Error: Could not read a followed file\n");
+            return -1;
+        }
+
+        /* Without pending file input, sleep until the next check */
+        long long now = monotonic_ms();
+        int timeout = 0;
+        if (!more) {
+            timeout = now < next_check ? (int)(next_check - now) : 0;
+        }
+
+        int n = epoll_wait(s->epoll_fd, events, MAX_EVENTS, timeout);
+        if (n < 0 && errno != EINTR) {
+            fprintf(stderr, "Error: epoll_wait failed on '%s': %s\n",
+                    socket_path, strerror(errno));
+            return -1;
+        }
+
+        for (int i = 0; i < n; i++) {
+            int fd = events[i].data.fd;
+
+            if (fd == s->listen_fd) {
+                accept_clients(s);
+            } else if ((size_t)fd < s->client_slots && s->clients[fd]) {
+                serve_client(s, s->clients[fd], events[i].events);
+            } else if (is_notify_fd(s, fd)) {
+                mark_files_ready(s, fd);
+            }
+        }
+
+        /* Catch changes notifications miss (or cannot report at all) */
+        now = monotonic_ms();
+        if (now >= next_check) {
+            mark_files_ready(s, -1);
+            next_check = now + POLL_TIMEOUT_MS;
+        }
+    }
+
+    return 0;
+}
+
+static void free_server(Server *s) {
+    for (size_t fd = 0; fd < s->client_slots; fd++) {
+        Client *c = s->clients[fd];
+        if (!c) continue;
+
+        /* Count an unterminated last line, as for files */
+        process_input(s, c, 1);
+        close_client(s, c);
+    }
+    free(s->clients);
+
+    for (size_t i = 0; i < s->file_count; i++) {
+        s->processed += follower_close(s->files[i]);
+    }
+    free(s->files);
+    free(s->file_ready);
+
+    if (s->listen_fd >= 0) close(s->listen_fd);
+    if (s->epoll_fd >= 0) close(s->epoll_fd);
+}
+
+/* ---------- Public API ---------- */
+
+int serve_socket(
+    const char *socket_path,
+    char *const *files,
+    size_t file_count,
+    const LineFilter *filter,
+    AnalysisResult *result,
+    size_t top_n,
+    bool errors_only,
+    size_t *processed
+) {
+    if (!socket_path || (!files && file_count > 0) || !result ||
+        !processed) {
+        return -1;
+    }
+
+    Server s;
+    memset(&s, 0, sizeof(s));
+    s.result = result;
+    s.top_n = top_n;
+    s.errors_only = errors_only;
+    s.listen_fd = -1;
+    log_parser_init(&s.parser, filter);
+
+    s.epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (s.epoll_fd < 0) {
+        fprintf(stderr, "Error: Could not create epoll instance: %s\n",
+                strerror(errno));
+        return -1;
+    }
+
+    int status = open_files(&s, files, file_count, filter);
+    if (status == 0) {
+        s.listen_fd = open_listener(socket_path);
+        if (s.listen_fd < 0) status = -1;
+    }
+
+    if (status == 0) {
+        struct epoll_event ev;
+        memset(&ev, 0, sizeof(ev));
+        ev.events = EPOLLIN;
+        ev.data.fd = s.listen_fd;
+
+        if (epoll_ctl(s.epoll_fd, EPOLL_CTL_ADD, s.listen_fd, &ev) != 0) {
+            fprintf(stderr, "Error: Could not watch '%s': %s\n",
+                    socket_path, strerror(errno));
+            status = -1;
+        }
+    }
+
+    if (status == 0) {
+        struct sigaction sa;
+        memset(&sa, 0, sizeof(sa));
+        sa.sa_handler = handle_stop;
+        sigemptyset(&sa.sa_mask);
+        sigaction(SIGINT, &sa, NULL);
+        sigaction(SIGTERM, &sa, NULL);
+
+        status = run_loop(&s, socket_path);
+        unlink(socket_path);
+    }
+
+    free_server(&s);
+
+    *processed = s.processed;
+    return status;
+}
+
+#else
+
+int serve_socket(
+    const char *socket_path,
+    char *const *files,
+    size_t file_count,
+    const LineFilter *filter,
+    AnalysisResult *result,
+    size_t top_n,
+    bool errors_only,
+    size_t *processed
+) {
+    (void)socket_path;
+    (void)files;
+    (void)file_count;
+    (void)filter;
+    (void)result;
+    (void)top_n;
+    (void)errors_only;
+    (void)processed;
+
+    fprintf(stderr, "Error: --serve requires Linux (epoll)\n");
+    return -1;
+}
+
+#endif
@@ -0,0 +1,281 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "sink.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/uio.h>
+
+/* Initial buffer of a memory sink */
+#define MEMORY_SINK_SIZE 4096
+
+/* ---------- Helpers ---------- */
+
+/*
+ * Writes all of iov[0, count), resuming after short writes and EINTR.
+ * Returns 0 on success, non-zero on error.
+ */
+static int write_all(int fd, struct iovec *iov, int count) {
+    while (count > 0) {
+        ssize_t n = writev(fd, iov, count);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+
+        size_t done = (size_t)n;
+        while (count > 0 && done >= iov->iov_len) {
+            done -= iov->iov_len;
+            iov++;
+            count--;
+        }
+        if (count > 0) {
+            iov->iov_base = (char *)iov->iov_base + done;
+            iov->iov_len -= done;
+        }
+    }
+
+    return 0;
+}
+
+/*
+ * Writes the buffer followed by `len` bytes of data in one writev().
+ */
+static void flush_with(ReportSink *sink, const char *data, size_t len) {
+    struct iovec iov[2];
+    int count = 0;
+
+    if (sink->used > 0) {
+        iov[count].iov_base = sink->buffer;
+        iov[count].iov_len = sink->used;
+        count++;
+    }
+    if (len > 0) {
+        iov[count].iov_base = (void *)data;
+        iov[count].iov_len = len;
+        count++;
+    }
+
+    if (!sink->failed && write_all(sink->fd, iov, count) != 0) {
+        sink->failed = 1;
+    }
+    sink->used = 0;
+}
+
+/*
+ * Grows a memory sink to hold `len` more bytes. On OOM the sink is
+ * marked failed and its contents dropped.
+ * Returns 0 on success, non-zero on OOM.
+ */
+static int grow(ReportSink *sink, size_t len) {
+    size_t capacity = sink->capacity;
+    while (capacity - sink->used < len) capacity *= 2;
+
+    char *buffer = realloc(sink->buffer, capacity);
+    if (!buffer) {
+        sink->failed = 1;
+        sink->used = 0;
+        return -1;
+    }
+
+    sink->buffer = buffer;
+    sink->capacity = capacity;
+    return 0;
+}
+
+/*
+ * Makes room for `len` more bytes (len <= MEMORY_SINK_SIZE).
+ */
+static char *reserve(ReportSink *sink, size_t len) {
+    if (sink->capacity - sink->used < len) {
+        if (sink->fd >= 0) {
+            flush_with(sink, NULL, 0);
+        } else {
+            grow(sink, len);
+        }
+    }
+    return sink->buffer + sink->used;
+}
+
+/*
+ * JSON escape for each byte: 0 = copy, 'u' = \u00XX, else \<char>.
+ */
+static const char JSON_ESCAPES[256] = {
+    'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u',
+    'b', 't', 'n', 'u', 'f', 'r', 'u', 'u',
+    'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u',
+    'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u',
+    0, 0, '"', 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, '\\', 0, 0, 0
+};
+
+/* ---------- Public API ---------- */
+
+int sink_open(ReportSink *sink, const char *path) {
+    if (!sink) return -1;
+
+    memset(sink, 0, sizeof(*sink));
+    sink->fd = STDOUT_FILENO;
+
+    if (path) {
+        sink->fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (sink->fd < 0) return -1;
+        sink->owns_fd = 1;
+    }
+
+    sink->buffer = malloc(SINK_BUFFER_SIZE);
+    if (!sink->buffer) {
+        if (sink->owns_fd) close(sink->fd);
+        return -1;
+    }
+    sink->capacity = SINK_BUFFER_SIZE;
+
+    return 0;
+}
+
+int sink_open_memory(ReportSink *sink) {
+    if (!sink) return -1;
+
+    memset(sink, 0, sizeof(*sink));
+    sink->fd = -1;
+
+    sink->buffer = malloc(MEMORY_SINK_SIZE);
+    if (!sink->buffer) return -1;
+    sink->capacity = MEMORY_SINK_SIZE;
+
+    return 0;
+}
+
+void sink_write(ReportSink *sink, const char *data, size_t len) {
+    if (len <= sink->capacity - sink->used) {
+        memcpy(sink->buffer + sink->used, data, len);
+        sink->used += len;
+        return;
+    }
+
+    if (sink->fd < 0) {
+        if (grow(sink, len) != 0) return;
+        memcpy(sink->buffer + sink->used, data, len);
+        sink->used += len;
+        return;
+    }
+
+    /* Too big to buffer: send it along with what is pending */
+    if (len >= SINK_BUFFER_SIZE) {
+        flush_with(sink, data, len);
+        return;
+    }
+
+    flush_with(sink, NULL, 0);
+    memcpy(sink->buffer, data, len);
+    sink->used = len;
+}
+
+void sink_puts(ReportSink *sink, const char *s) {
+    sink_write(sink, s, strlen(s));
+}
+
+void sink_putc(ReportSink *sink, char c) {
+    *reserve(sink, 1) = c;
+    sink->used++;
+}
+
+void sink_uint(ReportSink *sink, unsigned long long value) {
+    sink_uint_padded(sink, value, 1);
+}
+
+void sink_int(ReportSink *sink, long long value) {
+    if (value < 0) {
+        sink_putc(sink, '-');
+        sink_uint(sink, 0ULL - (unsigned long long)value);
+    } else {
+        sink_uint(sink, (unsigned long long)value);
+    }
+}
+
+void sink_uint_padded(ReportSink *sink, unsigned long long value,
+                      int width) {
+    char digits[24];
+    int n = 0;
+
+    do {
+        digits[n++] = (char)('0' + value % 10);
+        value /= 10;
+    } while (value > 0);
+
+    while (n < width && n < (int)sizeof(digits)) digits[n++] = '0';
+
+    char *out = reserve(sink, (size_t)n);
+    for (int i = 0; i < n; i++) out[i] = digits[n - 1 - i];
+    sink->used += (size_t)n;
+}
+
+void sink_json_string(ReportSink *sink, const char *s, size_t len) {
+    static const char hex[] = "0123456789abcdef";
+    const unsigned char *p = (const unsigned char *)s;
+    const unsigned char *end = p + (s ? len : 0);
+
+    while (p < end) {
+        const unsigned char *run = p;
+        while (p < end && !JSON_ESCAPES[*p]) p++;
+        sink_write(sink, (const char *)run, (size_t)(p - run));
+        if (p == end) break;
+
+        char escape = JSON_ESCAPES[*p];
+        char *out = reserve(sink, 6);
+
+        out[0] = '\\';
+        if (escape == 'u') {
+            memcpy(out + 1, "u00", 3);
+            out[4] = hex[*p >> 4];
+            out[5] = hex[*p & 0xF];
+            sink->used += 6;
+        } else {
+            out[1] = escape;
+            sink->used += 2;
+        }
+        p++;
+    }
+}
+
+void sink_csv_field(ReportSink *sink, const char *s, size_t len) {
+    const char *end = s ? s + len : s;
+
+    sink_putc(sink, '"');
+
+    while (s < end) {
+        const char *quote = memchr(s, '"', (size_t)(end - s));
+        size_t run = quote ? (size_t)(quote - s) + 1 : (size_t)(end - s);
+
+        /* Copy through the quote, then double it */
+        sink_write(sink, s, run);
+        if (!quote) break;
+        sink_putc(sink, '"');
+        s = quote + 1;
+    }
+
+    sink_putc(sink, '"');
+}
+
+int sink_flush(ReportSink *sink) {
+    if (!sink || !sink->buffer) return -1;
+
+    if (sink->fd >= 0 && sink->used > 0) flush_with(sink, NULL, 0);
+    return sink->failed ? -1 : 0;
+}
+
+int sink_close(ReportSink *sink) {
+    if (!sink || !sink->buffer) return -1;
+
+    int status = sink_flush(sink);
+    if (sink->owns_fd && close(sink->fd) != 0) status = -1;
+
+    free(sink->buffer);
+    sink->buffer = NULL;
+    return status;
+}
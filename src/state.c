@@ -0,0 +1,357 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "state.h"
+#include "hashtable.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+/*
+ * Snapshot layout (all integers little-endian 64-bit):
+ *
+ *   magic "LOGSTATE", version, group_by
+ *   dev, ino, offset, last_line_len, last_line_hash
+ *   total_lines, info_count, warn_count, error_total
+ *   status_count, then rejected lines per ParseStatus
+ *   error_unique, then per error: count, length, message bytes
+ *   time_bucket_count, then per bucket: start_unix, total, info, warn, error
+ *   checksum (hash of everything before it)
+ *
+ * Errors are stored in first-occurrence order so that restored results
+ * rank ties exactly like a full re-analysis.
+ */
+#define STATE_MAGIC   "LOGSTATE"
+#define STATE_VERSION 2  // 2: rejected-line counters
+
+/* Growable output buffer */
+typedef struct {
+    char *data;
+    size_t len;
+    size_t capacity;
+    int failed;
+} Writer;
+
+/* Bounds-checked input cursor */
+typedef struct {
+    const char *p;
+    size_t left;
+    int bad;
+} Cursor;
+
+/* ---------- Helpers ---------- */
+
+static void put_bytes(Writer *w, const void *data, size_t len) {
+    if (w->failed) return;
+
+    if (w->len + len > w->capacity) {
+        size_t new_capacity = w->capacity ? w->capacity : 4096;
+        while (new_capacity < w->len + len) new_capacity *= 2;
+
+        char *new_data = realloc(w->data, new_capacity);
+        if (!new_data) {
+            w->failed = 1;
+            return;
+        }
+
+        w->data = new_data;
+        w->capacity = new_capacity;
+    }
+
+    memcpy(w->data + w->len, data, len);
+    w->len += len;
+}
+
+static void put_u64(Writer *w, uint64_t v) {
+    unsigned char b[8];
+    for (int i = 0; i < 8; i++) b[i] = (unsigned char)(v >> (8 * i));
+    put_bytes(w, b, sizeof(b));
+}
+
+static const char *get_bytes(Cursor *c, size_t len) {
+    if (c->bad || len > c->left) {
+        c->bad = 1;
+        return NULL;
+    }
+
+    const char *p = c->p;
+    c->p += len;
+    c->left -= len;
+    return p;
+}
+
+static uint64_t get_u64(Cursor *c) {
+    const unsigned char *b = (const unsigned char *)get_bytes(c, 8);
+    if (!b) return 0;
+
+    uint64_t v = 0;
+    for (int i = 0; i < 8; i++) v |= (uint64_t)b[i] << (8 * i);
+    return v;
+}
+
+/*
+ * Returns the length of the line ending just before `offset`
+ * (including its newline).
+ */
+static size_t last_line_length(const char *data, size_t offset) {
+    if (offset == 0) return 0;
+
+    const char *end = data + offset - 1;  // the newline
+    const char *p = end;
+    while (p > data && p[-1] != '\n') p--;
+
+    return (size_t)(end - p) + 1;
+}
+
+/* ---------- Public API ---------- */
+
+void state_checkpoint_init(
+    StateCheckpoint *checkpoint,
+    dev_t dev,
+    ino_t ino,
+    const char *data,
+    size_t offset
+) {
+    if (!checkpoint) return;
+
+    size_t line_len = last_line_length(data, offset);
+
+    checkpoint->dev = (uint64_t)dev;
+    checkpoint->ino = (uint64_t)ino;
+    checkpoint->offset = offset;
+    checkpoint->last_line_len = line_len;
+    checkpoint->last_line_hash =
+        line_len ? hash_bytes(data + offset - line_len, line_len) : 0;
+}
+
+int state_checkpoint_matches(
+    const StateCheckpoint *checkpoint,
+    dev_t dev,
+    ino_t ino,
+    const char *data,
+    size_t len
+) {
+    if (!checkpoint) return 0;
+
+    if (checkpoint->dev != (uint64_t)dev) return 0;
+    if (checkpoint->ino != (uint64_t)ino) return 0;
+    if (checkpoint->offset > len) return 0;  // truncated
+    if (checkpoint->offset == 0) return 1;
+
+    size_t offset = (size_t)checkpoint->offset;
+    return last_line_length(data, offset) == checkpoint->last_line_len &&
+           data[offset - 1] == '\n' &&
+           hash_bytes(data + offset - checkpoint->last_line_len,
+                      checkpoint->last_line_len) ==
+               checkpoint->last_line_hash;
+}
+
+int state_read(const char *path, StateSnapshot *snapshot) {
+    if (!path || !snapshot) return -1;
+
+    memset(snapshot, 0, sizeof(*snapshot));
+
+    FILE *file = fopen(path, "rb");
+    if (!file) {
+        if (errno == ENOENT) return 1;
+        fprintf(stderr, "Error: Could not open state file '%s'\n", path);
+        return -1;
+    }
+
+    /* Snapshots are compact; read the whole file */
+    Writer w = { NULL, 0, 0, 0 };
+    char chunk[BUFSIZ];
+    size_t n;
+    while ((n = fread(chunk, 1, sizeof(chunk), file)) > 0) {
+        put_bytes(&w, chunk, n);
+    }
+    int read_failed = ferror(file) || w.failed;
+    fclose(file);
+
+    if (read_failed) {
+        fprintf(stderr, "Error: Could not read state file '%s'\n", path);
+        free(w.data);
+        return -1;
+    }
+
+    Cursor c = { w.data, w.len, 0 };
+    const char *magic = get_bytes(&c, 8);
+    uint64_t version = get_u64(&c);
+
+    int valid = magic && memcmp(magic, STATE_MAGIC, 8) == 0 &&
+                version == STATE_VERSION && w.len >= 16 + 8;
+
+    /* Older snapshots lack counters; the caller starts over */
+    if (magic && memcmp(magic, STATE_MAGIC, 8) == 0 &&
+        version < STATE_VERSION) {
+        free(w.data);
+        return 2;
+    }
+
+    if (valid) {
+        /* Verify the trailing checksum before trusting any field */
+        Cursor tail = { w.data + w.len - 8, 8, 0 };
+        valid = hash_bytes(w.data, w.len - 8) == get_u64(&tail);
+    }
+
+    if (!valid) {
+        fprintf(stderr, "Error: '%s' is not a valid state file\n", path);
+        free(w.data);
+        return -1;
+    }
+
+    snapshot->group_by = (GroupBy)get_u64(&c);
+    snapshot->checkpoint.dev = get_u64(&c);
+    snapshot->checkpoint.ino = get_u64(&c);
+    snapshot->checkpoint.offset = get_u64(&c);
+    snapshot->checkpoint.last_line_len = get_u64(&c);
+    snapshot->checkpoint.last_line_hash = get_u64(&c);
+
+    snapshot->data = w.data;
+    snapshot->len = w.len - 8;
+    return 0;
+}
+
+int state_restore(const StateSnapshot *snapshot, AnalysisResult *result) {
+    if (!snapshot || !snapshot->data || !result) return -1;
+    if (snapshot->group_by != result->config.group_by) return -1;
+
+    /* Skip magic, version, group_by and the checkpoint */
+    Cursor c = { snapshot->data, snapshot->len, 0 };
+    get_bytes(&c, 8 + 8 * 7);
+
+    result->total_lines += (size_t)get_u64(&c);
+    result->info_count  += (size_t)get_u64(&c);
+    result->warn_count  += (size_t)get_u64(&c);
+    result->error_total += (size_t)get_u64(&c);
+
+    uint64_t statuses = get_u64(&c);
+    if (statuses > PARSE_STATUS_COUNT) return -1;
+    for (uint64_t i = 0; i < statuses; i++) {
+        result->rejected[i] += (size_t)get_u64(&c);
+    }
+
+    uint64_t errors = get_u64(&c);
+    for (uint64_t i = 0; i < errors && !c.bad; i++) {
+        size_t count = (size_t)get_u64(&c);
+        size_t len = (size_t)get_u64(&c);
+        const char *message = get_bytes(&c, len);
+
+        if (message &&
+            add_error_count(result, message, len, NULL, 0, count) != 0) {
+            return -1;
+        }
+    }
+
+    uint64_t buckets = get_u64(&c);
+    for (uint64_t i = 0; i < buckets && !c.bad; i++) {
+        TimeBucket b;
+        memset(&b, 0, sizeof(b));
+        b.start_unix = (long long)get_u64(&c);
+        b.total = (size_t)get_u64(&c);
+        b.info  = (size_t)get_u64(&c);
+        b.warn  = (size_t)get_u64(&c);
+        b.error = (size_t)get_u64(&c);
+
+        if (!c.bad && add_time_bucket_counts(result, &b) != 0) return -1;
+    }
+
+    return c.bad || c.left != 0 ? -1 : 0;
+}
+
+void state_snapshot_free(StateSnapshot *snapshot) {
+    if (!snapshot) return;
+
+    free(snapshot->data);
+    snapshot->data = NULL;
+    snapshot->len = 0;
+}
+
+int state_write(
+    const char *path,
+    const AnalysisResult *result,
+    const StateCheckpoint *checkpoint
+) {
+    if (!path || !result || !checkpoint) return -1;
+
+    Writer w = { NULL, 0, 0, 0 };
+
+    put_bytes(&w, STATE_MAGIC, 8);
+    put_u64(&w, STATE_VERSION);
+    put_u64(&w, (uint64_t)result->config.group_by);
+
+    put_u64(&w, checkpoint->dev);
+    put_u64(&w, checkpoint->ino);
+    put_u64(&w, checkpoint->offset);
+    put_u64(&w, checkpoint->last_line_len);
+    put_u64(&w, checkpoint->last_line_hash);
+
+    put_u64(&w, result->total_lines);
+    put_u64(&w, result->info_count);
+    put_u64(&w, result->warn_count);
+    put_u64(&w, result->error_total);
+
+    put_u64(&w, PARSE_STATUS_COUNT);
+    for (size_t i = 0; i < PARSE_STATUS_COUNT; i++) {
+        put_u64(&w, result->rejected[i]);
+    }
+
+    put_u64(&w, result->error_unique);
+    for (size_t i = 0; i < result->error_unique; i++) {
+        const ErrorEntry *e = &result->error_entries[i];
+        put_u64(&w, e->count);
+        put_u64(&w, e->message_len);
+        put_bytes(&w, error_entry_message(result, e), e->message_len);
+    }
+
+    put_u64(&w, result->time_bucket_count);
+    for (size_t i = 0; i < result->time_bucket_count; i++) {
+        const TimeBucket *b = &result->time_buckets[i];
+        put_u64(&w, (uint64_t)b->start_unix);
+        put_u64(&w, b->total);
+        put_u64(&w, b->info);
+        put_u64(&w, b->warn);
+        put_u64(&w, b->error);
+    }
+
+    put_u64(&w, w.failed ? 0 : hash_bytes(w.data, w.len));
+
+    if (w.failed) {
+        fprintf(stderr, "Error: Memory allocation failed\n");
+        free(w.data);
+        return -1;
+    }
+
+    /* Write a temporary file and rename it over the old snapshot */
+    size_t path_len = strlen(path);
+    char *tmp_path = malloc(path_len + 5);
+    if (!tmp_path) {
+        fprintf(stderr, "Error: Memory allocation failed\n");
+        free(w.data);
+        return -1;
+    }
+    memcpy(tmp_path, path, path_len);
+    memcpy(tmp_path + path_len, ".tmp", 5);
+
+    int status = -1;
+    FILE *file = fopen(tmp_path, "wb");
+    if (file) {
+        int ok = fwrite(w.data, 1, w.len, file) == w.len;
+        ok = (fclose(file) == 0) && ok;
+
+        if (ok && rename(tmp_path, path) == 0) {
+            status = 0;
+        } else {
+            remove(tmp_path);
+        }
+    }
+
+    if (status != 0) {
+        fprintf(stderr, "Error: Could not write state file '%s'\n", path);
+    }
+
+    free(tmp_path);
+    free(w.data);
+    return status;
+}
@@ -0,0 +1,144 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "stats.h"
+#include "parser.h"
+
+#include <string.h>
+#include <time.h>
+
+static const char *const STAGE_NAMES[STAGE_COUNT] = {
+    "read", "parse", "aggregate", "merge", "report"
+};
+
+/* ---------- Helpers ---------- */
+
+/* The index errors are counted through: exact table or summary */
+static const HashIndex *error_index(const AnalysisResult *result) {
+    return result->config.approx_top ? &result->heavy.index
+                                     : &result->error_index;
+}
+
+static double average_probes(const HashIndex *index) {
+    return index->lookups ? (double)index->probes / (double)index->lookups
+                          : 0.0;
+}
+
+static void print_stats_text(
+    FILE *out,
+    const StageTimes *times,
+    double wall,
+    const AnalysisResult *result,
+    size_t processed,
+    size_t rejected
+) {
+    double mb = (double)times->bytes / (1024.0 * 1024.0);
+
+    fprintf(out, "\nStats\n");
+    fprintf(out, "------------------\n");
+    fprintf(out, "Wall time       : %.6f s\n", wall);
+    for (int i = 0; i < STAGE_COUNT; i++) {
+        fprintf(out, "  %-13s : %.6f s\n", STAGE_NAMES[i],
+                times->seconds[i]);
+    }
+
+    fprintf(out, "Lines read      : %zu (%.1f MB", processed + rejected, mb);
+    if (wall > 0) fprintf(out, ", %.1f MB/s", mb / wall);
+    fprintf(out, ")\n");
+    fprintf(out, "Lines accepted  : %zu\n", processed);
+    fprintf(out, "Lines rejected  : %zu\n", rejected);
+    for (int i = PARSE_OK + 1; i < PARSE_STATUS_COUNT; i++) {
+        fprintf(out, "  %-13s : %zu\n", parse_status_name((ParseStatus)i),
+                result->rejected[i]);
+    }
+
+    fprintf(out, "Error index     : %zu lookups, %zu probes (%.2f avg)\n",
+            error_index(result)->lookups, error_index(result)->probes,
+            average_probes(error_index(result)));
+    fprintf(out, "Bucket index    : %zu lookups, %zu probes (%.2f avg)\n",
+            result->bucket_index.lookups, result->bucket_index.probes,
+            average_probes(&result->bucket_index));
+    fprintf(out, "Bucket inserts  : %zu (%zu dense, %zu hashed)\n",
+            result->bucket_inserts,
+            result->bucket_inserts - result->bucket_hash_inserts,
+            result->bucket_hash_inserts);
+}
+
+static void print_index_json(FILE *out, const char *name,
+                             const HashIndex *index) {
+    fprintf(out, "\"%s\":{\"lookups\":%zu,\"probes\":%zu},",
+            name, index->lookups, index->probes);
+}
+
+static void print_stats_json(
+    FILE *out,
+    const StageTimes *times,
+    double wall,
+    const AnalysisResult *result,
+    size_t processed,
+    size_t rejected
+) {
+    fprintf(out, "{\"stats\":{\"wall_seconds\":%.6f,\"stage_seconds\":{",
+            wall);
+    for (int i = 0; i < STAGE_COUNT; i++) {
+        fprintf(out, "%s\"%s\":%.6f", i ? "," : "", STAGE_NAMES[i],
+                times->seconds[i]);
+    }
+    fprintf(out, "},");
+
+    fprintf(out, "\"bytes_read\":%zu,\"lines_read\":%zu,"
+                 "\"lines_accepted\":%zu,\"lines_rejected\":{",
+            times->bytes, processed + rejected, processed);
+    for (int i = PARSE_OK + 1; i < PARSE_STATUS_COUNT; i++) {
+        fprintf(out, "%s\"%s\":%zu", i > PARSE_OK + 1 ? "," : "",
+                parse_status_name((ParseStatus)i), result->rejected[i]);
+    }
+    fprintf(out, "},");
+
+    print_index_json(out, "error_index", error_index(result));
+    print_index_json(out, "bucket_index", &result->bucket_index);
+    fprintf(out, "\"bucket_inserts\":%zu,\"bucket_hash_inserts\":%zu}}\n",
+            result->bucket_inserts, result->bucket_hash_inserts);
+}
+
+/* ---------- Public API ---------- */
+
+double stats_clock(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+void stage_times_init(StageTimes *times) {
+    if (times) memset(times, 0, sizeof(*times));
+}
+
+void stage_times_add(StageTimes *dst, const StageTimes *src) {
+    if (!dst || !src) return;
+
+    for (int i = 0; i < STAGE_COUNT; i++) {
+        dst->seconds[i] += src->seconds[i];
+    }
+    dst->bytes += src->bytes;
+}
+
+void print_stats(
+    FILE *out,
+    const StageTimes *times,
+    double wall,
+    const AnalysisResult *result,
+    size_t processed,
+    int json
+) {
+    if (!out || !times || !result) return;
+
+    size_t rejected = 0;
+    for (int i = 0; i < PARSE_STATUS_COUNT; i++) {
+        rejected += result->rejected[i];
+    }
+
+    if (json) {
+        print_stats_json(out, times, wall, result, processed, rejected);
+    } else {
+        print_stats_text(out, times, wall, result, processed, rejected);
+    }
+}
@@ -0,0 +1,158 @@
+#include "template.h"
+
+#include <string.h>
+
+/* ---------- Helpers ---------- */
+
+static int is_digit(unsigned char c) {
+    return c >= '0' && c <= '9';
+}
+
+static int is_hex(unsigned char c) {
+    return is_digit(c) || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+}
+
+static int is_word(unsigned char c) {
+    return is_digit(c) || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+           c == '_';
+}
+
+/* Token matchers: return the token length at p (n bytes left), or 0 */
+
+static size_t match_uuid(const unsigned char *p, size_t n) {
+    static const char layout[] = "xxxxxxxx-xxxx-xxxx-xxxx-xxxxxxxxxxxx";
+    const size_t uuid_len = sizeof(layout) - 1;
+
+    if (n < uuid_len) return 0;
+
+    for (size_t i = 0; i < uuid_len; i++) {
+        if (layout[i] == '-' ? p[i] != '-' : !is_hex(p[i])) return 0;
+    }
+
+    return n > uuid_len && is_word(p[uuid_len]) ? 0 : uuid_len;
+}
+
+static size_t match_ipv4(const unsigned char *p, size_t n) {
+    size_t i = 0;
+
+    for (int part = 0; part < 4; part++) {
+        if (part > 0) {
+            if (i >= n || p[i] != '.') return 0;
+            i++;
+        }
+
+        size_t digits = 0;
+        while (i < n && digits < 3 && is_digit(p[i])) {
+            i++;
+            digits++;
+        }
+        if (digits == 0) return 0;
+    }
+
+    /* Not a prefix of a longer word or dotted sequence */
+    if (i < n && (is_word(p[i]) ||
+                  (p[i] == '.' && i + 1 < n && is_digit(p[i + 1])))) {
+        return 0;
+    }
+
+    if (i + 1 < n && p[i] == ':' && is_digit(p[i + 1])) {
+        size_t j = i + 1;
+        while (j < n && is_digit(p[j])) j++;
+        if (j == n || !is_word(p[j])) i = j;
+    }
+
+    return i;
+}
+
+static size_t match_hex(const unsigned char *p, size_t n) {
+    size_t i = 0;
+
+    if (n > 2 && p[0] == '0' && (p[1] == 'x' || p[1] == 'X') &&
+        is_hex(p[2])) {
+        i = 2;
+        while (i < n && is_hex(p[i])) i++;
+        return i < n && is_word(p[i]) ? 0 : i;
+    }
+
+    int digits = 0;
+    int letters = 0;
+
+    for (; i < n && is_word(p[i]); i++) {
+        if (!is_hex(p[i])) return 0;
+        if (is_digit(p[i])) digits = 1; else letters = 1;
+    }
+
+    return i >= 4 && digits && letters ? i : 0;
+}
+
+static size_t match_number(const unsigned char *p, size_t n) {
+    size_t i = 0;
+
+    while (i < n && is_digit(p[i])) i++;
+    if (i > 0 && i + 1 < n && p[i] == '.' && is_digit(p[i + 1])) {
+        i++;
+        while (i < n && is_digit(p[i])) i++;
+    }
+
+    return i;
+}
+
+/* ---------- Public API ---------- */
+
+size_t mask_message(const char *message, size_t len, char *out) {
+    const unsigned char *p = (const unsigned char *)message;
+    size_t i = 0;
+    size_t o = 0;
+    int boundary = 1;  // the previous byte is not part of a word
+
+#define EMIT(placeholder)                                       \
+    do {                                                        \
+        memcpy(out + o, placeholder, sizeof(placeholder) - 1);  \
+        o += sizeof(placeholder) - 1;                           \
+    } while (0)
+
+    while (i < len) {
+        unsigned char c = p[i];
+        size_t n = len - i;
+        size_t m;
+
+        if (boundary && (c == '"' || c == '\'')) {
+            const unsigned char *close = memchr(p + i + 1, c, n - 1);
+            if (close) {
+                EMIT("<STR>");
+                i = (size_t)(close - p) + 1;
+                continue;
+            }
+        } else if (boundary && is_hex(c)) {
+            if ((m = match_uuid(p + i, n)) != 0) {
+                EMIT("<UUID>");
+                i += m;
+                continue;
+            }
+            if (is_digit(c) && (m = match_ipv4(p + i, n)) != 0) {
+                EMIT("<IP>");
+                i += m;
+                continue;
+            }
+            if ((m = match_hex(p + i, n)) != 0) {
+                EMIT("<HEX>");
+                i += m;
+                continue;
+            }
+            if ((m = match_number(p + i, n)) != 0) {
+                EMIT("<NUM>");
+                i += m;
+                boundary = 0;  // a unit suffix stays part of the word
+                continue;
+            }
+        }
+
+        out[o++] = (char)c;
+        boundary = !is_word(c);
+        i++;
+    }
+
+#undef EMIT
+
+    return o;
+}
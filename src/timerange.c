@@ -0,0 +1,179 @@
+#include "timerange.h"
+
+#include <limits.h>
+#include <string.h>
+
+/* Enough for both searches over any addressable buffer */
+#define MAX_PROBES 256
+
+/*
+ * Seconds a line may be older than a line before it (writers racing to
+ * append, buffered loggers). Both bounds are searched this much further
+ * out, so such lines still fall inside the window.
+ */
+#define JITTER_SLACK_SEC 60
+
+typedef struct {
+    size_t offset;
+    long long timestamp;
+} Probe;
+
+typedef struct {
+    const char *data;
+    size_t len;
+    LogParser parser;
+
+    /* Every timestamp seen, to check the ordering assumption */
+    Probe probes[MAX_PROBES];
+    size_t probe_count;
+} Search;
+
+/* ---------- Helpers ---------- */
+
+/*
+ * Returns the first line start at or after pos (len if none).
+ */
+static size_t line_start_at(const char *data, size_t len, size_t pos) {
+    if (pos == 0) return 0;
+    if (pos >= len) return len;
+
+    const char *nl = memchr(data + pos - 1, '\n', len - pos + 1);
+    return nl ? (size_t)(nl - data) + 1 : len;
+}
+
+/*
+ * Finds the first line in [pos, limit) with a valid timestamp.
+ * Returns its start and stores the timestamp in *ts, or returns limit.
+ */
+static size_t probe_line(Search *s, size_t pos, size_t limit, long long *ts) {
+    while (pos < limit) {
+        const char *line = s->data + pos;
+        const char *nl = memchr(line, '\n', s->len - pos);
+        size_t line_len = nl ? (size_t)(nl - line) : s->len - pos;
+
+        if (line_len >= TIMESTAMP_LEN &&
+            parse_timestamp(&s->parser, line, ts) == 0) {
+            if (s->probe_count < MAX_PROBES) {
+                s->probes[s->probe_count].offset = pos;
+                s->probes[s->probe_count].timestamp = *ts;
+                s->probe_count++;
+            }
+            return pos;
+        }
+
+        pos += line_len + 1;
+    }
+
+    return limit;
+}
+
+/*
+ * Returns the start of the first line whose timestamp is >= t,
+ * assuming timestamps never decrease (lines without a valid timestamp
+ * are ignored).
+ */
+static size_t lower_bound(Search *s, long long t) {
+    size_t lo = 0;
+    size_t hi = s->len;
+
+    /* Invariant: lines before lo are < t, lines from hi on are >= t */
+    while (lo < hi) {
+        size_t pos = line_start_at(s->data, s->len, lo + (hi - lo) / 2);
+        if (pos >= hi) pos = lo;  // midpoint inside the last line
+
+        long long ts;
+        size_t line = probe_line(s, pos, hi, &ts);
+
+        if (line >= hi) {
+            hi = pos;  // nothing datable in [pos, hi)
+        } else if (ts < t) {
+            lo = line_start_at(s->data, s->len, line + 1);
+        } else {
+            hi = line;
+        }
+    }
+
+    return lo;
+}
+
+/*
+ * Returns non-zero if no probed timestamp is more than JITTER_SLACK_SEC
+ * older than one probed earlier in the buffer.
+ */
+static int probes_sorted(Search *s) {
+    /* Insertion sort by offset; there are only a few dozen probes */
+    for (size_t i = 1; i < s->probe_count; i++) {
+        Probe p = s->probes[i];
+        size_t j = i;
+        while (j > 0 && s->probes[j - 1].offset > p.offset) {
+            s->probes[j] = s->probes[j - 1];
+            j--;
+        }
+        s->probes[j] = p;
+    }
+
+    long long latest = LLONG_MIN;
+    for (size_t i = 0; i < s->probe_count; i++) {
+        long long ts = s->probes[i].timestamp;
+        if (ts > latest) latest = ts;
+        if (ts < latest - JITTER_SLACK_SEC) return 0;
+    }
+
+    return 1;
+}
+
+/* ---------- Public API ---------- */
+
+int find_time_window(
+    const char *data,
+    size_t len,
+    const LineFilter *filter,
+    size_t *start,
+    size_t *end
+) {
+    if (!data || !filter || !start || !end) return -1;
+
+    Search s;
+    s.data = data;
+    s.len = len;
+    s.probe_count = 0;
+    log_parser_init(&s.parser, NULL);
+
+    /*
+     * With lines at most JITTER_SLACK_SEC out of order, every line
+     * before the first one < since - slack is < since, and every line
+     * after the first one >= until + slack is >= until.
+     */
+    *start = filter->since < LLONG_MIN + JITTER_SLACK_SEC
+                 ? 0
+                 : lower_bound(&s, filter->since - JITTER_SLACK_SEC);
+    *end = filter->until > LLONG_MAX - JITTER_SLACK_SEC
+               ? len
+               : lower_bound(&s, filter->until + JITTER_SLACK_SEC);
+
+    if (!probes_sorted(&s)) return -1;
+    if (*end < *start) *end = *start;
+
+    return 0;
+}
+
+void narrow_to_time_window(
+    const FileReader *reader,
+    const LineFilter *filter,
+    const char **data,
+    size_t *len
+) {
+    if (!data || !*data || !len || !line_filter_has_range(filter)) return;
+
+    size_t start, end;
+
+    file_reader_advise(reader, 0, *len, 1);
+    if (find_time_window(*data, *len, filter, &start, &end) != 0) {
+        file_reader_advise(reader, 0, *len, 0);
+        return;
+    }
+    file_reader_advise(reader, start, end - start, 0);
+
+    *data += start;
+    *len = end - start;
+}
@@ -1,40 +1,398 @@
+#define _POSIX_C_SOURCE 200809L
+
 #include "utils.h"
 
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/* ---------- Helpers ---------- */
+
+/*
+ * Maps a regular, non-empty file into memory.
+ * Returns 0 on success, non-zero if the caller should use read().
+ */
+static int map_file(FileReader *reader) {
+    struct stat st;
+
+    if (fstat(reader->fd, &st) != 0) return -1;
+    if (!S_ISREG(st.st_mode) || st.st_size <= 0) return -1;
+
+    void *map = mmap(NULL, (size_t)st.st_size, PROT_READ,
+                     MAP_PRIVATE, reader->fd, 0);
+    if (map == MAP_FAILED) return -1;
+
+    /* Advisory only; failure is harmless */
+    posix_madvise(map, (size_t)st.st_size, POSIX_MADV_SEQUENTIAL);
+
+    reader->map = map;
+    reader->map_size = (size_t)st.st_size;
+    return 0;
+}
+
+static const char *read_line_mapped(FileReader *reader, size_t *len) {
+    if (reader->pos >= reader->map_size) return NULL;
+
+    const char *start = reader->map + reader->pos;
+    size_t remaining = reader->map_size - reader->pos;
+
+    const char *nl = memchr(start, '\n', remaining);
+    size_t line_len = nl ? (size_t)(nl - start) : remaining;
+
+    reader->pos += line_len + (nl ? 1 : 0);
+    *len = line_len;
+    return start;
+}
+
+/*
+ * Reads more data into the fallback buffer, compacting or growing it
+ * as needed. Returns the number of bytes read, 0 on EOF, -1 on error
+ * (which also marks the reader failed).
+ */
+static long fill_buffer(FileReader *reader) {
+    if (reader->buffer_start > 0) {
+        size_t pending = reader->buffer_end - reader->buffer_start;
+        memmove(reader->buffer,
+                reader->buffer + reader->buffer_start,
+                pending);
+        reader->buffer_start = 0;
+        reader->buffer_end = pending;
+    }
+
+    if (reader->buffer_end == reader->buffer_capacity) {
+        size_t new_capacity = reader->buffer_capacity * 2;
+        char *new_buffer = realloc(reader->buffer, new_capacity);
+        if (!new_buffer) {
+            reader->failed = 1;
+            return -1;
+        }
+
+        reader->buffer = new_buffer;
+        reader->buffer_capacity = new_capacity;
+    }
+
+    ssize_t n;
+    do {
+        n = read(reader->fd,
+                 reader->buffer + reader->buffer_end,
+                 reader->buffer_capacity - reader->buffer_end);
+    } while (n < 0 && errno == EINTR);
+
+    if (n < 0) {
+        reader->failed = 1;
+        return -1;
+    }
+    if (n == 0) return 0;
+
+    reader->buffer_end += (size_t)n;
+    return (long)n;
+}
+
+static const char *read_line_buffered(FileReader *reader, size_t *len) {
+    size_t scanned = 0;
+
+    for (;;) {
+        const char *start = reader->buffer + reader->buffer_start;
+        size_t pending = reader->buffer_end - reader->buffer_start;
+
+        const char *nl = memchr(start + scanned, '\n', pending - scanned);
+        if (nl) {
+            *len = (size_t)(nl - start);
+            reader->buffer_start += *len + 1;
+            return start;
+        }
+        scanned = pending;
+
+        if (reader->eof || fill_buffer(reader) <= 0) {
+            reader->eof = 1;
+
+            /* After an error the pending bytes are not a whole line */
+            if (pending == 0 || reader->failed) return NULL;
+
+            /* Final line without a trailing newline */
+            *len = pending;
+            reader->buffer_start = reader->buffer_end;
+            return reader->buffer + reader->buffer_end - pending;
+        }
+    }
+}
+
+/*
+ * Appends bytes to the carry buffer holding a line that spans blocks.
+ * Returns 0 on success, non-zero on allocation failure.
+ */
+static int carry_append(
+    FileReader *reader,
+    size_t *carry_len,
+    const char *data,
+    size_t len
+) {
+    if (*carry_len + len > reader->carry_capacity) {
+        size_t new_capacity = reader->carry_capacity
+                                  ? reader->carry_capacity : BUFFER_SIZE;
+        while (new_capacity < *carry_len + len) new_capacity *= 2;
+
+        char *new_carry = realloc(reader->carry, new_capacity);
+        if (!new_carry) {
+            reader->failed = 1;
+            return -1;
+        }
+
+        reader->carry = new_carry;
+        reader->carry_capacity = new_capacity;
+    }
+
+    memcpy(reader->carry + *carry_len, data, len);
+    *carry_len += len;
+    return 0;
+}
+
+static const char *read_line_compressed(FileReader *reader, size_t *len) {
+    size_t carry_len = 0;
+
+    for (;;) {
+        if (reader->block_pos >= reader->block_len) {
+            reader->block = decompressor_next(reader->decomp,
+                                              &reader->block_len);
+            reader->block_pos = 0;
+
+            if (!reader->block) {
+                reader->block_len = 0;
+                if (carry_len == 0) return NULL;
+
+                /* Final line without a trailing newline */
+                *len = carry_len;
+                return reader->carry;
+            }
+            continue;
+        }
+
+        const char *start = reader->block + reader->block_pos;
+        size_t remaining = reader->block_len - reader->block_pos;
+        const char *nl = memchr(start, '\n', remaining);
+
+        if (nl) {
+            size_t line_len = (size_t)(nl - start);
+            reader->block_pos += line_len + 1;
+
+            if (carry_len == 0) {
+                *len = line_len;
+                return start;
+            }
+
+            if (carry_append(reader, &carry_len, start, line_len) != 0) {
+                return NULL;
+            }
+            *len = carry_len;
+            return reader->carry;
+        }
+
+        /* Line continues in the next block */
+        if (carry_append(reader, &carry_len, start, remaining) != 0) {
+            return NULL;
+        }
+        reader->block_pos = reader->block_len;
+    }
+}
 
 /*
- * Opens a file for buffered reading.
+ * Starts decompression if the input carries a gzip or zstd header.
+ * `prefix` is the data already available (the mapping, or the start of
+ * the read() buffer); the rest is read from reader->fd when `use_fd`.
+ * Returns 0 on success (including plain input), non-zero on failure.
+ */
+static int start_decompression(
+    FileReader *reader,
+    const char *filename,
+    const char *prefix,
+    size_t prefix_len,
+    int use_fd
+) {
+    Compression type = detect_compression(prefix, prefix_len);
+    if (type == COMPRESSION_NONE) return 0;
+
+    if (!compression_supported(type)) {
+        fprintf(stderr, "Error: '%s' is %s-compressed but %s support "
+                        "was not compiled in\n",
+                filename, compression_name(type), compression_name(type));
+        return -1;
+    }
+
+    reader->decomp = decompressor_start(type, filename, prefix, prefix_len,
+                                        use_fd ? reader->fd : -1);
+    return reader->decomp ? 0 : -1;
+}
+
+/* ---------- Public API ---------- */
+
+/*
+ * Opens a file for reading.
  * Returns NULL on failure.
  */
 FileReader *file_reader_open(const char *filename) {
     if (!filename) return NULL;
 
-    FileReader *reader = malloc(sizeof(*reader));
+    FileReader *reader = calloc(1, sizeof(*reader));
     if (!reader) return NULL;
 
-    reader->file = fopen(filename, "r");
-    if (!reader->file) {
+    reader->fd = open(filename, O_RDONLY);
+    if (reader->fd < 0) {
         free(reader);
         return NULL;
     }
 
+    int status;
+
+    if (map_file(reader) == 0) {
+        status = start_decompression(reader, filename,
+                                     reader->map, reader->map_size, 0);
+    } else {
+        reader->buffer_capacity = BUFFER_SIZE;
+        reader->buffer = malloc(reader->buffer_capacity);
+        if (!reader->buffer) {
+            close(reader->fd);
+            free(reader);
+            return NULL;
+        }
+
+        /* Peek at the magic bytes; a short read is not yet EOF */
+        long n = 1;
+        while (reader->buffer_end < 4 && n > 0) n = fill_buffer(reader);
+        if (n <= 0) reader->eof = 1;
+
+        status = start_decompression(reader, filename, reader->buffer,
+                                     reader->buffer_end, !reader->eof);
+    }
+
+    if (status != 0) {
+        file_reader_close(reader);
+        return NULL;
+    }
+
     return reader;
 }
 
 /*
  * Reads the next line from the file.
- * Returns a pointer to an internal buffer,
+ * Returns a view of the line (without the newline),
  * or NULL on EOF or error.
  */
-char *file_reader_read_line(FileReader *reader) {
-    if (!reader || !reader->file) return NULL;
+const char *file_reader_read_line(FileReader *reader, size_t *len) {
+    if (!reader || !len) return NULL;
 
-    if (!fgets(reader->buffer, BUFFER_SIZE, reader->file)) {
-        return NULL;  // EOF or error
+    if (reader->decomp) return read_line_compressed(reader, len);
+    if (reader->map) return read_line_mapped(reader, len);
+    if (reader->buffer) return read_line_buffered(reader, len);
+
+    return NULL;
+}
+
+/*
+ * Copies the next bytes of input into dst.
+ */
+size_t file_reader_read_block(FileReader *reader, char *dst, size_t cap) {
+    if (!reader || !dst || cap == 0) return 0;
+
+    if (reader->decomp) {
+        if (reader->block_pos >= reader->block_len) {
+            reader->block = decompressor_next(reader->decomp,
+                                              &reader->block_len);
+            reader->block_pos = 0;
+            if (!reader->block) {
+                reader->block_len = 0;
+                return 0;
+            }
+        }
+
+        size_t n = reader->block_len - reader->block_pos;
+        if (n > cap) n = cap;
+        memcpy(dst, reader->block + reader->block_pos, n);
+        reader->block_pos += n;
+        return n;
+    }
+
+    if (reader->map) {
+        size_t n = reader->map_size - reader->pos;
+        if (n > cap) n = cap;
+        memcpy(dst, reader->map + reader->pos, n);
+        reader->pos += n;
+        return n;
     }
 
-    return reader->buffer;
+    if (!reader->buffer) return 0;
+
+    /* Bytes already buffered (e.g. peeked magic) come first */
+    size_t pending = reader->buffer_end - reader->buffer_start;
+    if (pending > 0) {
+        size_t n = pending < cap ? pending : cap;
+        memcpy(dst, reader->buffer + reader->buffer_start, n);
+        reader->buffer_start += n;
+        return n;
+    }
+
+    if (reader->eof) return 0;
+
+    ssize_t n;
+    do {
+        n = read(reader->fd, dst, cap);
+    } while (n < 0 && errno == EINTR);
+
+    if (n <= 0) {
+        if (n < 0) reader->failed = 1;
+        reader->eof = 1;
+        return 0;
+    }
+
+    return (size_t)n;
+}
+
+/*
+ * Returns the mapped file contents, or NULL if not mapped.
+ */
+const char *file_reader_mapping(const FileReader *reader, size_t *len) {
+    if (!reader || !reader->map || reader->decomp || !len) return NULL;
+
+    *len = reader->map_size;
+    return reader->map;
+}
+
+/*
+ * Advises the kernel about the upcoming access pattern.
+ */
+void file_reader_advise(
+    const FileReader *reader,
+    size_t offset,
+    size_t len,
+    int random
+) {
+    if (!reader || !reader->map || offset >= reader->map_size) return;
+
+    if (random) {
+        posix_madvise((void *)reader->map, reader->map_size,
+                      POSIX_MADV_RANDOM);
+        return;
+    }
+
+    /* madvise needs a page-aligned start */
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t aligned = offset - offset % page;
+    if (len > reader->map_size - offset) len = reader->map_size - offset;
+
+    posix_madvise((void *)(reader->map + aligned), len + (offset - aligned),
+                  POSIX_MADV_SEQUENTIAL);
+}
+
+/*
+ * Returns non-zero if the input could not be read to the end.
+ */
+int file_reader_failed(const FileReader *reader) {
+    if (!reader) return 0;
+    return reader->failed || decompressor_failed(reader->decomp);
 }
 
 /*
@@ -43,8 +401,18 @@ char *file_reader_read_line(FileReader *reader) {
 void file_reader_close(FileReader *reader) {
     if (!reader) return;
 
-    if (reader->file) {
-        fclose(reader->file);
+    /* Stop the helper thread before the data it reads goes away */
+    decompressor_stop(reader->decomp);
+    free(reader->carry);
+
+    if (reader->map) {
+        munmap((void *)reader->map, reader->map_size);
+    }
+
+    free(reader->buffer);
+
+    if (reader->fd >= 0) {
+        close(reader->fd);
     }
 
     free(reader);
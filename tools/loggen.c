@@ -0,0 +1,583 @@
+#define _POSIX_C_SOURCE 200809L
+
+/*
+ * Synthetic log generator.
+ *
+ * Writes "YYYY-MM-DD HH:MM:SS LEVEL message" lines at memory-copy speed
+ * with controllable distributions: level mix, number of distinct error
+ * messages (Zipf-distributed), message lengths, out-of-order timestamps,
+ * malformed lines and oversized lines. The same seed and options always
+ * produce byte-identical output.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <math.h>
+#include <time.h>
+
+#define DEFAULT_LINES  1000000
+#define DEFAULT_ERRORS 10
+#define DEFAULT_SKEW   60
+#define DEFAULT_OVERSIZED_LEN (1024 * 1024)
+#define DEFAULT_START  "2025-09-10 12:00:00"
+
+#define OUTPUT_BUFFER (4 * 1024 * 1024)
+#define MAX_LINE_BASE 512  // longest line excluding padding
+
+typedef struct {
+    unsigned long long lines;
+    const char *output;
+    unsigned long long seed;
+
+    unsigned info_pct;
+    unsigned warn_pct;
+    unsigned error_pct;
+
+    unsigned long long errors;  // distinct error messages
+    double zipf;                // exponent; 0 = uniform
+
+    size_t msg_min;  // pad messages to a length in [msg_min, msg_max]
+    size_t msg_max;
+
+    double disorder;  // fraction of lines with an earlier timestamp
+    unsigned skew;    // how much earlier, at most (seconds)
+    unsigned step;    // max seconds between consecutive lines
+
+    double malformed;      // fraction of unparseable lines
+    double oversized;      // fraction of oversized lines
+    size_t oversized_len;  // their message length
+
+    time_t start;
+} GenOptions;
+
+/* Rejection-inversion Zipf sampler (Hörmann & Derflinger) */
+typedef struct {
+    double n;
+    double s;
+    double h_integral_x1;
+    double h_integral_n;
+    double threshold;
+} Zipf;
+
+typedef struct {
+    FILE *file;
+    char *data;
+    size_t len;
+    unsigned long long total;
+    int failed;
+} Output;
+
+static const char *const INFO_MESSAGES[] = {
+    "Application running",
+    "Processing request",
+    "User login successful",
+    "Cache hit",
+    "Background job completed",
+    "Heartbeat OK",
+    "Worker initialized",
+    "Cleanup completed"
+};
+
+static const char *const WARN_MESSAGES[] = {
+    "High memory usage detected",
+    "Low disk space on /var",
+    "Slow response detected",
+    "Configuration value missing, using default",
+    "Retry attempt taking longer than expected"
+};
+
+static const char *const ERROR_MESSAGES[] = {
+    "Database connection failed",
+    "Timeout while reading request",
+    "Failed to write to disk",
+    "Authentication service unavailable",
+    "Connection reset by peer",
+    "Disk I/O error",
+    "Service dependency unavailable",
+    "Permission denied while accessing file",
+    "Out of memory condition detected",
+    "Invalid response from upstream service"
+};
+
+static const char *const MALFORMED_LINES[] = {
+    "Traceback (most recent call last):",
+    "2025-13-45 99:99:99 ERROR Impossible timestamp",
+    "    at com.example.Service.handle(Service.java:42)",
+    "2025-09-10 12:00:00",
+    "[INFO] Missing timestamp"
+};
+
+#define COUNT_OF(a) (sizeof(a) / sizeof((a)[0]))
+
+static const char FILLER[] =
+    " lorem ipsum dolor sit amet consectetur adipiscing elit sed do";
+
+/* ---------- Random Numbers ---------- */
+
+/* splitmix64: seeds well from any value, including 0 */
+static unsigned long long next_random(unsigned long long *state) {
+    unsigned long long z = (*state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+static double next_unit(unsigned long long *state) {
+    return (double)(next_random(state) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+static unsigned long long next_below(unsigned long long *state,
+                                     unsigned long long bound) {
+    return bound ? next_random(state) % bound : 0;
+}
+
+/* log1p(x) / x, accurate near 0 */
+static double helper1(double x) {
+    if (fabs(x) > 1e-8) return log1p(x) / x;
+    return 1.0 - x * (0.5 - x * (1.0 / 3.0 - 0.25 * x));
+}
+
+/* expm1(x) / x, accurate near 0 */
+static double helper2(double x) {
+    if (fabs(x) > 1e-8) return expm1(x) / x;
+    return 1.0 + x * 0.5 * (1.0 + x * (1.0 / 3.0) * (1.0 + 0.25 * x));
+}
+
+static double zipf_h(const Zipf *z, double x) {
+    return exp(-z->s * log(x));
+}
+
+static double zipf_h_integral(const Zipf *z, double x) {
+    double log_x = log(x);
+    return helper2((1.0 - z->s) * log_x) * log_x;
+}
+
+static double zipf_h_integral_inverse(const Zipf *z, double x) {
+    double t = x * (1.0 - z->s);
+    if (t < -1.0) t = -1.0;
+    return exp(helper1(t) * x);
+}
+
+static void zipf_init(Zipf *z, unsigned long long n, double s) {
+    z->n = (double)n;
+    z->s = s;
+    z->h_integral_x1 = zipf_h_integral(z, 1.5) - 1.0;
+    z->h_integral_n = zipf_h_integral(z, z->n + 0.5);
+    z->threshold =
+        2.0 - zipf_h_integral_inverse(z, zipf_h_integral(z, 2.5) -
+                                         zipf_h(z, 2.0));
+}
+
+/*
+ * Returns a rank in [1, n] with P(k) proportional to 1 / k^s,
+ * in O(1) expected time and without a table.
+ */
+static unsigned long long zipf_next(const Zipf *z, unsigned long long *rng) {
+    for (;;) {
+        double u = z->h_integral_n +
+                   next_unit(rng) * (z->h_integral_x1 - z->h_integral_n);
+        double x = zipf_h_integral_inverse(z, u);
+        double k = floor(x + 0.5);
+
+        if (k < 1.0) k = 1.0;
+        else if (k > z->n) k = z->n;
+
+        if (k - x <= z->threshold ||
+            u >= zipf_h_integral(z, k + 0.5) - zipf_h(z, k)) {
+            return (unsigned long long)k;
+        }
+    }
+}
+
+/* ---------- Output ---------- */
+
+static void output_flush(Output *out) {
+    if (out->len > 0 && !out->failed &&
+        fwrite(out->data, 1, out->len, out->file) != out->len) {
+        out->failed = 1;
+    }
+    out->total += out->len;
+    out->len = 0;
+}
+
+/*
+ * Makes room for `need` more bytes, flushing first if necessary.
+ * Returns the write position.
+ */
+static char *output_reserve(Output *out, size_t need) {
+    if (out->len + need > OUTPUT_BUFFER) output_flush(out);
+    return out->data + out->len;
+}
+
+/* Appends `len` bytes of filler text, in buffer-sized pieces if needed */
+static void output_filler(Output *out, size_t len) {
+    while (len > 0) {
+        size_t room = OUTPUT_BUFFER - out->len;
+        if (room == 0) {
+            output_flush(out);
+            room = OUTPUT_BUFFER;
+        }
+
+        size_t n = len < room ? len : room;
+        char *p = out->data + out->len;
+        for (size_t i = 0; i < n; i++) {
+            p[i] = FILLER[(out->total + out->len + i) % (sizeof(FILLER) - 1)];
+        }
+
+        out->len += n;
+        len -= n;
+    }
+}
+
+/* ---------- Lines ---------- */
+
+/*
+ * Formats "YYYY-MM-DD HH:MM:SS " for local time t into buf (20 bytes).
+ */
+static void format_timestamp(time_t t, char *buf) {
+    struct tm tm;
+    localtime_r(&t, &tm);
+    strftime(buf, 21, "%Y-%m-%d %H:%M:%S ", &tm);
+}
+
+static size_t append_number(char *p, unsigned long long v) {
+    char digits[24];
+    size_t n = 0;
+
+    do {
+        digits[n++] = (char)('0' + v % 10);
+        v /= 10;
+    } while (v > 0);
+
+    for (size_t i = 0; i < n; i++) p[i] = digits[n - 1 - i];
+    return n;
+}
+
+/*
+ * Writes error message number `rank` (1-based). With the default 10
+ * errors the messages are the classic set; beyond that each base
+ * message gets a numeric suffix.
+ */
+static size_t format_error(const GenOptions *opt, unsigned long long rank,
+                           char *p) {
+    const char *base = ERROR_MESSAGES[(rank - 1) % COUNT_OF(ERROR_MESSAGES)];
+    size_t n = strlen(base);
+    memcpy(p, base, n);
+
+    if (opt->errors > COUNT_OF(ERROR_MESSAGES)) {
+        memcpy(p + n, " (code ", 7);
+        n += 7;
+        n += append_number(p + n, rank);
+        p[n++] = ')';
+    }
+
+    return n;
+}
+
+/*
+ * Picks a padded message length in [msg_min, msg_max]. Error messages
+ * derive it from their rank, so padding never adds distinct errors.
+ */
+static size_t target_length(const GenOptions *opt, unsigned long long *rng,
+                            unsigned long long rank) {
+    if (opt->msg_max == 0) return 0;
+
+    unsigned long long span = opt->msg_max - opt->msg_min + 1;
+    unsigned long long r = rank
+        ? (rank * 0x9E3779B97F4A7C15ULL) >> 20
+        : next_random(rng);
+
+    return opt->msg_min + (size_t)(r % span);
+}
+
+static int generate(const GenOptions *opt, Output *out) {
+    unsigned long long rng = opt->seed;
+    Zipf zipf;
+    if (opt->zipf > 0) zipf_init(&zipf, opt->errors, opt->zipf);
+
+    time_t now = opt->start;
+    time_t cached_time = (time_t)-1;
+    char cached[21];
+
+    for (unsigned long long i = 0; i < opt->lines; i++) {
+        now += (time_t)next_below(&rng, opt->step + 1ULL);
+
+        char *line = output_reserve(out, MAX_LINE_BASE);
+        size_t n = 0;
+
+        if (opt->malformed > 0 && next_unit(&rng) < opt->malformed) {
+            const char *bad =
+                MALFORMED_LINES[next_below(&rng, COUNT_OF(MALFORMED_LINES))];
+            n = strlen(bad);
+            memcpy(line, bad, n);
+            line[n++] = '\n';
+            out->len += n;
+            continue;
+        }
+
+        /* Timestamp: re-formatted only when the second changes */
+        time_t t = now;
+        if (opt->disorder > 0 && next_unit(&rng) < opt->disorder) {
+            t -= 1 + (time_t)next_below(&rng, opt->skew);
+        }
+        if (t != cached_time) {
+            format_timestamp(t, cached);
+            cached_time = t;
+        }
+        memcpy(line, cached, 20);
+        n = 20;
+
+        unsigned long long rank = 0;
+        size_t message_start;
+        unsigned roll = (unsigned)next_below(&rng, 100);
+
+        if (roll < opt->info_pct) {
+            const char *msg =
+                INFO_MESSAGES[next_below(&rng, COUNT_OF(INFO_MESSAGES))];
+            size_t len = strlen(msg);
+            memcpy(line + n, "INFO ", 5);
+            message_start = n + 5;
+            memcpy(line + message_start, msg, len);
+            n = message_start + len;
+        } else if (roll < opt->info_pct + opt->warn_pct) {
+            const char *msg =
+                WARN_MESSAGES[next_below(&rng, COUNT_OF(WARN_MESSAGES))];
+            size_t len = strlen(msg);
+            memcpy(line + n, "WARN ", 5);
+            message_start = n + 5;
+            memcpy(line + message_start, msg, len);
+            n = message_start + len;
+        } else {
+            rank = opt->zipf > 0 ? zipf_next(&zipf, &rng)
+                                 : 1 + next_below(&rng, opt->errors);
+            memcpy(line + n, "ERROR ", 6);
+            message_start = n + 6;
+            n = message_start + format_error(opt, rank, line + message_start);
+        }
+
+        /* Padding and oversized payloads; filler is position-derived */
+        size_t message_len = n - message_start;
+        size_t target = target_length(opt, &rng, rank);
+
+        if (opt->oversized > 0 && next_unit(&rng) < opt->oversized) {
+            target = opt->oversized_len;
+        }
+
+        out->len += n;
+        if (target > message_len) {
+            if (rank) {
+                /* Errors get identical padding so they stay one message */
+                size_t pad = target - message_len;
+                while (pad > 0) {
+                    size_t chunk = pad < sizeof(FILLER) - 1
+                                       ? pad : sizeof(FILLER) - 1;
+                    memcpy(output_reserve(out, chunk), FILLER, chunk);
+                    out->len += chunk;
+                    pad -= chunk;
+                }
+            } else {
+                output_filler(out, target - message_len);
+            }
+        }
+
+        *output_reserve(out, 1) = '\n';
+        out->len++;
+    }
+
+    output_flush(out);
+    return out->failed ? -1 : 0;
+}
+
+/* ---------- Options ---------- */
+
+static void print_usage(const char *program_name) {
+    printf("Usage: %s [options]\n", program_name);
+    printf("\nOptions:\n");
+    printf("  --lines N             Lines to write (default: %d)\n",
+           DEFAULT_LINES);
+    printf("  --output FILE         Output file (default: stdout)\n");
+    printf("  --seed N              Random seed (default: 1)\n");
+    printf("  --levels I,W,E        Level mix in percent (default: 70,15,15)\n");
+    printf("  --errors N            Distinct error messages (default: %d)\n",
+           DEFAULT_ERRORS);
+    printf("  --zipf S              Zipf exponent of error frequencies\n");
+    printf("                        (default: 1.0; 0 = uniform)\n");
+    printf("  --msg-len MIN:MAX     Pad messages to a length in [MIN, MAX]\n");
+    printf("  --disorder R          Fraction of lines with an earlier timestamp\n");
+    printf("  --skew N              Max seconds a disordered line goes back (default: %d)\n",
+           DEFAULT_SKEW);
+    printf("  --step N              Max seconds between lines (default: 2)\n");
+    printf("  --malformed R         Fraction of unparseable lines\n");
+    printf("  --oversized R         Fraction of oversized lines\n");
+    printf("  --oversized-len N     Message length of oversized lines (default: %d)\n",
+           DEFAULT_OVERSIZED_LEN);
+    printf("  --start TIME          First timestamp (default: \"%s\")\n",
+           DEFAULT_START);
+    printf("  --help                Show this help message\n");
+}
+
+static int parse_count(const char *arg, unsigned long long *out) {
+    char *end = NULL;
+    errno = 0;
+    unsigned long long v = strtoull(arg, &end, 10);
+    if (errno != 0 || end == arg || *end != '\0' || arg[0] == '-') return 0;
+    *out = v;
+    return 1;
+}
+
+static int parse_ratio(const char *arg, double *out) {
+    char *end = NULL;
+    double v = strtod(arg, &end);
+    if (end == arg || *end != '\0' || !(v >= 0.0 && v <= 1.0)) return 0;
+    *out = v;
+    return 1;
+}
+
+static int parse_start(const char *arg, time_t *out) {
+    struct tm tm;
+    memset(&tm, 0, sizeof(tm));
+
+    if (sscanf(arg, "%d-%d-%d %d:%d:%d", &tm.tm_year, &tm.tm_mon,
+               &tm.tm_mday, &tm.tm_hour, &tm.tm_min, &tm.tm_sec) != 6) {
+        return 0;
+    }
+
+    tm.tm_year -= 1900;
+    tm.tm_mon -= 1;
+    tm.tm_isdst = -1;
+
+    *out = mktime(&tm);
+    return *out != (time_t)-1;
+}
+
+/*
+ * Returns 0 to run, 1 to exit successfully (--help), -1 on error.
+ */
+static int parse_options(int argc, char **argv, GenOptions *opt) {
+    memset(opt, 0, sizeof(*opt));
+    opt->lines = DEFAULT_LINES;
+    opt->seed = 1;
+    opt->info_pct = 70;
+    opt->warn_pct = 15;
+    opt->error_pct = 15;
+    opt->errors = DEFAULT_ERRORS;
+    opt->zipf = 1.0;
+    opt->skew = DEFAULT_SKEW;
+    opt->step = 2;
+    opt->oversized_len = DEFAULT_OVERSIZED_LEN;
+    parse_start(DEFAULT_START, &opt->start);
+
+    for (int i = 1; i < argc; i++) {
+        const char *name = argv[i];
+
+        if (strcmp(name, "--help") == 0) {
+            print_usage(argv[0]);
+            return 1;
+        }
+
+        if (i + 1 >= argc) {
+            fprintf(stderr, "Error: Missing value for %s\n", name);
+            return -1;
+        }
+
+        const char *value = argv[++i];
+        unsigned long long n;
+        int ok = 1;
+
+        if (strcmp(name, "--lines") == 0) {
+            ok = parse_count(value, &opt->lines);
+        } else if (strcmp(name, "--output") == 0) {
+            opt->output = value;
+        } else if (strcmp(name, "--seed") == 0) {
+            ok = parse_count(value, &opt->seed);
+        } else if (strcmp(name, "--levels") == 0) {
+            ok = sscanf(value, "%u,%u,%u", &opt->info_pct, &opt->warn_pct,
+                        &opt->error_pct) == 3 &&
+                 opt->info_pct + opt->warn_pct + opt->error_pct == 100;
+        } else if (strcmp(name, "--errors") == 0) {
+            ok = parse_count(value, &opt->errors) && opt->errors > 0;
+        } else if (strcmp(name, "--zipf") == 0) {
+            char *end = NULL;
+            opt->zipf = strtod(value, &end);
+            ok = end != value && *end == '\0' && opt->zipf >= 0.0;
+        } else if (strcmp(name, "--msg-len") == 0) {
+            size_t min, max;
+            ok = sscanf(value, "%zu:%zu", &min, &max) == 2 && min <= max;
+            opt->msg_min = min;
+            opt->msg_max = max;
+        } else if (strcmp(name, "--disorder") == 0) {
+            ok = parse_ratio(value, &opt->disorder);
+        } else if (strcmp(name, "--skew") == 0) {
+            ok = parse_count(value, &n) && n > 0 && n <= 86400 * 365;
+            opt->skew = (unsigned)n;
+        } else if (strcmp(name, "--step") == 0) {
+            ok = parse_count(value, &n) && n <= 86400;
+            opt->step = (unsigned)n;
+        } else if (strcmp(name, "--malformed") == 0) {
+            ok = parse_ratio(value, &opt->malformed);
+        } else if (strcmp(name, "--oversized") == 0) {
+            ok = parse_ratio(value, &opt->oversized);
+        } else if (strcmp(name, "--oversized-len") == 0) {
+            ok = parse_count(value, &n) && n > 0;
+            opt->oversized_len = (size_t)n;
+        } else if (strcmp(name, "--start") == 0) {
+            ok = parse_start(value, &opt->start);
+        } else {
+            fprintf(stderr, "Error: Unknown option '%s'\n", name);
+            return -1;
+        }
+
+        if (!ok) {
+            fprintf(stderr, "Error: Invalid value for %s: '%s'\n",
+                    name, value);
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    GenOptions opt;
+    int parsed = parse_options(argc, argv, &opt);
+    if (parsed != 0) return parsed > 0 ? 0 : 1;
+
+    Output out;
+    memset(&out, 0, sizeof(out));
+    out.file = opt.output ? fopen(opt.output, "wb") : stdout;
+    out.data = malloc(OUTPUT_BUFFER);
+
+    if (!out.file || !out.data) {
+        fprintf(stderr, "Error: Could not open '%s'\n",
+                opt.output ? opt.output : "stdout");
+        free(out.data);
+        return 1;
+    }
+
+    struct timespec begin, end;
+    clock_gettime(CLOCK_MONOTONIC, &begin);
+
+    int status = generate(&opt, &out);
+
+    if (out.file != stdout) {
+        if (fclose(out.file) != 0) status = -1;
+    } else if (fflush(stdout) != 0) {
+        status = -1;
+    }
+    free(out.data);
+
+    if (status != 0) {
+        fprintf(stderr, "Error: Could not write output\n");
+        return 1;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double seconds = (double)(end.tv_sec - begin.tv_sec) +
+                     (double)(end.tv_nsec - begin.tv_nsec) / 1e9;
+
+    fprintf(stderr, "Generated %llu lines (%.1f MB) in %.2f s\n",
+            opt.lines, (double)out.total / (1024.0 * 1024.0), seconds);
+    return 0;
+}